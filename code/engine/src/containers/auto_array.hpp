@@ -2,99 +2,270 @@
 
 #include "core/asserts.hpp"
 #include "core/memory.hpp"
+#include "memory/allocator.hpp"
 
 #include "defines.hpp"
 
+#include <new>
+#include <type_traits>
+#include <utility>
+
 #define AUTO_DARRAY_DEFEAULT_CAPACITY 1
 #define AUTO_DARRAY_EXPAND_FACTOR 2
 
+// Types that can be moved to another address with a plain copy of their
+// bytes, skipping the move constructor and the destructor of the old copy.
+// Detected for the trivially copyable types. Other types that stay valid when
+// their bytes are moved, like ones owning a heap block through a pointer, can
+// opt in with a specialization
+template <typename T>
+struct Is_Trivially_Relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+// Elements stored inside the array itself, see Auto_Array. The array derives
+// from it, so the empty specialization costs no space
+template <typename T, u32 INLINE_CAPACITY>
+struct Auto_Array_Inline_Storage {
+    alignas(T) u8 inline_bytes[sizeof(T) * INLINE_CAPACITY];
+
+    T* inline_elements() {
+        return reinterpret_cast<T*>(inline_bytes);
+    }
+};
+
 template <typename T>
-struct Auto_Array {
+struct Auto_Array_Inline_Storage<T, 0> {
+    T* inline_elements() {
+        return nullptr;
+    }
+};
+
+// Growable array. A zeroed Auto_Array is a valid empty array, so it can live in
+// memory that is zeroed instead of constructed, like the subsystem states. The
+// elements are released explicitly with free, there is no destructor.
+//
+// The memory comes from the engine heap under the DARRAY tag unless another
+// allocator or tag is given, see allocator.hpp.
+//
+// With an INLINE_CAPACITY, the first elements are stored inside the array and
+// the heap is only used once it holds more than that. Meant for the many
+// arrays that never hold more than a handful of elements. Since data can point
+// inside the array, such arrays cannot be copied
+template <typename T, u32 INLINE_CAPACITY = 0>
+struct Auto_Array : Auto_Array_Inline_Storage<T, INLINE_CAPACITY> {
     T* data;
     u64 capacity;
     u64 length;
 
-    Auto_Array<T>() {
+    // nullptr selects the engine heap
+    const Allocator* allocator;
+    // UNKNOWN selects DARRAY, so the zeroed arrays keep their tag
+    Memory_Tag tag;
+
+    Auto_Array() {
         data = nullptr;
         capacity = 0;
         length = 0;
+        allocator = nullptr;
+        tag = Memory_Tag::UNKNOWN;
     };
 
+    explicit Auto_Array(Memory_Tag array_tag, const Allocator* array_allocator = nullptr) {
+        data = nullptr;
+        capacity = 0;
+        length = 0;
+        allocator = array_allocator;
+        tag = array_tag;
+    }
+
+    Auto_Array(const Auto_Array&)
+        requires(INLINE_CAPACITY == 0)
+    = default;
+
+    Auto_Array& operator=(const Auto_Array&)
+        requires(INLINE_CAPACITY == 0)
+    = default;
+
+    // For the arrays that were zeroed instead of constructed. The array must
+    // not hold any memory yet
+    void set_allocator(Memory_Tag array_tag, const Allocator* array_allocator = nullptr) {
+        RUNTIME_ASSERT_MSG(!data, "Auto_Array - Allocator changed while the array holds memory");
+
+        allocator = array_allocator;
+        tag = array_tag;
+    }
+
     void add(const T& value) {
-        if (length >= capacity)
-            grow();
+        emplace(value);
+    }
+
+    void add(T&& value) {
+        emplace(std::move(value));
+    }
 
-        memory_copy(
-            data + length,
-            &value,
-            sizeof(T));
+    // Constructs the new element in place at the end of the array
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        if (length >= capacity) {
+            // The arguments can refer to elements of the array, which are
+            // moved by the growth, so the element is built first
+            T value(std::forward<Args>(args)...);
+            grow();
+            new (data + length) T(std::move(value));
+        } else {
+            new (data + length) T(std::forward<Args>(args)...);
+        }
 
-        ++length;
+        return data[length++];
     }
 
+    // Releases the current elements and allocates room for data_count ones.
+    // With prefilled they are all value initialized and part of the array
     void reserve(u64 data_count, b8 prefilled = true) {
-        capacity = data_count;
+        free();
+
+        if (data_count <= INLINE_CAPACITY && data_count) {
+            data = this->inline_elements();
+            capacity = INLINE_CAPACITY;
+        } else {
+            capacity = data_count;
 
-        data = static_cast<T*>(
-            memory_allocate(
-                sizeof(T) * data_count,
-                Memory_Tag::DARRAY));
+            data = static_cast<T*>(
+                get_allocator()->allocate(
+                    get_allocator()->state,
+                    sizeof(T) * data_count,
+                    alignof(T),
+                    get_tag()));
+
+            RUNTIME_ASSERT_MSG(data || !data_count, "Auto_Array - Out of memory while reserving");
+        }
+
+        if (data)
+            memory_zero(data, sizeof(T) * data_count);
+
+        length = 0;
+
+        if (prefilled) {
+            // Zero is already the value of the trivial types
+            if constexpr (!std::is_trivially_default_constructible_v<T>) {
+                for (u64 i = 0; i < data_count; ++i)
+                    new (data + i) T();
+            }
 
-        if (prefilled)
             length = data_count;
-        else
-            length = 0;
+        }
     }
 
     void free() {
-        memory_deallocate(
-            data,
-            sizeof(T) * length,
-            Memory_Tag::DARRAY);
+        destroy(0, length);
+
+        // The whole capacity was allocated, not only the used elements
+        if (data && !is_inline() && get_allocator()->free)
+            get_allocator()->free(
+                get_allocator()->state,
+                data,
+                sizeof(T) * capacity,
+                get_tag());
 
         length = 0;
         capacity = 0;
         data = nullptr;
     }
 
-    void clear() { length = 0; }
+    // Destroys the elements and keeps the memory for the next ones
+    void clear() {
+        destroy(0, length);
+        length = 0;
+    }
 
     void grow() {
+        // The inline elements are used first
+        if (INLINE_CAPACITY && !data) {
+            data = this->inline_elements();
+            capacity = INLINE_CAPACITY;
+            return;
+        }
+
         u64 new_capacity = capacity != 0
                                ? capacity * AUTO_DARRAY_EXPAND_FACTOR
                                : AUTO_DARRAY_DEFEAULT_CAPACITY;
 
-        void* new_array = memory_allocate(
-            new_capacity * sizeof(T),
-            Memory_Tag::DARRAY);
+        // The elements past length are always constructed before being read,
+        // so the new block does not need to be zeroed. Relocatable types are
+        // reallocated, which can extend the block in place, the others and the
+        // inline elements are moved one by one to a new block
+        const Allocator* array_allocator = get_allocator();
+        void* new_array;
 
-        if (length > 0)
-            memory_copy(
-                new_array,
+        if (Is_Trivially_Relocatable<T>::value && !is_inline()) {
+            new_array = array_allocator->reallocate(
+                array_allocator->state,
                 data,
-                sizeof(T) * length);
+                sizeof(T) * capacity,
+                sizeof(T) * new_capacity,
+                alignof(T),
+                get_tag());
+
+            RUNTIME_ASSERT_MSG(new_array, "Auto_Array - Out of memory while growing");
+        } else {
+            new_array = array_allocator->allocate(
+                array_allocator->state,
+                sizeof(T) * new_capacity,
+                alignof(T),
+                get_tag());
+
+            RUNTIME_ASSERT_MSG(new_array, "Auto_Array - Out of memory while growing");
+
+            if constexpr (Is_Trivially_Relocatable<T>::value) {
+                if (length > 0)
+                    memory_copy(
+                        new_array,
+                        data,
+                        sizeof(T) * length);
+            } else {
+                T* new_data = static_cast<T*>(new_array);
+                for (u64 i = 0; i < length; ++i) {
+                    new (new_data + i) T(std::move(data[i]));
+                    data[i].~T();
+                }
+            }
 
-        memory_deallocate(
-            data,
-            sizeof(T) * length,
-            Memory_Tag::DARRAY);
+            if (data && !is_inline() && array_allocator->free)
+                array_allocator->free(
+                    array_allocator->state,
+                    data,
+                    sizeof(T) * capacity,
+                    get_tag());
+        }
 
         capacity = new_capacity;
         data = static_cast<T*>(new_array);
     }
 
     void pop() {
+        RUNTIME_ASSERT(length > 0);
+
         --length;
+        destroy(length, length + 1);
     }
 
+    // Removes the element and shifts the following ones down, keeping the
+    // order of the array
     void pop_at(u32 index) {
-        RUNTIME_ASSERT(index <= length);
+        RUNTIME_ASSERT(index < length);
 
-        if (index != length - 1)
-            memory_copy(
+        if constexpr (Is_Trivially_Relocatable<T>::value) {
+            destroy(index, index + 1);
+
+            memory_move(
                 data + index,
                 data + index + 1,
-                sizeof(T) * (length - (index - 1)));
+                sizeof(T) * (length - index - 1));
+        } else {
+            for (u64 i = index; i + 1 < length; ++i)
+                data[i] = std::move(data[i + 1]);
+
+            destroy(length - 1, length);
+        }
 
         --length;
     }
@@ -104,4 +275,29 @@ struct Auto_Array {
 
         return data[index];
     }
+
+    // Whether the elements are the inline ones
+    b8 is_inline() {
+        return INLINE_CAPACITY && data == this->inline_elements();
+    }
+
+    const Allocator* get_allocator() const {
+        return allocator ? allocator : allocator_get_heap();
+    }
+
+    Memory_Tag get_tag() const {
+        return tag != Memory_Tag::UNKNOWN ? tag : Memory_Tag::DARRAY;
+    }
+
+    // Runs the destructors of the elements in [first, last)
+    void destroy(u64 first, u64 last) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (u64 i = first; i < last; ++i)
+                data[i].~T();
+        }
+    }
 };
+
+// Auto_Array that stores up to N elements inline before using the heap
+template <typename T, u32 N>
+using Small_Array = Auto_Array<T, N>;
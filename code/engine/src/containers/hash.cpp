@@ -0,0 +1,50 @@
+#include "hash.hpp"
+
+#include <string.h>
+
+constexpr u64 HASH_MULTIPLIER_1 = 0x9E3779B97F4A7C15ull;
+constexpr u64 HASH_MULTIPLIER_2 = 0xC2B2AE3D27D4EB4Full;
+
+KOALA_INLINE u64 hash_rotate_left(u64 value, u32 count) {
+    return (value << count) | (value >> (64 - count));
+}
+
+KOALA_INLINE u64 hash_mix_word(u64 hash, u64 word) {
+    hash ^= hash_rotate_left(word * HASH_MULTIPLIER_2, 31) * HASH_MULTIPLIER_1;
+    return hash_rotate_left(hash, 27) * HASH_MULTIPLIER_1 + HASH_MULTIPLIER_2;
+}
+
+u64 hash_bytes(
+    const void* data,
+    u64 size,
+    u64 seed) {
+
+    const u8* bytes = static_cast<const u8*>(data);
+    u64 hash = seed ^ (size * HASH_MULTIPLIER_1);
+
+    while (size >= 8) {
+        // memcpy keeps the unaligned reads defined, compilers turn it into
+        // a single load
+        u64 word;
+        memcpy(&word, bytes, sizeof(word));
+
+        hash = hash_mix_word(hash, word);
+
+        bytes += 8;
+        size -= 8;
+    }
+
+    if (size) {
+        u64 tail = 0;
+        memcpy(&tail, bytes, size);
+
+        hash = hash_mix_word(hash, tail);
+    }
+
+    return hash_u64(hash);
+}
+
+u64 hash_string(
+    const char* string) {
+    return hash_bytes(string, strlen(string));
+}
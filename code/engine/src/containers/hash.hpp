@@ -0,0 +1,28 @@
+#pragma once
+
+#include "defines.hpp"
+
+// Hash functions of the keyed containers. They are meant for hash tables, not
+// for checksums or for anything exposed to untrusted input
+
+// Finalizer of MurmurHash3, every bit of the value affects every bit of the
+// hash. Enough for integers and pointers
+KOALA_INLINE u64 hash_u64(u64 value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+
+    return value;
+}
+
+// Reads the bytes 8 at a time, the same bytes always give the same hash
+KOALA_API u64 hash_bytes(
+    const void* data,
+    u64 size,
+    u64 seed = 0);
+
+// Hash of the characters up to the null terminator
+KOALA_API u64 hash_string(
+    const char* string);
@@ -0,0 +1,431 @@
+#pragma once
+
+#include "containers/hash.hpp"
+#include "core/asserts.hpp"
+#include "core/memory.hpp"
+#include "core/string.hpp"
+#include "memory/allocator.hpp"
+
+#include "defines.hpp"
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#define HASH_MAP_MIN_CAPACITY 8
+
+// The probe distances are stored in a byte, a key that would end this far
+// from its bucket grows the map or is refused
+#define HASH_MAP_MAX_DISTANCE 255
+
+// Default hash of the keys. Integers, enums and pointers are their own hash,
+// the map mixes the bits when picking the bucket. C strings hash their
+// characters. Other key types specialize it or give their own hasher to the
+// map
+template <typename K>
+struct Hash_Map_Hasher {
+    u64 operator()(const K& key) const {
+        static_assert(
+            std::is_integral_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>,
+            "Hash_Map_Hasher - No default hash for the key type");
+
+        if constexpr (std::is_pointer_v<K>)
+            return reinterpret_cast<u64>(key);
+        else
+            return static_cast<u64>(key);
+    }
+};
+
+template <>
+struct Hash_Map_Hasher<const char*> {
+    u64 operator()(const char* key) const {
+        return hash_string(key);
+    }
+};
+
+template <typename K>
+struct Hash_Map_Key_Equal {
+    b8 operator()(const K& a, const K& b) const {
+        return a == b;
+    }
+};
+
+template <>
+struct Hash_Map_Key_Equal<const char*> {
+    b8 operator()(const char* a, const char* b) const {
+        return string_check_equal(a, b);
+    }
+};
+
+template <typename K, typename V>
+struct Hash_Map_Entry {
+    K key;
+    V value;
+};
+
+// Open addressing hash map with Robin Hood probing. The entries live in a
+// single array, a key is looked up by scanning the slots after its bucket, and
+// an insertion takes the slot of any entry that is closer to its own bucket
+// than the new one. The probe lengths stay short and even, and a lookup stops
+// as soon as it meets an entry closer to its bucket than the key would be.
+// Removals shift the following entries back, so there are no tombstones.
+//
+// Like Auto_Array, a zeroed Hash_Map is a valid empty map and the memory is
+// released explicitly with free. It comes from the engine heap under the
+// DARRAY tag unless another allocator or tag is given, see allocator.hpp.
+//
+// Pointers to the entries are valid until the next insertion or removal. C
+// string keys are not copied, the strings must outlive the map.
+//
+// A hasher that sends too many keys to the same buckets can make an insertion
+// fail, see insert
+template <
+    typename K,
+    typename V,
+    typename Hasher = Hash_Map_Hasher<K>,
+    typename Key_Equal = Hash_Map_Key_Equal<K>>
+struct Hash_Map {
+    using Entry = Hash_Map_Entry<K, V>;
+
+    Entry* entries;
+    // Distance of each entry from its bucket plus one, 0 for the empty slots.
+    // Kept apart from the entries so the probes mostly read these bytes
+    u8* distances;
+    u64 capacity;
+    u64 length;
+
+    // The bucket is taken from the top bits of the hash, 64 - log2(capacity)
+    u32 shift;
+
+    // nullptr selects the engine heap
+    const Allocator* allocator;
+    // UNKNOWN selects DARRAY
+    Memory_Tag tag;
+
+    Hash_Map() {
+        memory_zero(this, sizeof(Hash_Map));
+    }
+
+    explicit Hash_Map(Memory_Tag map_tag, const Allocator* map_allocator = nullptr) {
+        memory_zero(this, sizeof(Hash_Map));
+        allocator = map_allocator;
+        tag = map_tag;
+    }
+
+    // For the maps that were zeroed instead of constructed. The map must not
+    // hold any memory yet
+    void set_allocator(Memory_Tag map_tag, const Allocator* map_allocator = nullptr) {
+        RUNTIME_ASSERT_MSG(!entries, "Hash_Map - Allocator changed while the map holds memory");
+
+        allocator = map_allocator;
+        tag = map_tag;
+    }
+
+    // nullptr when the key is not in the map
+    V* find(const K& key) {
+        Entry* entry = find_entry(key);
+        return entry ? &entry->value : nullptr;
+    }
+
+    b8 contains(const K& key) {
+        return find_entry(key) != nullptr;
+    }
+
+    // Returns false and leaves the map untouched when the key is already in
+    // it, or when it would end too far from its bucket in a map that is
+    // mostly empty, which only a poor hasher causes
+    b8 insert(const K& key, const V& value) {
+        if (find_entry(key))
+            return false;
+
+        return place(Entry{key, value}) != nullptr;
+    }
+
+    b8 insert(const K& key, V&& value) {
+        if (find_entry(key))
+            return false;
+
+        return place(Entry{key, std::move(value)}) != nullptr;
+    }
+
+    // The value of the key, added value initialized when missing. nullptr
+    // when the key is missing and cannot be added, like for insert
+    V* find_or_insert(const K& key) {
+        Entry* entry = find_entry(key);
+        if (!entry)
+            entry = place(Entry{key, V()});
+
+        return entry ? &entry->value : nullptr;
+    }
+
+    // Returns false when the key is not in the map
+    b8 remove(const K& key) {
+        Entry* entry = find_entry(key);
+        if (!entry)
+            return false;
+
+        u64 mask = capacity - 1;
+        u64 index = static_cast<u64>(entry - entries);
+        entry->~Entry();
+
+        // The entries after it that are not in their bucket move one slot
+        // closer, which keeps every probe sequence without gaps
+        u64 next = (index + 1) & mask;
+        while (distances[next] > 1) {
+            new (entries + index) Entry(std::move(entries[next]));
+            entries[next].~Entry();
+            distances[index] = distances[next] - 1;
+
+            index = next;
+            next = (next + 1) & mask;
+        }
+
+        distances[index] = 0;
+        --length;
+
+        return true;
+    }
+
+    // Makes room for count entries, so adding up to that many does not rehash
+    void reserve(u64 count) {
+        if (count > max_length(capacity))
+            rehash(count);
+    }
+
+    // Rebuilds the map with enough buckets for bucket_count entries, rounded
+    // up to a power of two. The map never shrinks
+    void rehash(u64 bucket_count) {
+        u64 new_capacity = capacity > HASH_MAP_MIN_CAPACITY ? capacity : HASH_MAP_MIN_CAPACITY;
+        while (max_length(new_capacity) < bucket_count)
+            new_capacity *= 2;
+
+        if (new_capacity == capacity)
+            return;
+
+        Entry* old_entries = entries;
+        u8* old_distances = distances;
+        u64 old_capacity = capacity;
+
+        entries = static_cast<Entry*>(
+            get_allocator()->allocate(
+                get_allocator()->state,
+                block_size(new_capacity),
+                alignof(Entry),
+                get_tag()));
+
+        RUNTIME_ASSERT_MSG(entries, "Hash_Map - Out of memory while rehashing");
+
+        distances = reinterpret_cast<u8*>(entries + new_capacity);
+        memory_zero(distances, new_capacity);
+
+        capacity = new_capacity;
+        shift = 64;
+        for (u64 bucket = new_capacity; bucket > 1; bucket >>= 1)
+            --shift;
+
+        length = 0;
+
+        // The buckets keep their order when the capacity grows, so no entry
+        // ends further from its bucket than it was and they all fit again.
+        // This is why the map does not shrink
+        for (u64 i = 0; i < old_capacity; ++i) {
+            if (old_distances[i]) {
+                place(std::move(old_entries[i]));
+                old_entries[i].~Entry();
+            }
+        }
+
+        if (old_entries && get_allocator()->free)
+            get_allocator()->free(
+                get_allocator()->state,
+                old_entries,
+                block_size(old_capacity),
+                get_tag());
+    }
+
+    // Destroys the entries and keeps the memory for the next ones
+    void clear() {
+        for (u64 i = 0; i < capacity; ++i)
+            if (distances[i])
+                entries[i].~Entry();
+
+        if (distances)
+            memory_zero(distances, capacity);
+
+        length = 0;
+    }
+
+    void free() {
+        clear();
+
+        if (entries && get_allocator()->free)
+            get_allocator()->free(
+                get_allocator()->state,
+                entries,
+                block_size(capacity),
+                get_tag());
+
+        entries = nullptr;
+        distances = nullptr;
+        capacity = 0;
+        shift = 0;
+    }
+
+    // Visits the entries in slot order, which changes on every rehash
+    struct Iterator {
+        Hash_Map* map;
+        u64 index;
+
+        Entry& operator*() {
+            return map->entries[index];
+        }
+
+        Entry* operator->() {
+            return &map->entries[index];
+        }
+
+        Iterator& operator++() {
+            ++index;
+            while (index < map->capacity && !map->distances[index])
+                ++index;
+
+            return *this;
+        }
+
+        b8 operator!=(const Iterator& other) const {
+            return index != other.index;
+        }
+    };
+
+    Iterator begin() {
+        u64 index = 0;
+        while (index < capacity && !distances[index])
+            ++index;
+
+        return {this, index};
+    }
+
+    Iterator end() {
+        return {this, capacity};
+    }
+
+    const Allocator* get_allocator() const {
+        return allocator ? allocator : allocator_get_heap();
+    }
+
+    Memory_Tag get_tag() const {
+        return tag != Memory_Tag::UNKNOWN ? tag : Memory_Tag::DARRAY;
+    }
+
+    // Entries the capacity holds before growing, 7/8 of the slots
+    static u64 max_length(u64 slot_count) {
+        return slot_count - slot_count / 8;
+    }
+
+    // The entries followed by their distances
+    static u64 block_size(u64 slot_count) {
+        return (sizeof(Entry) + 1) * slot_count;
+    }
+
+    u64 bucket_of(const K& key) {
+        // The multiplication spreads the hashers that only vary in the low bits
+        return (Hasher()(key) * 0x9E3779B97F4A7C15ull) >> shift;
+    }
+
+    Entry* find_entry(const K& key) {
+        if (!length)
+            return nullptr;
+
+        u64 mask = capacity - 1;
+        u64 index = bucket_of(key);
+
+        // The stored distances never reach the maximum, so the loop ends
+        // before the distance wraps
+        for (u32 distance = 1; distances[index] >= distance; ++distance) {
+            if (distances[index] == distance && Key_Equal()(entries[index].key, key))
+                return entries + index;
+
+            index = (index + 1) & mask;
+        }
+
+        return nullptr;
+    }
+
+    // Whether an entry of the bucket can be added without any distance
+    // reaching the maximum. It takes the slot of the first entry closer to
+    // its bucket, and the entries from there to the next empty slot each end
+    // one slot further
+    b8 fits(u64 bucket) {
+        u64 mask = capacity - 1;
+        u64 index = bucket;
+        u32 distance = 1;
+
+        while (distances[index] >= distance) {
+            index = (index + 1) & mask;
+
+            if (++distance == HASH_MAP_MAX_DISTANCE)
+                return false;
+        }
+
+        while (distances[index]) {
+            if (distances[index] + 1 == HASH_MAP_MAX_DISTANCE)
+                return false;
+
+            index = (index + 1) & mask;
+        }
+
+        return true;
+    }
+
+    // Adds an entry whose key is not in the map yet and returns where it is
+    // stored. Returns nullptr and leaves the map untouched when the entry
+    // does not fit
+    Entry* place(Entry&& new_entry) {
+        if (length + 1 > max_length(capacity))
+            rehash(length + 1);
+
+        if (!fits(bucket_of(new_entry.key))) {
+            // Growing spreads the runs that come from the load. A map that is
+            // mostly empty only gets them from a hasher that packs the keys in
+            // a few buckets, which growing would not fix
+            if (length * 4 < capacity)
+                return nullptr;
+
+            rehash(max_length(capacity * 2));
+            return place(std::move(new_entry));
+        }
+
+        Entry entry(std::move(new_entry));
+        Entry* placed = nullptr;
+
+        u64 mask = capacity - 1;
+        u64 index = bucket_of(entry.key);
+        u32 distance = 1;
+
+        while (true) {
+            if (!distances[index]) {
+                new (entries + index) Entry(std::move(entry));
+                distances[index] = static_cast<u8>(distance);
+                ++length;
+
+                return placed ? placed : entries + index;
+            }
+
+            // The entry closer to its bucket gives up the slot and carries
+            // on with the probe
+            if (distances[index] < distance) {
+                std::swap(entry, entries[index]);
+
+                u8 carried_distance = distances[index];
+                distances[index] = static_cast<u8>(distance);
+                distance = carried_distance;
+
+                if (!placed)
+                    placed = entries + index;
+            }
+
+            index = (index + 1) & mask;
+            ++distance;
+        }
+    }
+};
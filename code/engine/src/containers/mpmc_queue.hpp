@@ -0,0 +1,189 @@
+#pragma once
+
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+#include "memory/allocator.hpp"
+
+#include "defines.hpp"
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+template <typename T>
+struct Mpmc_Queue_Cell {
+    // Position the cell is ready for. Equal to the position while the cell
+    // waits for a producer, one past it once the value can be read
+    std::atomic<u64> sequence;
+    T value;
+};
+
+// Bounded queue for any number of producer and consumer threads, based on the
+// queue of Dmitry Vyukov. Every cell carries a sequence number, so a thread
+// claims a position with a single compare and swap and then only touches its
+// own cell. There are no locks, and nothing is allocated after create.
+//
+// The calls fail right away when the queue is full or empty, the caller
+// decides whether to retry, yield or drop. Each consumer sees the values of a
+// given producer in the order they were enqueued.
+//
+// The elements and the alignment have the same requirements as
+// Spsc_Ring_Buffer, see spsc_ring_buffer.hpp
+template <typename T>
+struct Mpmc_Queue {
+    STATIC_ASSERT(std::is_trivially_copyable_v<T>, "Mpmc_Queue - Elements must be trivially copyable");
+
+    using Cell = Mpmc_Queue_Cell<T>;
+
+    // The producers and the consumers each contend on their own line
+    alignas(MEMORY_CACHE_LINE_SIZE) std::atomic<u64> enqueue_position;
+    alignas(MEMORY_CACHE_LINE_SIZE) std::atomic<u64> dequeue_position;
+
+    // Only written by create and destroy
+    alignas(MEMORY_CACHE_LINE_SIZE) Cell* cells;
+    u64 capacity;
+    u64 mask;
+
+    // nullptr selects the engine heap
+    const Allocator* allocator;
+    Memory_Tag tag;
+
+    // Capacity must be a power of two of at least 2. Not thread safe, call it
+    // before handing the queue to the threads
+    b8 create(u64 cell_capacity, Memory_Tag queue_tag = Memory_Tag::DARRAY, const Allocator* queue_allocator = nullptr) {
+        if (cell_capacity < 2 || (cell_capacity & (cell_capacity - 1))) {
+            ENGINE_ERROR("Mpmc_Queue - Capacity %llu is not a power of two of at least 2", cell_capacity);
+            return false;
+        }
+
+        allocator = queue_allocator ? queue_allocator : allocator_get_heap();
+        tag = queue_tag;
+
+        cells = static_cast<Cell*>(
+            allocator->allocate(allocator->state, sizeof(Cell) * cell_capacity, alignof(Cell), tag));
+
+        if (!cells)
+            return false;
+
+        capacity = cell_capacity;
+        mask = cell_capacity - 1;
+
+        for (u64 i = 0; i < cell_capacity; ++i)
+            new (&cells[i].sequence) std::atomic<u64>(i);
+
+        enqueue_position.store(0, std::memory_order_relaxed);
+        dequeue_position.store(0, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    // Not thread safe, all the threads must be done with the queue
+    void destroy() {
+        if (cells && allocator->free)
+            allocator->free(allocator->state, cells, sizeof(Cell) * capacity, tag);
+
+        cells = nullptr;
+        capacity = 0;
+        mask = 0;
+    }
+
+    b8 try_enqueue(const T& value) {
+        return try_enqueue_batch(&value, 1) == 1;
+    }
+
+    b8 try_dequeue(T* out_value) {
+        return try_dequeue_batch(out_value, 1) == 1;
+    }
+
+    // Claims up to count consecutive free cells with a single compare and
+    // swap. Returns how many values were enqueued, 0 when the queue is full
+    u64 try_enqueue_batch(const T* values, u64 count) {
+        u64 position = enqueue_position.load(std::memory_order_relaxed);
+        u64 ready;
+
+        while (true) {
+            // Free cells are ready for their own position. A cell that is not
+            // still waits for a consumer, or was claimed by another producer
+            // when the position is stale
+            ready = 0;
+            while (ready < count) {
+                u64 sequence = cells[(position + ready) & mask].sequence.load(std::memory_order_acquire);
+                if (sequence != position + ready)
+                    break;
+
+                ++ready;
+            }
+
+            if (ready) {
+                if (enqueue_position.compare_exchange_weak(position, position + ready, std::memory_order_relaxed))
+                    break;
+
+                continue;
+            }
+
+            u64 sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+            if (static_cast<s64>(sequence - position) < 0)
+                return 0;
+
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+
+        // No other thread touches the claimed cells until they are published
+        for (u64 i = 0; i < ready; ++i) {
+            Cell* cell = &cells[(position + i) & mask];
+            cell->value = values[i];
+            cell->sequence.store(position + i + 1, std::memory_order_release);
+        }
+
+        return ready;
+    }
+
+    // Takes up to max_count consecutive values with a single compare and
+    // swap. Returns how many were dequeued, 0 when the queue is empty
+    u64 try_dequeue_batch(T* out_values, u64 max_count) {
+        u64 position = dequeue_position.load(std::memory_order_relaxed);
+        u64 ready;
+
+        while (true) {
+            ready = 0;
+            while (ready < max_count) {
+                u64 sequence = cells[(position + ready) & mask].sequence.load(std::memory_order_acquire);
+                if (sequence != position + ready + 1)
+                    break;
+
+                ++ready;
+            }
+
+            if (ready) {
+                if (dequeue_position.compare_exchange_weak(position, position + ready, std::memory_order_relaxed))
+                    break;
+
+                continue;
+            }
+
+            u64 sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+            if (static_cast<s64>(sequence - (position + 1)) < 0)
+                return 0;
+
+            position = dequeue_position.load(std::memory_order_relaxed);
+        }
+
+        // Hands the cells back to the producers of the next lap
+        for (u64 i = 0; i < ready; ++i) {
+            Cell* cell = &cells[(position + i) & mask];
+            out_values[i] = cell->value;
+            cell->sequence.store(position + i + capacity, std::memory_order_release);
+        }
+
+        return ready;
+    }
+
+    // Values in the queue. Only a snapshot, the other threads can change it
+    // right after
+    u64 size() const {
+        u64 dequeued = dequeue_position.load(std::memory_order_acquire);
+        u64 enqueued = enqueue_position.load(std::memory_order_acquire);
+
+        return enqueued - dequeued < capacity ? enqueued - dequeued : capacity;
+    }
+};
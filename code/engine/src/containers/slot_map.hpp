@@ -0,0 +1,231 @@
+#pragma once
+
+#include "containers/auto_array.hpp"
+#include "core/asserts.hpp"
+#include "memory/allocator.hpp"
+
+#include "defines.hpp"
+
+#include <utility>
+
+// Compact handles keep the index in the low bits and the low bits of the
+// generation in the high ones, so the maps using them hold at most 2^20 slots
+#define SLOT_MAP_COMPACT_INDEX_BITS 20
+#define SLOT_MAP_COMPACT_INDEX_MASK ((1u << SLOT_MAP_COMPACT_INDEX_BITS) - 1)
+
+// Handle of a value in a Slot_Map. Both fields are 0 for the invalid handle.
+// The generation is odd while the slot holds a value and changes when the
+// value is removed, so stale handles stop resolving
+struct Slot_Handle {
+    u32 index;
+    u32 generation;
+};
+
+KOALA_INLINE b8 operator==(Slot_Handle a, Slot_Handle b) {
+    return a.index == b.index && a.generation == b.generation;
+}
+
+// For the places that store handles as opaque integers
+KOALA_INLINE u64 slot_handle_to_u64(Slot_Handle handle) {
+    return (static_cast<u64>(handle.generation) << 32) | handle.index;
+}
+
+KOALA_INLINE Slot_Handle slot_handle_from_u64(u64 value) {
+    return {static_cast<u32>(value), static_cast<u32>(value >> 32)};
+}
+
+// 32 bit form of the handle, with 12 bits of generation. A slot reused 2048
+// times comes back to the same compact handle, which the full handle would
+// still tell apart
+KOALA_INLINE u32 slot_handle_to_u32(Slot_Handle handle) {
+    RUNTIME_ASSERT_MSG(handle.index <= SLOT_MAP_COMPACT_INDEX_MASK, "Slot handle - Index too large for a compact handle");
+
+    return (handle.generation << SLOT_MAP_COMPACT_INDEX_BITS) | handle.index;
+}
+
+struct Slot_Map_Slot {
+    // Position of the value in the packed array while the slot is live, the
+    // next free slot plus one otherwise
+    u32 dense_index;
+    u32 generation;
+};
+
+// Values reached through stable handles. The values are packed in a single
+// array with no holes, so the systems owning them iterate over contiguous
+// memory, while the handles go through a table of slots that never moves them
+// around. Insertion and removal are O(1): a removal moves the last value into
+// the hole it leaves and points its slot at the new position.
+//
+// The order of the values changes on removal and the pointers returned by find
+// are valid until the next insertion or removal. Like Auto_Array, a zeroed
+// Slot_Map is a valid empty map and the memory is released explicitly with
+// free
+template <typename T>
+struct Slot_Map {
+    Auto_Array<T> values;
+    // Slot of each value, to fix the handle of the value moved by a removal
+    Auto_Array<u32> value_slots;
+    Auto_Array<Slot_Map_Slot> slots;
+
+    // Free slot plus one, 0 when every slot is in use
+    u32 first_free_slot;
+
+    Slot_Map() {
+        first_free_slot = 0;
+    }
+
+    explicit Slot_Map(Memory_Tag map_tag, const Allocator* map_allocator = nullptr)
+        : values(map_tag, map_allocator),
+          value_slots(map_tag, map_allocator),
+          slots(map_tag, map_allocator) {
+        first_free_slot = 0;
+    }
+
+    // For the maps that were zeroed instead of constructed. The map must not
+    // hold any memory yet
+    void set_allocator(Memory_Tag map_tag, const Allocator* map_allocator = nullptr) {
+        values.set_allocator(map_tag, map_allocator);
+        value_slots.set_allocator(map_tag, map_allocator);
+        slots.set_allocator(map_tag, map_allocator);
+    }
+
+    Slot_Handle insert(const T& value) {
+        return emplace(value);
+    }
+
+    Slot_Handle insert(T&& value) {
+        return emplace(std::move(value));
+    }
+
+    template <typename... Args>
+    Slot_Handle emplace(Args&&... args) {
+        u32 index;
+
+        if (first_free_slot) {
+            index = first_free_slot - 1;
+            first_free_slot = slots.data[index].dense_index;
+        } else {
+            RUNTIME_ASSERT_MSG(slots.length < 0xFFFFFFFF, "Slot_Map - Out of slots");
+
+            index = static_cast<u32>(slots.length);
+            slots.add({0, 0});
+        }
+
+        Slot_Map_Slot* slot = &slots.data[index];
+        slot->dense_index = static_cast<u32>(values.length);
+        slot->generation++;
+
+        values.emplace(std::forward<Args>(args)...);
+        value_slots.add(index);
+
+        return {index, slot->generation};
+    }
+
+    // nullptr for removed and invalid handles
+    T* find(Slot_Handle handle) {
+        Slot_Map_Slot* slot = get_live_slot(handle);
+        return slot ? &values.data[slot->dense_index] : nullptr;
+    }
+
+    // Lookup by the 32 bit form of slot_handle_to_u32. Named apart from find
+    // so the 64 bit form of a handle cannot be narrowed into it
+    T* find_compact(u32 compact_handle) {
+        u32 index = compact_handle & SLOT_MAP_COMPACT_INDEX_MASK;
+        u32 generation = compact_handle >> SLOT_MAP_COMPACT_INDEX_BITS;
+
+        if (index >= slots.length)
+            return nullptr;
+
+        Slot_Map_Slot* slot = &slots.data[index];
+        u32 generation_mask = 0xFFFFFFFF >> SLOT_MAP_COMPACT_INDEX_BITS;
+        if ((slot->generation & generation_mask) != generation || !(slot->generation & 1))
+            return nullptr;
+
+        return &values.data[slot->dense_index];
+    }
+
+    b8 contains(Slot_Handle handle) {
+        return get_live_slot(handle) != nullptr;
+    }
+
+    // Returns false for removed and invalid handles
+    b8 remove(Slot_Handle handle) {
+        Slot_Map_Slot* slot = get_live_slot(handle);
+        if (!slot)
+            return false;
+
+        // The last value fills the hole
+        u32 dense_index = slot->dense_index;
+        u32 last = static_cast<u32>(values.length - 1);
+
+        if (dense_index != last) {
+            values.data[dense_index] = std::move(values.data[last]);
+            value_slots.data[dense_index] = value_slots.data[last];
+            slots.data[value_slots.data[dense_index]].dense_index = dense_index;
+        }
+
+        values.pop();
+        value_slots.pop();
+
+        slot->generation++;
+        slot->dense_index = first_free_slot;
+        first_free_slot = handle.index + 1;
+
+        return true;
+    }
+
+    // Handle of the value at a position of the packed array
+    Slot_Handle handle_at(u64 dense_index) {
+        RUNTIME_ASSERT(dense_index < values.length);
+
+        u32 index = value_slots.data[dense_index];
+        return {index, slots.data[index].generation};
+    }
+
+    u64 count() const {
+        return values.length;
+    }
+
+    // The packed values, for the linear iteration
+    T* begin() {
+        return values.data;
+    }
+
+    T* end() {
+        return values.data + values.length;
+    }
+
+    // Removes every value, all the handles stop resolving. Keeps the memory
+    void clear() {
+        for (u64 i = 0; i < values.length; ++i) {
+            u32 index = value_slots.data[i];
+
+            slots.data[index].generation++;
+            slots.data[index].dense_index = first_free_slot;
+            first_free_slot = index + 1;
+        }
+
+        values.clear();
+        value_slots.clear();
+    }
+
+    // Releases the memory. The generations are lost with the slots, so the
+    // handles of before can resolve again once the map is reused
+    void free() {
+        values.free();
+        value_slots.free();
+        slots.free();
+        first_free_slot = 0;
+    }
+
+    Slot_Map_Slot* get_live_slot(Slot_Handle handle) {
+        if (handle.index >= slots.length)
+            return nullptr;
+
+        Slot_Map_Slot* slot = &slots.data[handle.index];
+        if (slot->generation != handle.generation || !(slot->generation & 1))
+            return nullptr;
+
+        return slot;
+    }
+};
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+#include "memory/allocator.hpp"
+
+#include "defines.hpp"
+
+#include <atomic>
+#include <type_traits>
+
+// Fixed capacity queue between exactly one producer thread and one consumer
+// thread, without locks. Every call is wait free: it does its work or fails
+// right away when the buffer is full or empty, the caller decides whether to
+// retry, yield or drop.
+//
+// The positions only grow and wrap through the mask, the producer owns head
+// and the consumer owns tail. Each side keeps its own copy of the index of
+// the other one and only reloads it when the copy does not leave enough room
+// or elements for the call, so in the steady state the two threads do not
+// touch each other's cache line.
+//
+// The elements are copied with their bytes, so T must be trivially copyable.
+// The struct is aligned to the cache line, allocate it with a matching
+// alignment or keep it in a state, a static or on the stack
+template <typename T>
+struct Spsc_Ring_Buffer {
+    STATIC_ASSERT(std::is_trivially_copyable_v<T>, "Spsc_Ring_Buffer - Elements must be trivially copyable");
+
+    // Written by the producer
+    alignas(MEMORY_CACHE_LINE_SIZE) std::atomic<u64> head;
+    u64 cached_tail;
+
+    // Written by the consumer
+    alignas(MEMORY_CACHE_LINE_SIZE) std::atomic<u64> tail;
+    u64 cached_head;
+
+    // Only written by create and destroy
+    alignas(MEMORY_CACHE_LINE_SIZE) T* elements;
+    u64 capacity;
+    u64 mask;
+
+    // nullptr selects the engine heap
+    const Allocator* allocator;
+    Memory_Tag tag;
+
+    // Capacity must be a power of two. Not thread safe, call it before
+    // handing the buffer to the two threads
+    b8 create(u64 element_capacity, Memory_Tag buffer_tag = Memory_Tag::DARRAY, const Allocator* buffer_allocator = nullptr) {
+        if (!element_capacity || (element_capacity & (element_capacity - 1))) {
+            ENGINE_ERROR("Spsc_Ring_Buffer - Capacity %llu is not a power of two", element_capacity);
+            return false;
+        }
+
+        allocator = buffer_allocator ? buffer_allocator : allocator_get_heap();
+        tag = buffer_tag;
+
+        elements = static_cast<T*>(
+            allocator->allocate(allocator->state, sizeof(T) * element_capacity, alignof(T), tag));
+
+        if (!elements)
+            return false;
+
+        capacity = element_capacity;
+        mask = element_capacity - 1;
+
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        cached_tail = 0;
+        cached_head = 0;
+
+        return true;
+    }
+
+    // Not thread safe, both threads must be done with the buffer
+    void destroy() {
+        if (elements && allocator->free)
+            allocator->free(allocator->state, elements, sizeof(T) * capacity, tag);
+
+        elements = nullptr;
+        capacity = 0;
+        mask = 0;
+    }
+
+    // Producer side
+
+    b8 try_push(const T& value) {
+        u64 position = head.load(std::memory_order_relaxed);
+
+        if (position - cached_tail == capacity) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position - cached_tail == capacity)
+                return false;
+        }
+
+        elements[position & mask] = value;
+        head.store(position + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Pushes as many of the values as there is room for, in at most two
+    // copies around the end of the buffer. Returns how many were pushed
+    u64 try_push_bulk(const T* values, u64 count) {
+        u64 position = head.load(std::memory_order_relaxed);
+
+        if (capacity - (position - cached_tail) < count)
+            cached_tail = tail.load(std::memory_order_acquire);
+
+        u64 free_count = capacity - (position - cached_tail);
+        if (count > free_count)
+            count = free_count;
+
+        if (!count)
+            return 0;
+
+        u64 first = position & mask;
+        u64 first_count = capacity - first < count ? capacity - first : count;
+
+        memory_copy(elements + first, values, sizeof(T) * first_count);
+        if (count > first_count)
+            memory_copy(elements, values + first_count, sizeof(T) * (count - first_count));
+
+        head.store(position + count, std::memory_order_release);
+
+        return count;
+    }
+
+    // Contiguous free elements the producer can write in place, up to the end
+    // of the buffer. They are published to the consumer by commit_write
+    u64 acquire_write_span(T** out_span) {
+        u64 position = head.load(std::memory_order_relaxed);
+        u64 first = position & mask;
+
+        // Only reload when the copy cuts the span short
+        if (capacity - (position - cached_tail) < capacity - first)
+            cached_tail = tail.load(std::memory_order_acquire);
+
+        u64 free_count = capacity - (position - cached_tail);
+
+        *out_span = elements + first;
+
+        return capacity - first < free_count ? capacity - first : free_count;
+    }
+
+    // Count must not exceed the span returned by acquire_write_span
+    void commit_write(u64 count) {
+        head.store(head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Consumer side
+
+    b8 try_pop(T* out_value) {
+        u64 position = tail.load(std::memory_order_relaxed);
+
+        if (position == cached_head) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (position == cached_head)
+                return false;
+        }
+
+        *out_value = elements[position & mask];
+        tail.store(position + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Pops up to max_count values in at most two copies. Returns how many
+    // were popped
+    u64 try_pop_bulk(T* out_values, u64 max_count) {
+        u64 position = tail.load(std::memory_order_relaxed);
+
+        if (cached_head - position < max_count)
+            cached_head = head.load(std::memory_order_acquire);
+
+        u64 count = cached_head - position;
+        if (count > max_count)
+            count = max_count;
+
+        if (!count)
+            return 0;
+
+        u64 first = position & mask;
+        u64 first_count = capacity - first < count ? capacity - first : count;
+
+        memory_copy(out_values, elements + first, sizeof(T) * first_count);
+        if (count > first_count)
+            memory_copy(out_values + first_count, elements, sizeof(T) * (count - first_count));
+
+        tail.store(position + count, std::memory_order_release);
+
+        return count;
+    }
+
+    // Contiguous elements the consumer can read in place, up to the end of
+    // the buffer. They are given back to the producer by commit_read
+    u64 acquire_read_span(T** out_span) {
+        u64 position = tail.load(std::memory_order_relaxed);
+        u64 first = position & mask;
+
+        // Only reload when the copy cuts the span short
+        if (cached_head - position < capacity - first)
+            cached_head = head.load(std::memory_order_acquire);
+
+        u64 count = cached_head - position;
+
+        *out_span = elements + first;
+
+        return capacity - first < count ? capacity - first : count;
+    }
+
+    // Count must not exceed the span returned by acquire_read_span
+    void commit_read(u64 count) {
+        tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Elements in the buffer, from either thread. Only a snapshot, the other
+    // side can change it right after
+    u64 size() const {
+        // Tail first, head is never behind it
+        u64 consumed = tail.load(std::memory_order_acquire);
+        u64 produced = head.load(std::memory_order_acquire);
+
+        return produced - consumed < capacity ? produced - consumed : capacity;
+    }
+};
@@ -9,13 +9,38 @@
 
 #include "platform/platform.hpp"
 
-#include "memory/linear_allocator.hpp"
+#include "memory/allocator.hpp"
+#include "memory/frame_allocator.hpp"
+#include "memory/relocatable_heap.hpp"
+#include "memory/virtual_arena.hpp"
 
 #include "renderer/renderer_frontend.hpp"
 #include "renderer/renderer_types.inl"
 
 constexpr f64 TARGET_FRAME_TIME = 1.0f / 60;
 
+// Size of the engine heap that serves the memory_allocate calls once the
+// memory subsystem is started
+constexpr u64 ENGINE_HEAP_SIZE = 256 * MIB;
+constexpr b8 ENGINE_HEAP_HUGE_PAGES = true;
+
+// Address space reserved for the subsystem states. Only the pages actually
+// used by the states are committed
+constexpr u64 SYSTEMS_ARENA_RESERVE_SIZE = 1 * GIB;
+constexpr u64 SYSTEMS_ARENA_COMMIT_GRANULARITY = 64 * KIB;
+// The states take far less than a huge page, so regular pages waste less
+constexpr b8 SYSTEMS_ARENA_HUGE_PAGES = false;
+
+// Address space reserved for the scratch memory of each frame in flight
+constexpr u64 FRAME_ALLOCATOR_FRAME_SIZE = 64 * MIB;
+
+// Address space and block count of the heap of movable resources. Every frame
+// the compaction moves at most the given bytes, which keeps its cost well
+// below a millisecond
+constexpr u64 RELOCATABLE_HEAP_RESERVE_SIZE = 4 * GIB;
+constexpr u32 RELOCATABLE_HEAP_SLOT_CAPACITY = 1 << 16;
+constexpr u64 RELOCATABLE_HEAP_COMPACT_BYTES_PER_FRAME = 1 * MIB;
+
 struct Application_State {
     Game* game_inst;
 
@@ -26,7 +51,10 @@ struct Application_State {
     s16 height;
 
     Absolute_Clock clock;
-    Linear_Allocator systems_allocator;
+    Virtual_Arena systems_arena;
+    Frame_Allocator frame_allocator;
+    Allocator frame_allocator_interface;
+    Relocatable_Heap relocatable_heap;
 
     u64 logging_system_mem_req;
     void* logging_system_state;
@@ -90,12 +118,30 @@ b8 application_initialize(Game* game_inst) {
     application_state->is_running = false;
     application_state->is_suspended = false;
 
-    // Setup linear allocator
-    u64 systems_alloc_total_size = 64 * 1024 * 1024; // For now just set to a large number
-    linear_allocator_create(
-        systems_alloc_total_size,
-        nullptr,
-        &application_state->systems_allocator);
+    // Setup the arena of the subsystem states. It grows on demand, so the
+    // states never move even if more subsystems are added later
+    if (!virtual_arena_create(
+            SYSTEMS_ARENA_RESERVE_SIZE,
+            SYSTEMS_ARENA_COMMIT_GRANULARITY,
+            SYSTEMS_ARENA_HUGE_PAGES,
+            &application_state->systems_arena)) {
+        ENGINE_FATAL("Failed to reserve the memory of the subsystems");
+        return false;
+    }
+
+    // One scratch arena per frame in flight, so that the transient data of a
+    // frame outlives the GPU work that reads it
+    if (!frame_allocator_create(
+            FRAME_ALLOCATOR_FRAME_SIZE,
+            RENDERER_MAX_IN_FLIGHT_FRAMES,
+            &application_state->frame_allocator)) {
+        ENGINE_FATAL("Failed to reserve the frame memory");
+        return false;
+    }
+
+    allocator_from_frame(
+        &application_state->frame_allocator,
+        &application_state->frame_allocator_interface);
 
     application_state->width =
         application_state->game_inst->config.start_width;
@@ -107,8 +153,8 @@ b8 application_initialize(Game* game_inst) {
 
     // 1. Logging subsystem
     log_startup(&application_state->logging_system_mem_req, nullptr);
-    application_state->logging_system_state = linear_allocator_allocate(
-        &application_state->systems_allocator,
+    application_state->logging_system_state = virtual_arena_allocate(
+        &application_state->systems_arena,
         application_state->logging_system_mem_req);
     if (!log_startup(
             &application_state->logging_system_mem_req,
@@ -121,8 +167,8 @@ b8 application_initialize(Game* game_inst) {
 	// the platform layer can push events as soon as the window creates
 	// so the event subsystem must be available before that
     event_startup(&application_state->event_system_mem_req, nullptr);
-    application_state->event_system_state = linear_allocator_allocate(
-        &application_state->systems_allocator,
+    application_state->event_system_state = virtual_arena_allocate(
+        &application_state->systems_arena,
         application_state->event_system_mem_req);
     if (!event_startup(
             &application_state->event_system_mem_req,
@@ -141,8 +187,8 @@ b8 application_initialize(Game* game_inst) {
         game_inst->config.start_width,
         game_inst->config.start_height);
 
-    application_state->platform_system_state = linear_allocator_allocate(
-        &application_state->systems_allocator,
+    application_state->platform_system_state = virtual_arena_allocate(
+        &application_state->systems_arena,
         application_state->platform_system_mem_req);
 
     if (!platform_startup(
@@ -159,19 +205,41 @@ b8 application_initialize(Game* game_inst) {
     }
 
     // 4. Memory subsystem
-    memory_startup(&application_state->memory_system_mem_req, nullptr);
-    application_state->memory_system_state = linear_allocator_allocate(
-        &application_state->systems_allocator,
+    Memory_System_Config memory_config = {};
+    memory_config.heap_size = ENGINE_HEAP_SIZE;
+    memory_config.heap_huge_pages = ENGINE_HEAP_HUGE_PAGES;
+    memory_config.guard_mode = game_inst->config.memory_guard_mode;
+    memory_config.trace_path = game_inst->config.memory_trace_path;
+#ifdef DEBUG_BUILD
+    memory_config.track_allocations = true;
+#endif
+
+    memory_startup(
+        &application_state->memory_system_mem_req,
+        nullptr,
+        &memory_config);
+    application_state->memory_system_state = virtual_arena_allocate(
+        &application_state->systems_arena,
         application_state->memory_system_mem_req);
     memory_startup(
         &application_state->memory_system_mem_req,
-        application_state->memory_system_state);
-
+        application_state->memory_system_state,
+        &memory_config);
+
+    // Its slot table comes from the memory system, so it is created after it
+    // and destroyed before it to be tracked
+    if (!relocatable_heap_create(
+            RELOCATABLE_HEAP_RESERVE_SIZE,
+            RELOCATABLE_HEAP_SLOT_CAPACITY,
+            &application_state->relocatable_heap)) {
+        ENGINE_FATAL("Failed to reserve the relocatable heap");
+        return false;
+    }
 
     // 5. Input subsystem - Depends on: logger, event, memory
     input_startup(&application_state->input_system_mem_req, nullptr);
-    application_state->input_system_state = linear_allocator_allocate(
-        &application_state->systems_allocator,
+    application_state->input_system_state = virtual_arena_allocate(
+        &application_state->systems_arena,
         application_state->input_system_mem_req);
     input_startup(
         &application_state->input_system_mem_req,
@@ -183,8 +251,8 @@ b8 application_initialize(Game* game_inst) {
         nullptr,
         application_state->game_inst->config.name);
 
-    application_state->renderer_system_state = linear_allocator_allocate(
-        &application_state->systems_allocator,
+    application_state->renderer_system_state = virtual_arena_allocate(
+        &application_state->systems_arena,
         application_state->renderer_system_mem_req);
 
     if (!renderer_startup(
@@ -232,7 +300,10 @@ b8 application_initialize(Game* game_inst) {
 
     ENGINE_DEBUG("Subsystems initialized correctly.");
 
-    ENGINE_DEBUG(memory_get_current_usage()); // WARN: Memory leak because the heap allocated string must be deallocated
+    char usage[MEMORY_USAGE_STRING_SIZE];
+    memory_refresh_huge_page_usage();
+    memory_get_current_usage(usage, sizeof(usage));
+    ENGINE_DEBUG("%s", usage);
 
     return true;
 }
@@ -254,6 +325,16 @@ void application_run() {
 
         // Frame
         if (!application_state->is_suspended) {
+            // Everything allocated in the frame that used this arena before
+            // is released here
+            frame_allocator_begin_frame(&application_state->frame_allocator);
+
+            // Closes a bit of the holes of the relocatable heap before the
+            // game resolves its handles for the frame
+            relocatable_heap_compact(
+                &application_state->relocatable_heap,
+                RELOCATABLE_HEAP_COMPACT_BYTES_PER_FRAME);
+
             // To be consistent from the architecture standpoint the
             // clock will be updates once per frame
             absolute_clock_update(&application_state->clock);
@@ -300,6 +381,8 @@ void application_run() {
                     platform_sleep((remaining_frame_seconds * 1000) - 1);
             }
 
+            memory_end_frame();
+
             // Input state copying should be the last thing
             input_update(delta_t);
 
@@ -313,6 +396,18 @@ void application_run() {
     application_shutdown();
 }
 
+Frame_Allocator* application_get_frame_allocator() {
+    return &application_state->frame_allocator;
+}
+
+const Allocator* application_get_frame_allocator_interface() {
+    return &application_state->frame_allocator_interface;
+}
+
+Relocatable_Heap* application_get_relocatable_heap() {
+    return &application_state->relocatable_heap;
+}
+
 void application_get_framebuffer_size(u32* width, u32* height) {
     *width = application_state->width;
     *width = application_state->width;
@@ -345,10 +440,14 @@ void application_shutdown() {
     renderer_shutdown(application_state->renderer_system_state);
     input_shutdown(application_state->input_system_state);
     event_shutdown(application_state->event_system_state);
+    relocatable_heap_destroy(&application_state->relocatable_heap);
     memory_shutdown(application_state->memory_system_state);
     platform_shutdown(application_state->platform_system_state);
     log_shutdown(application_state->logging_system_state);
 
+    frame_allocator_destroy(&application_state->frame_allocator);
+    virtual_arena_destroy(&application_state->systems_arena);
+
     ENGINE_DEBUG("Application susbsytems stopped correctly");
 }
 
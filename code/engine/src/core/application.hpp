@@ -1,8 +1,12 @@
 #pragma once
 
 #include "defines.hpp"
+#include "core/memory.hpp"
 
 struct Game; // Forward declare game struct since this file needs to be included inside the game header
+struct Allocator;
+struct Frame_Allocator;
+struct Relocatable_Heap;
 
 struct Application_Config {
     s16 start_pos_x;
@@ -12,12 +16,34 @@ struct Application_Config {
 
     b8 limit_frame;
     const char* name;
+
+    // Serve every allocation from guard pages to catch memory corruption at
+    // the faulting instruction, see Memory_System_Config::guard_mode
+    Memory_Guard_Mode memory_guard_mode;
+
+    // Path of the binary allocation trace, nullptr to disable the recording.
+    // See Memory_System_Config::trace_path
+    const char* memory_trace_path;
 };
 
 KOALA_API b8 application_initialize(Game* game_inst);
 
 KOALA_API void application_run();
 
+// Scratch memory of the current frame, reset automatically by application_run.
+// Blocks stay valid for as many frames as the renderer has in flight, so
+// transient data of game_update and game_render never needs the heap
+KOALA_API Frame_Allocator* application_get_frame_allocator();
+
+// The frame allocator for the containers, for temporary arrays that are
+// dropped at the end of the frame without being freed
+KOALA_API const Allocator* application_get_frame_allocator_interface();
+
+// Heap of the movable resources, compacted a little at the start of every
+// frame by application_run. Pointers resolved from its handles are valid until
+// the end of the frame, as long as nothing is allocated from it in between
+KOALA_API Relocatable_Heap* application_get_relocatable_heap();
+
 void application_get_framebuffer_size(u32* width, u32* height);
 
 void application_shutdown();
@@ -11,8 +11,14 @@ struct Registered_Event {
 
 // Entries must be dynamically allocated since we cannot predict how many listener there will be for each code
 // We can use dynamic arrays to manage the elements
+//
+// Most codes have one or two listeners, which are kept inside the entry so
+// registering them does not allocate. It adds 32 bytes to each of the 16384
+// entries, about 512 KiB of the state
+constexpr u32 EVENT_INLINE_LISTENER_COUNT = 2;
+
 struct Event_Code_Entry {
-    Auto_Array<Registered_Event> event_listeners;
+    Small_Array<Registered_Event, EVENT_INLINE_LISTENER_COUNT> event_listeners;
 };
 
 #define MAX_EVENT_ENTRIES 16384
@@ -56,7 +62,7 @@ b8 event_register_listener(
     void* listener,
     PFN_Event_Handler on_event) {
 
-    Auto_Array<Registered_Event>* events_array =
+    Small_Array<Registered_Event, EVENT_INLINE_LISTENER_COUNT>* events_array =
         &state_ptr->entries[(u16)code].event_listeners;
 
     // Check if listener is already present
@@ -87,7 +93,7 @@ b8 event_unregister_listener(
     if (!state_ptr->entries[(u16)code].event_listeners.data)
         return false;
 
-    Auto_Array<Registered_Event>* events_array =
+    Small_Array<Registered_Event, EVENT_INLINE_LISTENER_COUNT>* events_array =
         &state_ptr->entries[(u16)code].event_listeners;
 
     for (u32 i = 0; i < events_array->length; ++i) {
@@ -112,11 +118,16 @@ b8 event_fire(
     void* sender,
     Event_Context context) {
 
+    // The memory system fires events and can run without the event system,
+    // for example in the unit tests
+    if (!state_ptr)
+        return false;
+
     // Check if array is initiliazed
     if (!state_ptr->entries[(u16)code].event_listeners.data)
         return false;
 
-    Auto_Array<Registered_Event>* events = &state_ptr->entries[(u16)code].event_listeners;
+    Small_Array<Registered_Event, EVENT_INLINE_LISTENER_COUNT>* events = &state_ptr->entries[(u16)code].event_listeners;
 
     // Check if listener is already present
     for (u32 i = 0; i < events->length; ++i) {
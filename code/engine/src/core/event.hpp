@@ -41,6 +41,12 @@ enum class Event_Code : u16 {
 
     RESIZED = 0x08,
 
+    // Fired by the memory system when a tag crosses its budget (see
+    // memory_set_budget). The tag will be in u32[0], 0 for the soft limit or 1
+    // for the hard limit in u32[1] and the bytes of the tag, including the
+    // request, in u64[1]
+    MEMORY_BUDGET_EXCEEDED = 0x09,
+
     MAX_EVENT_CODE = 0xFF
 };
 
@@ -51,8 +57,8 @@ enum class Event_Code : u16 {
 // event!
 typedef b8 (*PFN_Event_Handler)(Event_Code code, void* sender, void* listener_inst, Event_Context data);
 
-b8 event_startup(u64* mem_req, void* state);
-void event_shutdown(void* state);
+KOALA_API b8 event_startup(u64* mem_req, void* state);
+KOALA_API void event_shutdown(void* state);
 
 KOALA_API b8 event_register_listener(
     Event_Code code,
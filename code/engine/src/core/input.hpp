@@ -163,12 +163,12 @@ enum Key_Modifiers {
 };
 
 // Functions called by the application layer to initialize the input subsystem
-void input_startup(u64* mem_req, void* state);
-void input_shutdown(void* state);
-void input_update(f64 delta_time);
+KOALA_API void input_startup(u64* mem_req, void* state);
+KOALA_API void input_shutdown(void* state);
+KOALA_API void input_update(f64 delta_time);
 
 // NOTE: Functions to set the state (Called by platform layer)
-void input_process_key(
+KOALA_API void input_process_key(
     Keyboard_Key key,
     u16 modifier_mask,
     b8 pressed);
@@ -1,15 +1,60 @@
-#include "memory.hpp"
-
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <atomic>
+#include <thread>
+
+#include "memory.hpp"
+
+#include "core/asserts.hpp"
+#include "core/event.hpp"
 #include "core/logger.hpp"
 #include "defines.hpp"
+#include "memory/allocation_trace.hpp"
+#include "memory/allocation_tracker.hpp"
+#include "memory/dynamic_allocator.hpp"
+#include "memory/guard_allocator.hpp"
+#include "memory/virtual_arena.hpp"
 #include "platform/platform.hpp"
 
-struct Memory_Stats {
-    u64 total_allocated;
-    u64 tagged_allocations[(u64)Memory_Tag::MAX_ENTRIES];
+constexpr u64 MEMORY_TAG_COUNT = (u64)Memory_Tag::MAX_ENTRIES;
+
+// Pauses spent waiting for one of the locks below before yielding the core
+constexpr u32 MEMORY_LOCK_SPIN_COUNT = 64;
+
+// Every thread updates the counters of its own shard, so the allocations never
+// write to a cache line shared with another thread. The counters are atomics
+// only because threads share a shard when there are more threads than shards;
+// the relaxed increments on an uncontended line cost about as much as plain
+// ones. The shards are summed when the stats are read
+struct alignas(MEMORY_CACHE_LINE_SIZE) Memory_Stats_Shard {
+    // Net bytes per tag. A block freed on a different thread than the one that
+    // allocated it wraps the shard of the freeing thread below 0, but the sum
+    // of all the shards is still correct
+    std::atomic<u64> tagged_allocations[MEMORY_TAG_COUNT];
+    // Bytes handed out by the heap on top of the requested sizes, because of
+    // the block alignment and of remainders too small to be split
+    std::atomic<u64> tagged_heap_overhead[MEMORY_TAG_COUNT];
+    std::atomic<u64> tagged_allocation_count[MEMORY_TAG_COUNT];
+    std::atomic<u64> tagged_deallocation_count[MEMORY_TAG_COUNT];
+
+    // Highest net bytes of the tag in this shard. Only when a thread pushes its
+    // own shard past it the global peak can have grown, so the shards are
+    // summed on those allocations only
+    std::atomic<u64> tagged_shard_peak[MEMORY_TAG_COUNT];
+
+    // Bytes set to 0 by memory_allocate and bytes handed out without zeroing
+    // by memory_allocate_uninitialized, to measure the saved memory writes
+    std::atomic<u64> zeroed_bytes;
+    std::atomic<u64> uninitialized_bytes;
+};
+
+struct Memory_Budget {
+    u64 soft_limit;
+    u64 hard_limit;
+    PFN_Memory_Evict evict;
+    void* evict_user_data;
 };
 
 // The memory system collects and stores metrics regarding memory utilization,
@@ -19,70 +64,706 @@ struct Memory_Stats {
 // state. This is useful especially in unit tests, where we would like to avoid
 // memory subsystem initialization just to test our methods.
 struct Memory_System_State {
-    Memory_Stats stats;
-    u64 allocations_count;
+    Memory_Stats_Shard shards[MEMORY_STATS_SHARD_COUNT];
+    std::atomic<u64> tagged_peak[MEMORY_TAG_COUNT];
+
+    // Snapshot taken at the end of the previous frame and the difference of
+    // the last completed frame against it
+    Memory_Stats frame_start_stats;
+    Memory_Frame_Stats last_frame_stats;
+
+    Memory_Budget budgets[MEMORY_TAG_COUNT];
+
+    u64 heap_size;
+    void* heap_memory;
+    b8 heap_huge_pages;
+    // Last figure read from the OS by memory_refresh_huge_page_usage
+    std::atomic<u64> huge_page_usage;
+    // Shared by all the threads like the guard allocator, with its own spin
+    // lock
+    std::atomic_flag heap_lock;
+    Dynamic_Allocator heap;
+
+    // Replaces the heap when the guard mode is enabled. Shared by all the
+    // threads like the tracker, with its own spin lock
+    b8 guard_pages;
+    std::atomic_flag guard_lock;
+    Guard_Allocator guard;
+
+    // Shared by all the threads, so every access takes the spin lock
+    b8 track_allocations;
+    std::atomic_flag tracker_lock;
+    Allocation_Tracker tracker;
+
+    // Records are appended in the order the threads take the lock, so the
+    // timestamps of the trace are increasing
+    b8 trace_allocations;
+    std::atomic_flag trace_lock;
+    Allocation_Trace trace;
 };
 
 internal Memory_System_State* state_ptr = nullptr;
 
+// Incremented on every startup, so the per thread data can tell a restarted
+// memory system apart even when its state lives at the same address
+internal std::atomic<u64> memory_generation{0};
+
+// Shards are handed out round robin the first time each thread allocates
+internal std::atomic<u32> next_shard_index{0};
+internal thread_local s32 thread_shard_index = -1;
+
+internal Memory_Stats_Shard* memory_get_thread_shard() {
+    if (thread_shard_index < 0)
+        thread_shard_index = next_shard_index.fetch_add(1, std::memory_order_relaxed) % MEMORY_STATS_SHARD_COUNT;
+
+    return &state_ptr->shards[thread_shard_index];
+}
+
+internal u64 memory_sum_shards(std::atomic<u64> Memory_Stats_Shard::* counter) {
+    u64 sum = 0;
+    for (u32 i = 0; i < MEMORY_STATS_SHARD_COUNT; ++i)
+        sum += (state_ptr->shards[i].*counter).load(std::memory_order_relaxed);
+    return sum;
+}
+
+internal u64 memory_sum_tag_shards(std::atomic<u64> (Memory_Stats_Shard::*counters)[MEMORY_TAG_COUNT], u64 tag) {
+    u64 sum = 0;
+    for (u32 i = 0; i < MEMORY_STATS_SHARD_COUNT; ++i)
+        sum += (state_ptr->shards[i].*counters)[tag].load(std::memory_order_relaxed);
+    return sum;
+}
+
+// Raise the peak of the tag to the current total if it is higher
+internal u64 memory_update_peak(u64 tag) {
+    u64 current = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_allocations, tag);
+    u64 peak = state_ptr->tagged_peak[tag].load(std::memory_order_relaxed);
+
+    while (current > peak &&
+           !state_ptr->tagged_peak[tag].compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+    }
+
+    return current > peak ? current : peak;
+}
+
+internal void memory_add_tag_bytes(Memory_Stats_Shard* shard, u64 tag, u64 size) {
+    u64 shard_total = shard->tagged_allocations[tag].fetch_add(size, std::memory_order_relaxed) + size;
+
+    // Compared as signed since the net bytes of a shard can be below 0
+    if ((s64)shard_total > (s64)shard->tagged_shard_peak[tag].load(std::memory_order_relaxed)) {
+        shard->tagged_shard_peak[tag].store(shard_total, std::memory_order_relaxed);
+        memory_update_peak(tag);
+    }
+}
+
 internal const char* memory_tag_strings[(u64)Memory_Tag::MAX_ENTRIES] = {
     "UNKNOWN  	:",
     "DARRAY   	:",
     "LINEAR_ALLOC	:",
+    "POOL_ALLOC	:",
+    "STACK_ALLOC	:",
+    "DYNAMIC_ALLOC	:",
     "EVENTS   	:",
     "STRING   	:",
     "GAME     	:",
     "INPUT 		:",
     "RENDERER 	:",
-    "APPLICATION	:"};
+    "APPLICATION	:",
+    "SCRATCH  	:",
+    "DRIVER   	:"};
+
+// Tells the core that it is spinning, which leaves the execution resources to
+// the other hardware thread and avoids a stall when leaving the loop
+internal void memory_spin_pause() {
+#if ENGINE_PLATFORM_WINDOWS
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// The locks of the memory system are held for a single call of an allocator,
+// so a waiting thread first spins with a pause between the reads. Past
+// MEMORY_LOCK_SPIN_COUNT the holder was likely preempted, and the thread
+// yields its core instead of burning it until the holder runs again
+internal void memory_lock(std::atomic_flag* lock) {
+    u32 spins = 0;
+
+    while (lock->test_and_set(std::memory_order_acquire)) {
+        // Plain reads keep the cache line shared until the lock is released
+        while (lock->test(std::memory_order_relaxed)) {
+            if (spins < MEMORY_LOCK_SPIN_COUNT) {
+                memory_spin_pause();
+                ++spins;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+internal void memory_unlock(std::atomic_flag* lock) {
+    lock->clear(std::memory_order_release);
+}
+
+internal void memory_tracker_lock() {
+    memory_lock(&state_ptr->tracker_lock);
+}
+
+internal void memory_tracker_unlock() {
+    memory_unlock(&state_ptr->tracker_lock);
+}
+
+// Threads get a small index for the allocation trace the first time they are
+// traced, which is easier to read than the OS thread ids
+internal std::atomic<u32> next_trace_thread_index{0};
+internal thread_local s32 thread_trace_index = -1;
+
+internal void memory_trace(Allocation_Trace_Event event, const void* block, u64 size, Memory_Tag tag) {
+    if (thread_trace_index < 0)
+        thread_trace_index = next_trace_thread_index.fetch_add(1, std::memory_order_relaxed);
+
+    memory_lock(&state_ptr->trace_lock);
+    Allocation_Trace_Buffer* full_buffer = allocation_trace_record(
+        &state_ptr->trace, event, block, size, tag, thread_trace_index);
+    memory_unlock(&state_ptr->trace_lock);
+
+    // Written out of the lock, the other threads keep recording into the
+    // second buffer meanwhile
+    if (full_buffer)
+        allocation_trace_write(&state_ptr->trace, full_buffer);
+}
+
+internal void memory_guard_lock() {
+    memory_lock(&state_ptr->guard_lock);
+}
+
+internal void memory_guard_unlock() {
+    memory_unlock(&state_ptr->guard_lock);
+}
+
+internal void memory_heap_lock() {
+    memory_lock(&state_ptr->heap_lock);
+}
 
-void memory_startup(u64* memory_system_mem_req, void* state) {
-    *memory_system_mem_req = sizeof(Memory_System_State);
+internal void memory_heap_unlock() {
+    memory_unlock(&state_ptr->heap_lock);
+}
+
+void memory_startup(
+    u64* memory_system_mem_req,
+    void* state,
+    const Memory_System_Config* config) {
+
+    u32 record_capacity = config->tracking_record_capacity
+                              ? config->tracking_record_capacity
+                              : MEMORY_TRACKING_DEFAULT_RECORD_CAPACITY;
+    u32 site_capacity = config->tracking_site_capacity
+                            ? config->tracking_site_capacity
+                            : MEMORY_TRACKING_DEFAULT_SITE_CAPACITY;
+
+    u64 guard_reserve_size = config->guard_reserve_size
+                                 ? config->guard_reserve_size
+                                 : MEMORY_GUARD_DEFAULT_RESERVE_SIZE;
+
+    u32 trace_record_capacity = config->trace_buffer_records
+                                    ? config->trace_buffer_records
+                                    : MEMORY_TRACE_DEFAULT_BUFFER_RECORDS;
+
+    u64 tracker_mem_req = config->track_allocations
+                              ? allocation_tracker_memory_requirement(record_capacity, site_capacity)
+                              : 0;
+
+    u64 guard_mem_req = config->guard_mode != Memory_Guard_Mode::DISABLED
+                            ? guard_allocator_memory_requirement(guard_reserve_size)
+                            : 0;
+
+    u64 trace_mem_req = config->trace_path
+                            ? allocation_trace_memory_requirement(trace_record_capacity)
+                            : 0;
+
+    // The state, with room to align the shards to the cache line since the
+    // state memory is only guaranteed to have the default alignment
+    *memory_system_mem_req = sizeof(Memory_System_State) + MEMORY_CACHE_LINE_SIZE;
+    // Followed by the tables of the allocation tracking
+    *memory_system_mem_req += tracker_mem_req;
+    // Then the page bitmap of the guard allocator
+    *memory_system_mem_req += guard_mem_req;
+    // And last the buffers of the allocation trace
+    *memory_system_mem_req += trace_mem_req;
 
     if (state == nullptr) {
         return;
     }
 
-    state_ptr = static_cast<Memory_System_State*>(state);
-    state_ptr->allocations_count = 0;
+    u64 aligned_state = (reinterpret_cast<u64>(state) + MEMORY_CACHE_LINE_SIZE - 1) & ~(MEMORY_CACHE_LINE_SIZE - 1);
+    state_ptr = reinterpret_cast<Memory_System_State*>(aligned_state);
+    memory_generation.fetch_add(1, std::memory_order_relaxed);
+
+    u8* tracker_memory = reinterpret_cast<u8*>(state_ptr + 1);
+    u8* guard_memory = tracker_memory + tracker_mem_req;
+    u8* trace_memory = guard_memory + guard_mem_req;
+
+    platform_zero_memory(state_ptr, sizeof(Memory_System_State));
+
+    if (config->track_allocations) {
+        state_ptr->track_allocations = allocation_tracker_create(
+            record_capacity,
+            site_capacity,
+            tracker_memory,
+            &state_ptr->tracker);
+    }
+
+    if (config->guard_mode != Memory_Guard_Mode::DISABLED) {
+        state_ptr->guard_pages = guard_allocator_create(
+            guard_reserve_size,
+            config->guard_mode,
+            guard_memory,
+            &state_ptr->guard);
+
+        if (state_ptr->guard_pages)
+            ENGINE_WARN("Memory guard pages enabled, every allocation gets its own pages");
+    }
+
+    if (config->trace_path) {
+        state_ptr->trace_allocations = allocation_trace_create(
+            config->trace_path,
+            trace_record_capacity,
+            trace_memory,
+            &state_ptr->trace);
+
+        if (state_ptr->trace_allocations)
+            ENGINE_INFO("Recording the allocation trace to '%s'", config->trace_path);
+    }
+
+    // The guard allocator replaces the heap
+    u64 heap_size = state_ptr->guard_pages ? 0 : config->heap_size;
+    b8 heap_huge_pages = config->heap_huge_pages;
+
+    // The heap memory is requested straight from the platform since it is the
+    // memory that the memory_allocate calls will be served from. It is
+    // committed at once, the OS still backs the pages only when first touched
+    u64 page_size = platform_get_page_size();
+    if (heap_huge_pages && platform_get_huge_page_size())
+        page_size = platform_get_huge_page_size();
+    else
+        heap_huge_pages = false;
+
+    state_ptr->heap_size = (heap_size + page_size - 1) & ~(page_size - 1);
+    state_ptr->heap_huge_pages = heap_huge_pages;
+    state_ptr->heap_memory = nullptr;
+
+    if (state_ptr->heap_size) {
+        state_ptr->heap_memory = platform_reserve_memory(state_ptr->heap_size, heap_huge_pages);
+
+        if (!state_ptr->heap_memory ||
+            !platform_commit_memory(state_ptr->heap_memory, state_ptr->heap_size) ||
+            !dynamic_allocator_create(state_ptr->heap_size, state_ptr->heap_memory, &state_ptr->heap)) {
+            ENGINE_ERROR("Failed to create the engine heap of %llu bytes. Falling back to the platform allocator", heap_size);
+
+            if (state_ptr->heap_memory)
+                platform_release_memory(state_ptr->heap_memory, state_ptr->heap_size);
+
+            state_ptr->heap_memory = nullptr;
+            state_ptr->heap_size = 0;
+        }
+    }
+
+    memory_refresh_huge_page_usage();
 
-    platform_zero_memory(&state_ptr->stats, sizeof(Memory_Stats));
     ENGINE_DEBUG("Memory subsystem initialized");
 }
 
 void memory_shutdown(void* state) {
+    if (state_ptr && state_ptr->track_allocations) {
+        allocation_tracker_report_leaks(&state_ptr->tracker);
+        allocation_tracker_destroy(&state_ptr->tracker);
+        state_ptr->track_allocations = false;
+    }
+
+    if (state_ptr && state_ptr->trace_allocations) {
+        allocation_trace_destroy(&state_ptr->trace);
+        state_ptr->trace_allocations = false;
+    }
+
+    if (state_ptr && state_ptr->guard_pages) {
+        if (state_ptr->guard.allocated_blocks)
+            ENGINE_WARN("Memory subsystem shutting down with %llu guarded blocks still allocated", state_ptr->guard.allocated_blocks);
+
+        guard_allocator_destroy(&state_ptr->guard);
+        state_ptr->guard_pages = false;
+    }
+
+    if (state_ptr && state_ptr->heap_memory) {
+        if (state_ptr->heap.allocated_blocks)
+            ENGINE_WARN("Memory subsystem shutting down with %llu heap blocks still allocated", state_ptr->heap.allocated_blocks);
+
+        dynamic_allocator_destroy(&state_ptr->heap);
+        platform_release_memory(state_ptr->heap_memory, state_ptr->heap_size);
+        state_ptr->heap_memory = nullptr;
+    }
+
+    // Allocations performed after the shutdown go straight to the platform
+    state_ptr = nullptr;
+
     ENGINE_DEBUG("Memory subsystem shutting down...");
 }
 
-void* memory_allocate(u64 size, Memory_Tag tag) {
+internal void memory_fire_budget_event(u64 tag, u32 hard, u64 bytes) {
+    Event_Context context = {};
+    context.data.u32[0] = static_cast<u32>(tag);
+    context.data.u32[1] = hard;
+    context.data.u64[1] = bytes;
+
+    event_fire(Event_Code::MEMORY_BUDGET_EXCEEDED, nullptr, context);
+}
+
+// Returns false when the allocation must fail because of the hard limit
+internal b8 memory_check_budget(u64 tag, u64 size) {
+    Memory_Budget* budget = &state_ptr->budgets[tag];
+
+    if (!budget->soft_limit && !budget->hard_limit)
+        return true;
+
+    u64 current = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_allocations, tag);
+
+    if (budget->hard_limit && current + size > budget->hard_limit) {
+        // Keep evicting only while the callback makes progress, so a callback
+        // that cannot free enough does not loop forever
+        while (budget->evict && current + size > budget->hard_limit) {
+            if (!budget->evict((Memory_Tag)tag, current + size - budget->hard_limit, budget->evict_user_data))
+                break;
+
+            u64 after_eviction = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_allocations, tag);
+            if (after_eviction >= current)
+                break;
+
+            current = after_eviction;
+        }
+
+        if (current + size > budget->hard_limit) {
+            ENGINE_ERROR(
+                "memory_allocate - Allocation of %llu bytes for tag %llu exceeds its hard limit of %llu bytes (%llu in use)",
+                size, tag, budget->hard_limit, current);
+
+            memory_fire_budget_event(tag, 1, current + size);
+            return false;
+        }
+    }
+
+    // Fired only when crossing the limit, not on every allocation above it
+    if (budget->soft_limit && current < budget->soft_limit && current + size >= budget->soft_limit) {
+        ENGINE_WARN(
+            "Tag %llu crossed its soft memory limit of %llu bytes",
+            tag, budget->soft_limit);
+
+        memory_fire_budget_event(tag, 0, current + size);
+    }
+
+    return true;
+}
+
+// Trace and tracking of a block handed out to the caller
+internal void memory_record_allocation(
+    void* block,
+    u64 size,
+    Memory_Tag tag,
+    const char* file,
+    u32 line) {
+
+    if (state_ptr->trace_allocations)
+        memory_trace(Allocation_Trace_Event::ALLOCATE, block, size, tag);
+
+    if (state_ptr->track_allocations) {
+        memory_tracker_lock();
+        allocation_tracker_add(
+            &state_ptr->tracker,
+            block,
+            size,
+            tag,
+            file,
+            line,
+            static_cast<u32>(state_ptr->last_frame_stats.frame_index));
+        memory_tracker_unlock();
+    }
+}
+
+// Trace and tracking of a block given back by the caller
+internal void memory_record_deallocation(
+    void* block,
+    u64 size,
+    Memory_Tag tag,
+    const char* function) {
+
+    if (state_ptr->trace_allocations)
+        memory_trace(Allocation_Trace_Event::FREE, block, size, tag);
+
+    if (state_ptr->track_allocations) {
+        Allocation_Record record;
+
+        memory_tracker_lock();
+        b8 tracked = allocation_tracker_remove(&state_ptr->tracker, block, &record);
+        memory_tracker_unlock();
+
+        // A wrong size silently corrupts the per tag statistics, so catch
+        // it where it happens. Untracked blocks were allocated before the
+        // tracking started or when its tables were full
+        if (tracked && (record.size != size || record.tag != tag)) {
+            ENGINE_WARN(
+                "%s - Block of %llu bytes (tag %u) allocated at %s:%u is released as %llu bytes (tag %u)",
+                function,
+                record.size, (u32)record.tag,
+                record.file, record.line,
+                size, (u32)tag);
+        }
+    }
+}
+
+// Every platform block of the memory system is allocated with an explicit
+// alignment, so that all of them can be released with the same call no matter
+// which alignment they were requested with. The budget is checked by the
+// callers, and the stats are charged only once the block exists
+internal void* memory_allocate_unbudgeted(
+    u64 size,
+    u64 alignment,
+    Memory_Tag tag,
+    const char* file,
+    u32 line) {
     if (tag == Memory_Tag::UNKNOWN) {
         ENGINE_WARN("The memory is being initialized as UNKNOWN. Please allocated it with the proper tag");
     }
 
+    RUNTIME_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+    if (alignment < MEMORY_DEFAULT_ALIGNMENT)
+        alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+    void* block = nullptr;
+    u64 overhead = 0;
+
     if (state_ptr) {
+        if (state_ptr->guard_pages) {
+            memory_guard_lock();
+            block = guard_allocator_allocate(&state_ptr->guard, size, alignment);
+            memory_guard_unlock();
 
-        state_ptr->stats.tagged_allocations[(u64)tag] += size;
-        state_ptr->stats.total_allocated += size;
-        state_ptr->allocations_count++;
+            if (block)
+                overhead = guard_allocator_block_size(&state_ptr->guard, size) - size;
+        } else if (state_ptr->heap_memory) {
+            memory_heap_lock();
+            block = dynamic_allocator_allocate_aligned(&state_ptr->heap, size, alignment);
+            if (block)
+                overhead = dynamic_allocator_block_size(block) - size;
+            memory_heap_unlock();
+
+            if (!block)
+                ENGINE_WARN("Engine heap cannot fit %llu bytes. Falling back to the platform allocator", size);
+        }
     }
 
-    // Every chunk of memory will be set to 0 automatically
-    void* block = platform_allocate(size, true);
+    if (!block)
+        block = platform_allocate(size, alignment);
+
+    if (!block || !state_ptr)
+        return block;
+
+    Memory_Stats_Shard* shard = memory_get_thread_shard();
+    u64 tag_index = (u64)tag;
+
+    memory_add_tag_bytes(shard, tag_index, size);
+    shard->tagged_allocation_count[tag_index].fetch_add(1, std::memory_order_relaxed);
+    shard->uninitialized_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (overhead)
+        shard->tagged_heap_overhead[tag_index].fetch_add(overhead, std::memory_order_relaxed);
+
+    memory_record_allocation(block, size, tag, file, line);
+
+    return block;
+}
+
+internal void* memory_allocate_block(
+    u64 size,
+    u64 alignment,
+    Memory_Tag tag,
+    const char* file,
+    u32 line) {
+
+    if (state_ptr && !memory_check_budget((u64)tag, size))
+        return nullptr;
+
+    return memory_allocate_unbudgeted(size, alignment, tag, file, line);
+}
+
+void* memory_allocate_at(u64 size, Memory_Tag tag, const char* file, u32 line) {
+    return memory_allocate_aligned_at(size, MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+}
+
+void* memory_allocate_uninitialized_at(u64 size, Memory_Tag tag, const char* file, u32 line) {
+    return memory_allocate_block(size, MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+}
+
+void* memory_allocate_aligned_uninitialized_at(u64 size, u64 alignment, Memory_Tag tag, const char* file, u32 line) {
+    return memory_allocate_block(size, alignment, tag, file, line);
+}
+
+void* memory_allocate_aligned_at(u64 size, u64 alignment, Memory_Tag tag, const char* file, u32 line) {
+    void* block = memory_allocate_block(size, alignment, tag, file, line);
+
+    if (!block)
+        return nullptr;
+
+    if (state_ptr) {
+        Memory_Stats_Shard* shard = memory_get_thread_shard();
+        shard->uninitialized_bytes.fetch_sub(size, std::memory_order_relaxed);
+        shard->zeroed_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
 
+    // Every chunk of memory will be set to 0 automatically
     platform_zero_memory(block, size);
 
     return block;
 }
 
+// A block resized by its allocator is accounted as the release of the old
+// block followed by the allocation of the new one, even when it did not move
+internal void memory_account_resize(
+    void* old_block,
+    void* new_block,
+    u64 old_size,
+    u64 new_size,
+    u64 old_overhead,
+    u64 new_overhead,
+    Memory_Tag tag,
+    const char* file,
+    u32 line) {
+
+    Memory_Stats_Shard* shard = memory_get_thread_shard();
+    u64 tag_index = (u64)tag;
+
+    // Released first, so the peak does not count both sizes at once
+    shard->tagged_allocations[tag_index].fetch_sub(old_size, std::memory_order_relaxed);
+    memory_add_tag_bytes(shard, tag_index, new_size);
+
+    shard->tagged_allocation_count[tag_index].fetch_add(1, std::memory_order_relaxed);
+    shard->tagged_deallocation_count[tag_index].fetch_add(1, std::memory_order_relaxed);
+
+    // The bytes past the old size are handed out without zeroing
+    if (new_size > old_size)
+        shard->uninitialized_bytes.fetch_add(new_size - old_size, std::memory_order_relaxed);
+
+    shard->tagged_heap_overhead[tag_index].fetch_sub(old_overhead, std::memory_order_relaxed);
+    shard->tagged_heap_overhead[tag_index].fetch_add(new_overhead, std::memory_order_relaxed);
+
+    memory_record_deallocation(old_block, old_size, tag, "memory_reallocate");
+    memory_record_allocation(new_block, new_size, tag, file, line);
+}
+
+void* memory_reallocate_at(
+    void* block,
+    u64 old_size,
+    u64 new_size,
+    Memory_Tag tag,
+    const char* file,
+    u32 line) {
+
+    if (!block)
+        return memory_allocate_block(new_size, MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+
+    if (!state_ptr)
+        return platform_reallocate(block, old_size, new_size, MEMORY_DEFAULT_ALIGNMENT);
+
+    // The old block stays charged until it is released, so only the growth
+    // counts against the budget, also when the block has to move
+    if (new_size > old_size && !memory_check_budget((u64)tag, new_size - old_size))
+        return nullptr;
+
+    // Guard blocks always move, which also makes the stale pointers to the old
+    // block fault right away
+    if (!state_ptr->guard_pages) {
+        if (state_ptr->heap_memory &&
+            dynamic_allocator_owns(&state_ptr->heap, block)) {
+
+            memory_heap_lock();
+            u64 old_overhead = dynamic_allocator_block_size(block) - old_size;
+            b8 resized = dynamic_allocator_resize(&state_ptr->heap, block, new_size);
+            u64 new_overhead = resized ? dynamic_allocator_block_size(block) - new_size : 0;
+            memory_heap_unlock();
+
+            if (resized) {
+                memory_account_resize(
+                    block, block,
+                    old_size, new_size,
+                    old_overhead, new_overhead,
+                    tag, file, line);
+
+                return block;
+            }
+        } else {
+            // Blocks allocated before the startup or when the heap was full
+            void* new_block = platform_reallocate(block, old_size, new_size, MEMORY_DEFAULT_ALIGNMENT);
+            if (!new_block)
+                return nullptr;
+
+            memory_account_resize(block, new_block, old_size, new_size, 0, 0, tag, file, line);
+
+            return new_block;
+        }
+    }
+
+    void* new_block = memory_allocate_unbudgeted(new_size, MEMORY_DEFAULT_ALIGNMENT, tag, file, line);
+    if (!new_block)
+        return nullptr;
+
+    memory_copy(new_block, block, old_size < new_size ? old_size : new_size);
+    memory_deallocate(block, old_size, tag);
+
+    return new_block;
+}
+
 void memory_deallocate(void* block, u64 size, Memory_Tag tag) {
+    // Like free, releasing nullptr does nothing
+    if (!block)
+        return;
 
     if (state_ptr) {
+        Memory_Stats_Shard* shard = memory_get_thread_shard();
+        u64 tag_index = (u64)tag;
+
+        shard->tagged_allocations[tag_index].fetch_sub(size, std::memory_order_relaxed);
+        shard->tagged_deallocation_count[tag_index].fetch_add(1, std::memory_order_relaxed);
+
+        memory_record_deallocation(block, size, tag, "memory_deallocate");
+
+        if (state_ptr->guard_pages &&
+            guard_allocator_owns(&state_ptr->guard, block)) {
 
-        state_ptr->stats.tagged_allocations[(u64)tag] -= size;
-        state_ptr->stats.total_allocated -= size;
+            shard->tagged_heap_overhead[tag_index].fetch_sub(
+                guard_allocator_block_size(&state_ptr->guard, size) - size,
+                std::memory_order_relaxed);
+
+            memory_guard_lock();
+            guard_allocator_free(&state_ptr->guard, block, size);
+            memory_guard_unlock();
+            return;
+        }
+
+        // Blocks allocated before the memory system startup or when the heap
+        // was full come from the platform, so check the owner before freeing
+        if (state_ptr->heap_memory &&
+            dynamic_allocator_owns(&state_ptr->heap, block)) {
+
+            memory_heap_lock();
+            u64 overhead = dynamic_allocator_block_size(block) - size;
+            dynamic_allocator_free(&state_ptr->heap, block);
+            memory_heap_unlock();
+
+            shard->tagged_heap_overhead[tag_index].fetch_sub(overhead, std::memory_order_relaxed);
+            return;
+        }
     }
 
-    return platform_free(block, true);
+    return platform_free(block, MEMORY_DEFAULT_ALIGNMENT);
 }
 
 void* memory_zero(void* block, u64 size) {
@@ -125,53 +806,437 @@ void* memory_set(void* block, s32 value, u64 size) {
     return platform_set_memory(block, value, size);
 }
 
-char* memory_get_current_usage() {
-    char utilization_buffer[5000] = "Summary of allocated memory (tagged):\n";
+// Convert an amount of bytes to the largest unit that keeps it above 1. The
+// out_unit buffer must be able to hold at least 4 characters
+internal f32 memory_size_to_unit(u64 bytes, char* out_unit) {
+    out_unit[1] = 'i';
+    out_unit[2] = 'B';
+    out_unit[3] = 0;
 
-    u64 offset = strlen(utilization_buffer); // The offset is represented in number of bytes
+    if (bytes >= GIB) {
+        out_unit[0] = 'G';
+        return (float)bytes / GIB;
+    } else if (bytes >= MIB) {
+        out_unit[0] = 'M';
+        return (float)bytes / MIB;
+    } else if (bytes >= KIB) {
+        out_unit[0] = 'K';
+        return (float)bytes / KIB;
+    }
 
-    u64 max_tags = static_cast<u64>(Memory_Tag::MAX_ENTRIES);
-    for (u32 i = 0; i < max_tags; ++i) {
-        char usage_unit[4] = "XiB";
-        f32 amount = 1.0f;
+    out_unit[0] = 'B';
+    out_unit[1] = 0; // Append a null termination character to overwrite the end of the string
+    return (float)bytes;
+}
 
-        if (state_ptr->stats.tagged_allocations[i] >= GIB) {
-            usage_unit[0] = 'G';
-            amount = (float)state_ptr->stats.tagged_allocations[i] / GIB;
-        } else if (state_ptr->stats.tagged_allocations[i] >= MIB) {
-            usage_unit[0] = 'M';
-            amount = (float)state_ptr->stats.tagged_allocations[i] / MIB;
-        } else if (state_ptr->stats.tagged_allocations[i] >= KIB) {
-            usage_unit[0] = 'K';
-            amount = (float)state_ptr->stats.tagged_allocations[i] / KIB;
-        } else {
-            usage_unit[0] = 'B';
-            usage_unit[1] = 0; // Append a null termination character to overwrite the end of the string
-            amount = (float)state_ptr->stats.tagged_allocations[i];
+// snprintf into the remaining space of the buffer. Once the buffer is full the
+// output is truncated and the offset stops at the last character
+internal void memory_append(char* buffer, u64 buffer_size, u64* offset, const char* format, ...) {
+    if (*offset + 1 >= buffer_size)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    // vsnprintf returns the number of characters it would have written,
+    // negative when there was an error
+    s32 length = vsnprintf(buffer + *offset, buffer_size - *offset, format, args);
+    va_end(args);
+
+    if (length > 0)
+        *offset += length;
+
+    if (*offset >= buffer_size)
+        *offset = buffer_size - 1;
+}
+
+u64 memory_get_current_usage(char* buffer, u64 buffer_size) {
+    if (!buffer || buffer_size == 0)
+        return 0;
+
+    buffer[0] = 0;
+
+    if (!state_ptr)
+        return 0;
+
+    Memory_Stats stats;
+    memory_get_stats(&stats);
+
+    u64 offset = 0; // The offset is represented in number of bytes
+    memory_append(buffer, buffer_size, &offset, "Summary of allocated memory (tagged):\n");
+
+    for (u32 i = 0; i < MEMORY_TAG_COUNT; ++i) {
+        Memory_Tag_Stats* tag_stats = &stats.tags[i];
+
+        char usage_unit[4];
+        char peak_unit[4];
+        f32 amount = memory_size_to_unit(tag_stats->allocated, usage_unit);
+        f32 peak = memory_size_to_unit(tag_stats->peak_allocated, peak_unit);
+
+        memory_append(
+            buffer, buffer_size, &offset,
+            "%s %.2f %s (peak %.2f %s, %llu allocations)",
+            memory_tag_strings[i],
+            amount, usage_unit,
+            peak, peak_unit,
+            tag_stats->allocation_count);
+
+        if ((state_ptr->heap_memory || state_ptr->guard_pages) && tag_stats->heap_overhead) {
+            char overhead_unit[4];
+            f32 overhead = memory_size_to_unit(
+                tag_stats->heap_overhead,
+                overhead_unit);
+
+            memory_append(
+                buffer, buffer_size, &offset,
+                " (+%.2f %s heap overhead)", overhead, overhead_unit);
+        }
+
+        memory_append(buffer, buffer_size, &offset, "\n");
+    }
+
+    char zeroed_unit[4];
+    char uninitialized_unit[4];
+    f32 zeroed = memory_size_to_unit(stats.zeroed_bytes, zeroed_unit);
+    f32 uninitialized = memory_size_to_unit(stats.uninitialized_bytes, uninitialized_unit);
+
+    memory_append(
+        buffer, buffer_size, &offset,
+        "Zeroed on allocation: %.2f %s, not zeroed: %.2f %s\n",
+        zeroed, zeroed_unit,
+        uninitialized, uninitialized_unit);
+
+    if (state_ptr->heap_memory) {
+        Dynamic_Allocator_Stats heap_stats;
+        memory_heap_lock();
+        dynamic_allocator_get_stats(&state_ptr->heap, &heap_stats);
+        memory_heap_unlock();
+
+        char used_unit[4];
+        char total_unit[4];
+        char largest_unit[4];
+        f32 used = memory_size_to_unit(heap_stats.allocated, used_unit);
+        f32 total = memory_size_to_unit(heap_stats.total_size, total_unit);
+        f32 largest = memory_size_to_unit(heap_stats.largest_free_block, largest_unit);
+
+        // External fragmentation: share of the free space that cannot be
+        // handed out as a single block
+        f32 fragmentation = heap_stats.free_space
+                                ? 100.0f * (1.0f - (float)heap_stats.largest_free_block / heap_stats.free_space)
+                                : 0.0f;
+
+        memory_append(
+            buffer, buffer_size, &offset,
+            "Heap: %.2f %s of %.2f %s in %llu blocks, %llu free blocks, largest free %.2f %s, fragmentation %.2f%%\n",
+            used, used_unit,
+            total, total_unit,
+            heap_stats.allocated_blocks,
+            heap_stats.free_blocks,
+            largest, largest_unit,
+            fragmentation);
+    }
+
+    if (state_ptr->guard_pages) {
+        char guarded_unit[4];
+        f32 guarded = memory_size_to_unit(
+            state_ptr->guard.allocated_pages * state_ptr->guard.page_size,
+            guarded_unit);
+
+        memory_append(
+            buffer, buffer_size, &offset,
+            "Guard pages: %llu blocks in %.2f %s of pages (%s guarded)\n",
+            state_ptr->guard.allocated_blocks,
+            guarded, guarded_unit,
+            state_ptr->guard.mode == Memory_Guard_Mode::OVERRUN ? "overrun" : "underrun");
+    }
+
+    char huge_unit[4];
+    f32 huge = memory_size_to_unit(
+        state_ptr->huge_page_usage.load(std::memory_order_relaxed),
+        huge_unit);
+
+    if (state_ptr->track_allocations) {
+        memory_append(
+            buffer, buffer_size, &offset,
+            "Tracking: %u live blocks from %u allocation sites\n",
+            state_ptr->tracker.record_count,
+            state_ptr->tracker.site_count);
+    }
+
+    memory_append(
+        buffer, buffer_size, &offset,
+        "Huge page backed: %.2f %s at the last refresh (heap huge pages %s)\n",
+        huge, huge_unit,
+        state_ptr->heap_huge_pages ? "on" : "off");
+
+    return offset;
+}
+
+u64 memory_refresh_huge_page_usage() {
+    if (!state_ptr)
+        return 0;
+
+    // Reported by the OS, so it also covers the huge pages of the arenas and
+    // whatever the transparent huge pages daemon collapsed on its own
+    u64 usage = platform_get_huge_page_usage();
+    state_ptr->huge_page_usage.store(usage, std::memory_order_relaxed);
+
+    return usage;
+}
+
+b8 memory_get_stats(Memory_Stats* out_stats) {
+    if (!state_ptr || !out_stats)
+        return false;
+
+    platform_zero_memory(out_stats, sizeof(Memory_Stats));
+
+    for (u32 i = 0; i < MEMORY_TAG_COUNT; ++i) {
+        Memory_Tag_Stats* tag_stats = &out_stats->tags[i];
+        memory_get_tag_stats((Memory_Tag)i, tag_stats);
+
+        out_stats->total_allocated += tag_stats->allocated;
+        out_stats->allocation_count += tag_stats->allocation_count;
+        out_stats->deallocation_count += tag_stats->deallocation_count;
+    }
+
+    out_stats->zeroed_bytes = memory_sum_shards(&Memory_Stats_Shard::zeroed_bytes);
+    out_stats->uninitialized_bytes = memory_sum_shards(&Memory_Stats_Shard::uninitialized_bytes);
+
+    if (state_ptr->heap_memory) {
+        out_stats->heap_size = state_ptr->heap_size;
+        memory_heap_lock();
+        out_stats->heap_allocated = state_ptr->heap.allocated;
+        memory_heap_unlock();
+    }
+
+    return true;
+}
+
+// Scratch arena of a thread. The destructor of the thread_local instance runs
+// when the thread exits and returns the arena to the OS
+struct Memory_Thread_Scratch {
+    Virtual_Arena arena;
+
+    // Bytes of the arena already folded into the SCRATCH tag, and the startup
+    // generation they were folded into, since the memory system can be
+    // restarted while the thread lives
+    u64 reported;
+    u64 reported_generation;
+
+    ~Memory_Thread_Scratch();
+};
+
+internal thread_local Memory_Thread_Scratch thread_scratch = {};
+
+// The arena is allocated from directly, so its usage is folded into the stats
+// at the reset points instead of on every allocation
+internal void memory_scratch_sync(Memory_Thread_Scratch* scratch) {
+    if (!state_ptr)
+        return;
+
+    u64 generation = memory_generation.load(std::memory_order_relaxed);
+    if (scratch->reported_generation != generation) {
+        scratch->reported_generation = generation;
+        scratch->reported = 0;
+    }
+
+    u64 delta = scratch->arena.allocated - scratch->reported;
+    if (delta) {
+        // Unsigned wrap around subtracts when the arena shrank
+        memory_add_tag_bytes(memory_get_thread_shard(), (u64)Memory_Tag::SCRATCH, delta);
+        scratch->reported = scratch->arena.allocated;
+    }
+}
+
+Memory_Thread_Scratch::~Memory_Thread_Scratch() {
+    if (arena.memory) {
+        arena.allocated = 0;
+        memory_scratch_sync(this);
+        virtual_arena_destroy(&arena);
+    }
+}
+
+Virtual_Arena* memory_thread_scratch() {
+    Memory_Thread_Scratch* scratch = &thread_scratch;
+
+    if (!scratch->arena.memory) {
+        if (!virtual_arena_create(
+                MEMORY_THREAD_SCRATCH_RESERVE_SIZE,
+                MEMORY_THREAD_SCRATCH_COMMIT_GRANULARITY,
+                false,
+                &scratch->arena)) {
+            ENGINE_ERROR("memory_thread_scratch - Failed to reserve the scratch arena of the thread");
+            return nullptr;
         }
+    }
+
+    return &scratch->arena;
+}
+
+void* memory_scratch_allocate(u64 size) {
+    Virtual_Arena* arena = memory_thread_scratch();
+    if (!arena)
+        return nullptr;
+
+    void* block = virtual_arena_allocate(arena, size);
+    memory_scratch_sync(&thread_scratch);
+
+    return block;
+}
+
+u64 memory_scratch_begin() {
+    Virtual_Arena* arena = memory_thread_scratch();
+    return arena ? virtual_arena_get_marker(arena) : 0;
+}
+
+void memory_scratch_end(u64 marker) {
+    if (!thread_scratch.arena.memory)
+        return;
+
+    virtual_arena_free_to_marker(&thread_scratch.arena, marker);
+    memory_scratch_sync(&thread_scratch);
+}
+
+void memory_scratch_reset() {
+    memory_scratch_end(0);
+}
+
+void memory_end_frame() {
+    if (!state_ptr)
+        return;
+
+    // The frame boundary is a reset point of the scratch arena of the thread
+    // running the main loop
+    memory_scratch_reset();
+
+    Memory_Stats current;
+    memory_get_stats(&current);
 
-        // snprintf returns the number of writen characters (aka bytes). It returns negative number if there was an error
-        s32 length = snprintf(
-            utilization_buffer + offset,
-            sizeof(utilization_buffer) - offset,
-            "%s %.2f %s\n", memory_tag_strings[i], amount, usage_unit);
+    Memory_Stats* previous = &state_ptr->frame_start_stats;
+    Memory_Frame_Stats* frame = &state_ptr->last_frame_stats;
 
-        offset += length;
+    frame->frame_index++;
+    frame->bytes_delta = 0;
+    frame->allocation_count = 0;
+    frame->deallocation_count = 0;
+
+    // The counters only grow and the byte totals wrap consistently, so the
+    // plain differences are exact
+    for (u32 i = 0; i < MEMORY_TAG_COUNT; ++i) {
+        frame->tagged_bytes_delta[i] = (s64)(current.tags[i].allocated - previous->tags[i].allocated);
+        frame->tagged_allocation_count[i] = current.tags[i].allocation_count - previous->tags[i].allocation_count;
+        frame->tagged_deallocation_count[i] = current.tags[i].deallocation_count - previous->tags[i].deallocation_count;
+
+        frame->bytes_delta += frame->tagged_bytes_delta[i];
+        frame->allocation_count += frame->tagged_allocation_count[i];
+        frame->deallocation_count += frame->tagged_deallocation_count[i];
     }
 
-    // In order to use this buffer to another place we need to copy its value into a dynamically allocated memory
-    // This is because the buffer will go out of scope after we return and the value will be jibrish
-    // We need one more byte for the null terminator character as the strlen disregards it
-    u64 length = strlen(utilization_buffer);
-    char* copy = static_cast<char*>(memory_allocate(length + 1, Memory_Tag::STRING));
-    memory_copy(copy, utilization_buffer, length + 1);
+    *previous = current;
+
+    if (state_ptr->trace_allocations)
+        memory_trace(Allocation_Trace_Event::FRAME_END, nullptr, frame->frame_index, Memory_Tag::UNKNOWN);
+}
+
+b8 memory_get_frame_stats(Memory_Frame_Stats* out_stats) {
+    if (!state_ptr || !out_stats)
+        return false;
 
-    return copy;
+    *out_stats = state_ptr->last_frame_stats;
+
+    return true;
+}
+
+b8 memory_get_tag_stats(Memory_Tag tag, Memory_Tag_Stats* out_stats) {
+    if (!state_ptr || !out_stats)
+        return false;
+
+    u64 tag_index = (u64)tag;
+
+    out_stats->allocated = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_allocations, tag_index);
+    out_stats->peak_allocated = memory_update_peak(tag_index);
+    out_stats->allocation_count = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_allocation_count, tag_index);
+    out_stats->deallocation_count = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_deallocation_count, tag_index);
+    out_stats->heap_overhead = memory_sum_tag_shards(&Memory_Stats_Shard::tagged_heap_overhead, tag_index);
+
+    return true;
 }
 
 u64 memory_get_allocations_count() {
     if (state_ptr) {
-        return state_ptr->allocations_count;
+        u64 count = 0;
+        for (u64 i = 0; i < MEMORY_TAG_COUNT; ++i)
+            count += memory_sum_tag_shards(&Memory_Stats_Shard::tagged_allocation_count, i);
+        return count;
     }
     return 0;
 }
+
+u32 memory_get_top_allocation_sites(
+    Allocation_Site_Order order,
+    Allocation_Site* out_sites,
+    u32 max_sites) {
+
+    if (!state_ptr || !state_ptr->track_allocations || !out_sites)
+        return 0;
+
+    memory_tracker_lock();
+    u32 count = allocation_tracker_get_top_sites(&state_ptr->tracker, order, out_sites, max_sites);
+    memory_tracker_unlock();
+
+    return count;
+}
+
+void memory_set_budget(
+    Memory_Tag tag,
+    u64 soft_limit,
+    u64 hard_limit) {
+
+    if (!state_ptr) {
+        ENGINE_ERROR("memory_set_budget - The memory system is not started");
+        return;
+    }
+
+    if (hard_limit && soft_limit > hard_limit)
+        ENGINE_WARN("memory_set_budget - The soft limit is above the hard limit and will never be reached");
+
+    state_ptr->budgets[(u64)tag].soft_limit = soft_limit;
+    state_ptr->budgets[(u64)tag].hard_limit = hard_limit;
+}
+
+void memory_set_eviction_callback(
+    Memory_Tag tag,
+    PFN_Memory_Evict callback,
+    void* user_data) {
+
+    if (!state_ptr) {
+        ENGINE_ERROR("memory_set_eviction_callback - The memory system is not started");
+        return;
+    }
+
+    state_ptr->budgets[(u64)tag].evict = callback;
+    state_ptr->budgets[(u64)tag].evict_user_data = user_data;
+}
+
+void memory_report_top_allocation_sites(
+    Allocation_Site_Order order,
+    u32 count) {
+
+    if (count > MEMORY_TRACKING_MAX_REPORTED_SITES)
+        count = MEMORY_TRACKING_MAX_REPORTED_SITES;
+
+    Allocation_Site sites[MEMORY_TRACKING_MAX_REPORTED_SITES];
+    count = memory_get_top_allocation_sites(order, sites, count);
+
+    for (u32 i = 0; i < count; ++i) {
+        ENGINE_INFO(
+            "%2u. %s:%u (tag %u): %llu allocations, %llu bytes, %llu live blocks, %llu live bytes",
+            i + 1,
+            sites[i].file,
+            sites[i].line,
+            (u32)sites[i].tag,
+            sites[i].allocation_count,
+            sites[i].allocated_bytes,
+            sites[i].live_count,
+            sites[i].live_bytes);
+    }
+}
@@ -6,22 +6,211 @@ enum class Memory_Tag {
     UNKNOWN,
     DARRAY,
     LINEAR_ALLOCATOR,
+    POOL_ALLOCATOR,
+    STACK_ALLOCATOR,
+    DYNAMIC_ALLOCATOR,
     EVENTS,
     STRING,
     GAME,
     INPUT,
     RENDERER,
     APPLICATION,
+    // Bytes in use in the thread scratch arenas, see memory_thread_scratch
+    SCRATCH,
+    // Host memory of the graphics driver, see vulkan_allocator.hpp
+    DRIVER,
     MAX_ENTRIES
 };
 
-void memory_startup(u64* memory_system_mem_req, void* state);
+// Alignment of every block returned by memory_allocate. Large enough for the
+// SIMD types used in the math library
+constexpr u64 MEMORY_DEFAULT_ALIGNMENT = 16;
 
-void memory_shutdown(void* state);
+// The statistics are split in shards, one per thread, each on its own cache
+// lines so that threads allocating concurrently never write to the same line.
+// Threads past the shard count share shards, which stays correct but brings
+// back some contention
+constexpr u64 MEMORY_STATS_SHARD_COUNT = 16;
+constexpr u64 MEMORY_CACHE_LINE_SIZE = 64;
 
-KOALA_API void* memory_allocate(
+struct Memory_Tag_Stats {
+    // Bytes currently allocated
+    u64 allocated;
+    // High water mark of the allocated bytes. Refreshed whenever a thread
+    // reaches a new high in its own shard and on every read, so a peak reached
+    // only because blocks were freed on a different thread than the one that
+    // allocated them can be recorded late
+    u64 peak_allocated;
+    // Number of calls since the startup
+    u64 allocation_count;
+    u64 deallocation_count;
+    // Bytes of the heap blocks on top of the requested sizes
+    u64 heap_overhead;
+};
+
+struct Memory_Stats {
+    Memory_Tag_Stats tags[(u64)Memory_Tag::MAX_ENTRIES];
+
+    // Sums over all the tags
+    u64 total_allocated;
+    u64 allocation_count;
+    u64 deallocation_count;
+
+    // Bytes set to 0 by memory_allocate and bytes handed out without zeroing
+    u64 zeroed_bytes;
+    u64 uninitialized_bytes;
+
+    // Both 0 when the memory system runs without the engine heap
+    u64 heap_size;
+    u64 heap_allocated;
+};
+
+// Activity of a single frame, measured between two memory_end_frame calls
+struct Memory_Frame_Stats {
+    // Number of frames completed so far
+    u64 frame_index;
+
+    // Negative when the frame released more than it allocated
+    s64 tagged_bytes_delta[(u64)Memory_Tag::MAX_ENTRIES];
+    u64 tagged_allocation_count[(u64)Memory_Tag::MAX_ENTRIES];
+    u64 tagged_deallocation_count[(u64)Memory_Tag::MAX_ENTRIES];
+
+    s64 bytes_delta;
+    u64 allocation_count;
+    u64 deallocation_count;
+};
+
+// Large enough for the report of memory_get_current_usage
+constexpr u64 MEMORY_USAGE_STRING_SIZE = 5000;
+
+// Side of the blocks protected by the guard pages, see guard_allocator.hpp
+enum class Memory_Guard_Mode {
+    DISABLED,
+    // Catches reads and writes past the end of the blocks
+    OVERRUN,
+    // Catches reads and writes before the start of the blocks
+    UNDERRUN
+};
+
+struct Memory_System_Config {
+    // When not 0, the memory system reserves a single block of heap_size bytes
+    // from the platform and serves every memory_allocate call from it through
+    // a dynamic allocator, falling back to the platform allocator only when
+    // the heap is exhausted
+    u64 heap_size;
+
+    // Request the heap with huge pages (see platform_reserve_memory) to reduce
+    // the TLB misses when it is traversed. Its size is then rounded up to the
+    // huge page size
+    b8 heap_huge_pages;
+
+    // Debug tracking of every live allocation with its callsite, for the leak
+    // report at shutdown and the ranking of the allocation sites. Costs a lock
+    // and a hash table update on every allocation and deallocation
+    b8 track_allocations;
+
+    // Capacities of the tracking tables, powers of two. 0 selects the defaults
+    u32 tracking_record_capacity;
+    u32 tracking_site_capacity;
+
+    // Debug mode that serves every allocation from the guard page allocator
+    // instead of the heap, so overruns and use after free fault right away.
+    // Very slow and memory hungry, meant for soak tests
+    Memory_Guard_Mode guard_mode;
+
+    // Address space cycled through by the guard page allocator. 0 selects the
+    // default
+    u64 guard_reserve_size;
+
+    // When set, every allocation, deallocation and frame end is recorded to a
+    // binary trace at this path (see allocation_trace.hpp), to be analyzed
+    // offline with the trace_analyzer tool
+    const char* trace_path;
+
+    // Records buffered in memory between two writes to the trace file. 0
+    // selects the default
+    u32 trace_buffer_records;
+};
+
+constexpr u32 MEMORY_TRACKING_DEFAULT_RECORD_CAPACITY = 1 << 16;
+constexpr u32 MEMORY_TRACKING_DEFAULT_SITE_CAPACITY = 1 << 12;
+constexpr u64 MEMORY_GUARD_DEFAULT_RESERVE_SIZE = 64 * GIB;
+constexpr u32 MEMORY_TRACE_DEFAULT_BUFFER_RECORDS = 1 << 14;
+
+// The requirement depends on the config, so both calls must pass the same one
+KOALA_API void memory_startup(
+    u64* memory_system_mem_req,
+    void* state,
+    const Memory_System_Config* config);
+
+KOALA_API void memory_shutdown(void* state);
+
+// The allocation functions are called through the macros below, which pass
+// the callsite for the allocation tracking
+KOALA_API void* memory_allocate_at(
     u64 size,
-    Memory_Tag tag);
+    Memory_Tag tag,
+    const char* file,
+    u32 line);
+
+// Same as memory_allocate, but the block is not set to 0. Meant for buffers
+// that are entirely overwritten right after the allocation (file contents,
+// copies etc.), where zeroing first would just double the bytes written
+KOALA_API void* memory_allocate_uninitialized_at(
+    u64 size,
+    Memory_Tag tag,
+    const char* file,
+    u32 line);
+
+// Same as memory_allocate, but the block is aligned to the given power of two
+// alignment. Alignments below MEMORY_DEFAULT_ALIGNMENT are raised to it. The
+// block is released with memory_deallocate like any other block
+KOALA_API void* memory_allocate_aligned_at(
+    u64 size,
+    u64 alignment,
+    Memory_Tag tag,
+    const char* file,
+    u32 line);
+
+// Aligned like memory_allocate_aligned and not set to 0 like
+// memory_allocate_uninitialized
+KOALA_API void* memory_allocate_aligned_uninitialized_at(
+    u64 size,
+    u64 alignment,
+    Memory_Tag tag,
+    const char* file,
+    u32 line);
+
+// Resizes a block of memory_allocate or memory_allocate_uninitialized, keeping
+// its contents up to the smaller of the two sizes. The bytes past the old size
+// are not set to 0. Heap blocks grow in place when the memory that follows
+// them is free, platform blocks through the platform reallocation (mremap for
+// the large blocks on Linux), anything else is moved to a new block. The old
+// pointer is invalid after a successful call and still valid when nullptr is
+// returned. A null block is allocated. Over aligned blocks are not supported,
+// since a moved block only gets the default alignment
+KOALA_API void* memory_reallocate_at(
+    void* block,
+    u64 old_size,
+    u64 new_size,
+    Memory_Tag tag,
+    const char* file,
+    u32 line);
+
+#define memory_allocate(size, tag) \
+    memory_allocate_at(size, tag, __FILE__, __LINE__)
+
+#define memory_allocate_uninitialized(size, tag) \
+    memory_allocate_uninitialized_at(size, tag, __FILE__, __LINE__)
+
+#define memory_allocate_aligned(size, alignment, tag) \
+    memory_allocate_aligned_at(size, alignment, tag, __FILE__, __LINE__)
+
+#define memory_allocate_aligned_uninitialized(size, alignment, tag) \
+    memory_allocate_aligned_uninitialized_at(size, alignment, tag, __FILE__, __LINE__)
+
+#define memory_reallocate(block, old_size, new_size, tag) \
+    memory_reallocate_at(block, old_size, new_size, tag, __FILE__, __LINE__)
 
 KOALA_API void memory_deallocate(
     void* block,
@@ -47,6 +236,105 @@ KOALA_API void* memory_set(
     s32 value,
     u64 size);
 
-KOALA_API char* memory_get_current_usage();
+// Called when an allocation would push the tag past its hard limit. The
+// callback should release memory of the tag, for example by evicting cache
+// entries, and return true if it did. bytes_over is how much must be released
+// for the allocation to fit
+typedef b8 (*PFN_Memory_Evict)(Memory_Tag tag, u64 bytes_over, void* user_data);
+
+// Limits of 0 disable the corresponding check. Crossing the soft limit fires a
+// MEMORY_BUDGET_EXCEEDED event and the allocation proceeds. An allocation that
+// would cross the hard limit first calls the eviction callback of the tag, if
+// any, as long as it frees memory; if it still does not fit the event is fired
+// and the allocation returns nullptr. Tags without a budget skip the checks
+// entirely. With several threads allocating the same tag the limits can be
+// overshot by the allocations in flight
+KOALA_API void memory_set_budget(
+    Memory_Tag tag,
+    u64 soft_limit,
+    u64 hard_limit);
+
+KOALA_API void memory_set_eviction_callback(
+    Memory_Tag tag,
+    PFN_Memory_Evict callback,
+    void* user_data);
+
+// Address space reserved for the scratch arena of each thread. Only the pages
+// actually used are committed
+constexpr u64 MEMORY_THREAD_SCRATCH_RESERVE_SIZE = 256 * MIB;
+constexpr u64 MEMORY_THREAD_SCRATCH_COMMIT_GRANULARITY = 64 * KIB;
+
+struct Virtual_Arena;
+
+// Scratch arena of the calling thread, created on its first use and released
+// when the thread exits. Threads never share it, so allocating from it needs
+// no synchronization. Its usage is folded into the SCRATCH tag at the reset
+// points below, so allocations made straight from the arena are accounted
+// late but never lost
+KOALA_API Virtual_Arena* memory_thread_scratch();
+
+// Allocates from the scratch arena of the calling thread
+KOALA_API void* memory_scratch_allocate(u64 size);
+
+// Reset points. memory_scratch_begin returns a marker and memory_scratch_end
+// releases everything the thread allocated since, so scopes can nest. The
+// main loop resets the scratch arena of its thread in memory_end_frame, worker
+// threads should reset theirs between jobs
+KOALA_API u64 memory_scratch_begin();
+
+KOALA_API void memory_scratch_end(u64 marker);
+
+KOALA_API void memory_scratch_reset();
+
+// Writes a human readable report into the buffer, truncated to fit, and
+// returns the length of the string without the null terminator. Does not
+// allocate, so it can be called every frame. The huge page figure is the one
+// read by the last memory_refresh_huge_page_usage
+KOALA_API u64 memory_get_current_usage(
+    char* buffer,
+    u64 buffer_size);
+
+// Reads the bytes backed by huge pages from the OS and keeps them for the
+// report. On Linux it opens and parses a file under /proc, so it is meant for
+// startup and debug commands and not for every frame
+KOALA_API u64 memory_refresh_huge_page_usage();
 
 KOALA_API u64 memory_get_allocations_count();
+
+// Sums the shards of the tag into out_stats. Does not allocate and is safe to
+// call from any thread. Returns false when the memory system is not started
+KOALA_API b8 memory_get_tag_stats(
+    Memory_Tag tag,
+    Memory_Tag_Stats* out_stats);
+
+// Snapshot of all the statistics into a caller provided struct. Does not
+// allocate. Returns false when the memory system is not started
+KOALA_API b8 memory_get_stats(
+    Memory_Stats* out_stats);
+
+// Closes the current frame of the per-frame statistics and resets the scratch
+// arena of the calling thread. Called by the application once per frame
+KOALA_API void memory_end_frame();
+
+// Statistics of the last completed frame
+KOALA_API b8 memory_get_frame_stats(
+    Memory_Frame_Stats* out_stats);
+
+struct Allocation_Site;
+enum class Allocation_Site_Order;
+
+// Requires the allocation tracking. Fills out_sites with up to max_sites of the
+// allocation sites, sorted in descending order (see allocation_tracker.hpp),
+// and returns how many were written. Does not allocate
+KOALA_API u32 memory_get_top_allocation_sites(
+    Allocation_Site_Order order,
+    Allocation_Site* out_sites,
+    u32 max_sites);
+
+// Logs up to count of the top allocation sites, at most
+// MEMORY_TRACKING_MAX_REPORTED_SITES
+KOALA_API void memory_report_top_allocation_sites(
+    Allocation_Site_Order order,
+    u32 count);
+
+constexpr u32 MEMORY_TRACKING_MAX_REPORTED_SITES = 32;
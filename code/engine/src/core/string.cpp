@@ -34,6 +34,14 @@ s32 string_format_v(
     if (dest) {
         char buffer[32000];
         s32 written = vsnprintf(buffer, 32000, format, va_list);
+        if (written < 0)
+            return -1;
+
+        // vsnprintf returns the length the whole string would have, which can
+        // be past the end of the buffer. Truncate instead of writing past it
+        if (written >= 32000)
+            written = 32000 - 1;
+
         buffer[written] = 0;
         memory_copy(dest, buffer, written + 1);
 
@@ -40,6 +40,8 @@ constexpr u64 GIB (1 << 30);
 constexpr u64 MIB (1 << 20);
 constexpr u64 KIB (1 << 10);
 
+// std::ios_base has a member named internal, so the files that include <ios>,
+// also through headers like <thread>, include the standard headers first
 #define local_persist static
 #define internal static
 #define global_variable static
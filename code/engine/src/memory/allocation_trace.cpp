@@ -0,0 +1,137 @@
+#include <thread>
+
+#include "allocation_trace.hpp"
+#include "core/logger.hpp"
+#include "platform/platform.hpp"
+
+u64 allocation_trace_memory_requirement(
+    u32 record_capacity) {
+
+    return 2 * sizeof(Allocation_Trace_Record) * record_capacity;
+}
+
+internal void allocation_trace_wait(Allocation_Trace_Buffer* buffer) {
+    while (buffer->writing.load(std::memory_order_acquire))
+        std::this_thread::yield();
+}
+
+b8 allocation_trace_create(
+    const char* path,
+    u32 record_capacity,
+    void* memory,
+    Allocation_Trace* out_trace) {
+
+    if (!out_trace || !memory || !path) {
+        ENGINE_ERROR("allocation_trace_create - requires valid pointers to path, memory and out_trace");
+        return false;
+    }
+
+    if (record_capacity == 0) {
+        ENGINE_ERROR("allocation_trace_create - The buffer must hold at least one record");
+        return false;
+    }
+
+    if (!filesystem_open(path, File_Modes::WRITE, true, &out_trace->file))
+        return false;
+
+    Allocation_Trace_Header header = {};
+    header.magic = ALLOCATION_TRACE_MAGIC;
+    header.version = ALLOCATION_TRACE_VERSION;
+    header.record_size = sizeof(Allocation_Trace_Record);
+    header.tag_count = (u32)Memory_Tag::MAX_ENTRIES;
+
+    u64 written = 0;
+    if (!filesystem_write(&out_trace->file, sizeof(header), &header, &written)) {
+        ENGINE_ERROR("allocation_trace_create - Failed to write the header to '%s'", path);
+        filesystem_close(&out_trace->file);
+        return false;
+    }
+
+    Allocation_Trace_Record* records = static_cast<Allocation_Trace_Record*>(memory);
+
+    for (u32 i = 0; i < 2; ++i) {
+        out_trace->buffers[i].records = records + i * record_capacity;
+        out_trace->buffers[i].record_count = 0;
+        out_trace->buffers[i].writing.store(false, std::memory_order_relaxed);
+    }
+
+    out_trace->active_buffer = 0;
+    out_trace->record_capacity = record_capacity;
+    out_trace->start_time = platform_get_absolute_time();
+    out_trace->written_records = 0;
+
+    return true;
+}
+
+void allocation_trace_destroy(
+    Allocation_Trace* trace) {
+
+    if (!trace || !trace->file.is_valid)
+        return;
+
+    allocation_trace_flush(trace);
+    filesystem_close(&trace->file);
+
+    ENGINE_DEBUG("Allocation trace closed with %llu records", trace->written_records);
+
+    memory_zero(trace, sizeof(Allocation_Trace));
+}
+
+Allocation_Trace_Buffer* allocation_trace_record(
+    Allocation_Trace* trace,
+    Allocation_Trace_Event event,
+    const void* address,
+    u64 size,
+    Memory_Tag tag,
+    u32 thread) {
+
+    Allocation_Trace_Buffer* buffer = &trace->buffers[trace->active_buffer];
+
+    Allocation_Trace_Record* record = &buffer->records[buffer->record_count++];
+    record->timestamp = static_cast<u64>((platform_get_absolute_time() - trace->start_time) * 1000000000.0);
+    record->address = reinterpret_cast<u64>(address);
+    record->size = size;
+    record->thread = thread;
+    record->tag = static_cast<u8>(tag);
+    record->event = event;
+    record->reserved = 0;
+
+    if (buffer->record_count < trace->record_capacity)
+        return nullptr;
+
+    // The other buffer was handed out before this one filled up, so waiting
+    // for it also keeps the writes to the file in the order of the records
+    trace->active_buffer ^= 1;
+    allocation_trace_wait(&trace->buffers[trace->active_buffer]);
+
+    buffer->writing.store(true, std::memory_order_relaxed);
+
+    return buffer;
+}
+
+void allocation_trace_write(
+    Allocation_Trace* trace,
+    Allocation_Trace_Buffer* buffer) {
+
+    // At most one buffer is written at a time, see allocation_trace_record
+    u64 written = 0;
+    if (buffer->record_count &&
+        !filesystem_write(
+            &trace->file,
+            sizeof(Allocation_Trace_Record) * buffer->record_count,
+            buffer->records,
+            &written))
+        ENGINE_ERROR("allocation_trace_write - Failed to write %u records", buffer->record_count);
+
+    trace->written_records += written / sizeof(Allocation_Trace_Record);
+    buffer->record_count = 0;
+
+    buffer->writing.store(false, std::memory_order_release);
+}
+
+void allocation_trace_flush(
+    Allocation_Trace* trace) {
+
+    allocation_trace_wait(&trace->buffers[trace->active_buffer ^ 1]);
+    allocation_trace_write(trace, &trace->buffers[trace->active_buffer]);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "defines.hpp"
+#include "core/memory.hpp"
+#include "platform/filesystem.hpp"
+
+#include <atomic>
+
+// Binary trace of the allocations, meant to be analyzed offline with the
+// trace_analyzer tool instead of logging every call. The records are
+// collected in one of two caller provided buffers. When it fills up the
+// recording moves to the other buffer while the full one is written to the
+// file in one go, so the cost per allocation is a copy of 32 bytes.
+//
+// File layout: an Allocation_Trace_Header followed by the records in the order
+// they were recorded. All values are little endian.
+
+constexpr u32 ALLOCATION_TRACE_MAGIC = 0x5254414B; // "KATR"
+constexpr u32 ALLOCATION_TRACE_VERSION = 1;
+
+enum class Allocation_Trace_Event : u8 {
+    ALLOCATE,
+    FREE,
+    // Recorded by memory_end_frame, the size holds the index of the frame that
+    // ended
+    FRAME_END
+};
+
+struct Allocation_Trace_Header {
+    u32 magic;
+    u32 version;
+    u32 record_size;
+    u32 tag_count;
+};
+
+struct Allocation_Trace_Record {
+    // Nanoseconds since the trace was created
+    u64 timestamp;
+    u64 address;
+    u64 size;
+    // Small index given to every thread the first time it is traced
+    u32 thread;
+    u8 tag;
+    Allocation_Trace_Event event;
+    u16 reserved;
+};
+
+static_assert(sizeof(Allocation_Trace_Record) == 32, "Trace records are written to disk as is");
+
+struct Allocation_Trace_Buffer {
+    Allocation_Trace_Record* records;
+    u32 record_count;
+
+    // Set from the moment the buffer fills up until it is written to the file
+    // and can take records again
+    std::atomic<b8> writing;
+};
+
+struct Allocation_Trace {
+    File_Handle file;
+
+    Allocation_Trace_Buffer buffers[2];
+    u32 active_buffer;
+    u32 record_capacity;
+
+    f64 start_time;
+    u64 written_records;
+};
+
+KOALA_API u64 allocation_trace_memory_requirement(
+    u32 record_capacity);
+
+// Creates the file at path, overwriting it, and writes the header. The memory
+// must be at least allocation_trace_memory_requirement bytes, which holds the
+// two buffers of record_capacity records
+KOALA_API b8 allocation_trace_create(
+    const char* path,
+    u32 record_capacity,
+    void* memory,
+    Allocation_Trace* out_trace);
+
+// Writes the buffered records and closes the file
+KOALA_API void allocation_trace_destroy(
+    Allocation_Trace* trace);
+
+// Not thread safe, the memory system serializes the calls. Returns the buffer
+// that this record filled up, or nullptr, and the caller writes it with
+// allocation_trace_write once it released its lock. Only waits when the other
+// buffer is still being written, that is when the file cannot keep up
+KOALA_API Allocation_Trace_Buffer* allocation_trace_record(
+    Allocation_Trace* trace,
+    Allocation_Trace_Event event,
+    const void* address,
+    u64 size,
+    Memory_Tag tag,
+    u32 thread);
+
+// Writes a buffer returned by allocation_trace_record and gives it back to
+// the recording. Can run while other threads record
+KOALA_API void allocation_trace_write(
+    Allocation_Trace* trace,
+    Allocation_Trace_Buffer* buffer);
+
+// Writes the records of the buffer being filled. Not thread safe
+KOALA_API void allocation_trace_flush(
+    Allocation_Trace* trace);
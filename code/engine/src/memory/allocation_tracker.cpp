@@ -0,0 +1,314 @@
+#include "allocation_tracker.hpp"
+#include "core/logger.hpp"
+
+#include <string.h>
+
+KOALA_INLINE b8 is_power_of_two(u64 value) {
+    return value && (value & (value - 1)) == 0;
+}
+
+KOALA_INLINE b8 table_is_full(u32 count, u32 capacity) {
+    return (u64)(count + 1) * 4 > (u64)capacity * 3;
+}
+
+// Fibonacci hashing of the address. The low bits of the blocks are always 0
+// because of the alignment, so they are dropped first
+KOALA_INLINE u32 record_home_slot(const void* block, u32 capacity) {
+    u64 hash = (reinterpret_cast<u64>(block) >> 4) * 11400714819323198485ull;
+    return static_cast<u32>(hash >> 32) & (capacity - 1);
+}
+
+// The same file can be passed with a different pointer by every translation
+// unit, so the name is hashed instead of the pointer
+internal u32 site_home_slot(const char* file, u32 line, u32 capacity) {
+    u32 hash = 2166136261u; // FNV-1a
+    for (const char* c = file; *c; ++c) {
+        hash ^= static_cast<u8>(*c);
+        hash *= 16777619u;
+    }
+
+    hash ^= line;
+    hash *= 16777619u;
+
+    return hash & (capacity - 1);
+}
+
+internal b8 site_matches(const Allocation_Site* site, const char* file, u32 line) {
+    return site->line == line &&
+           (site->file == file || strcmp(site->file, file) == 0);
+}
+
+internal Allocation_Site* find_or_add_site(
+    Allocation_Tracker* tracker,
+    const char* file,
+    u32 line,
+    Memory_Tag tag) {
+
+    u32 mask = tracker->site_capacity - 1;
+    u32 slot = site_home_slot(file, line, tracker->site_capacity);
+
+    while (tracker->sites[slot].file) {
+        if (site_matches(&tracker->sites[slot], file, line))
+            return &tracker->sites[slot];
+
+        slot = (slot + 1) & mask;
+    }
+
+    if (table_is_full(tracker->site_count, tracker->site_capacity))
+        return nullptr;
+
+    Allocation_Site* site = &tracker->sites[slot];
+    site->file = file;
+    site->line = line;
+    site->tag = tag;
+    tracker->site_count++;
+
+    return site;
+}
+
+internal Allocation_Site* find_site(
+    Allocation_Tracker* tracker,
+    const char* file,
+    u32 line) {
+
+    u32 mask = tracker->site_capacity - 1;
+    u32 slot = site_home_slot(file, line, tracker->site_capacity);
+
+    while (tracker->sites[slot].file) {
+        if (site_matches(&tracker->sites[slot], file, line))
+            return &tracker->sites[slot];
+
+        slot = (slot + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+u64 allocation_tracker_memory_requirement(
+    u32 record_capacity,
+    u32 site_capacity) {
+
+    return sizeof(Allocation_Record) * record_capacity +
+           sizeof(Allocation_Site) * site_capacity;
+}
+
+b8 allocation_tracker_create(
+    u32 record_capacity,
+    u32 site_capacity,
+    void* memory,
+    Allocation_Tracker* out_tracker) {
+
+    if (!out_tracker || !memory) {
+        ENGINE_ERROR("allocation_tracker_create - requires valid pointers to memory and out_tracker");
+        return false;
+    }
+
+    if (!is_power_of_two(record_capacity) || !is_power_of_two(site_capacity)) {
+        ENGINE_ERROR("allocation_tracker_create - The capacities must be powers of two");
+        return false;
+    }
+
+    memory_zero(memory, allocation_tracker_memory_requirement(record_capacity, site_capacity));
+
+    out_tracker->record_capacity = record_capacity;
+    out_tracker->record_count = 0;
+    out_tracker->records = static_cast<Allocation_Record*>(memory);
+
+    out_tracker->site_capacity = site_capacity;
+    out_tracker->site_count = 0;
+    out_tracker->sites = reinterpret_cast<Allocation_Site*>(
+        out_tracker->records + record_capacity);
+
+    out_tracker->dropped_count = 0;
+
+    return true;
+}
+
+void allocation_tracker_destroy(
+    Allocation_Tracker* tracker) {
+
+    if (tracker)
+        memory_zero(tracker, sizeof(Allocation_Tracker));
+}
+
+void allocation_tracker_add(
+    Allocation_Tracker* tracker,
+    const void* block,
+    u64 size,
+    Memory_Tag tag,
+    const char* file,
+    u32 line,
+    u32 frame) {
+
+    if (!file)
+        file = "unknown";
+
+    Allocation_Site* site = find_or_add_site(tracker, file, line, tag);
+
+    if (!site || table_is_full(tracker->record_count, tracker->record_capacity)) {
+        if (tracker->dropped_count++ == 0)
+            ENGINE_WARN("allocation_tracker_add - Tracking table full, further allocations will not be tracked");
+        return;
+    }
+
+    site->allocation_count++;
+    site->allocated_bytes += size;
+    site->live_count++;
+    site->live_bytes += size;
+
+    u32 mask = tracker->record_capacity - 1;
+    u32 slot = record_home_slot(block, tracker->record_capacity);
+
+    while (tracker->records[slot].block)
+        slot = (slot + 1) & mask;
+
+    Allocation_Record* record = &tracker->records[slot];
+    record->block = block;
+    record->file = file;
+    record->size = size;
+    record->line = line;
+    record->frame = frame;
+    record->tag = tag;
+
+    tracker->record_count++;
+}
+
+b8 allocation_tracker_remove(
+    Allocation_Tracker* tracker,
+    const void* block,
+    Allocation_Record* out_record) {
+
+    if (!block)
+        return false;
+
+    u32 mask = tracker->record_capacity - 1;
+    u32 slot = record_home_slot(block, tracker->record_capacity);
+
+    while (tracker->records[slot].block != block) {
+        if (!tracker->records[slot].block)
+            return false;
+
+        slot = (slot + 1) & mask;
+    }
+
+    Allocation_Record* record = &tracker->records[slot];
+
+    Allocation_Site* site = find_site(tracker, record->file, record->line);
+    if (site) {
+        site->live_count--;
+        site->live_bytes -= record->size;
+    }
+
+    if (out_record)
+        *out_record = *record;
+
+    // Backward shift deletion: move back the following records of the probe
+    // sequence that would otherwise become unreachable, so no tombstones are
+    // needed
+    u32 hole = slot;
+    u32 next = slot;
+
+    while (true) {
+        next = (next + 1) & mask;
+        if (!tracker->records[next].block)
+            break;
+
+        u32 home = record_home_slot(tracker->records[next].block, tracker->record_capacity);
+
+        // The record can stay when its home slot lies cyclically in
+        // (hole, next]
+        b8 reachable = hole <= next
+                           ? (home > hole && home <= next)
+                           : (home > hole || home <= next);
+        if (reachable)
+            continue;
+
+        tracker->records[hole] = tracker->records[next];
+        hole = next;
+    }
+
+    memory_zero(&tracker->records[hole], sizeof(Allocation_Record));
+    tracker->record_count--;
+
+    return true;
+}
+
+internal u64 site_order_value(const Allocation_Site* site, Allocation_Site_Order order) {
+    switch (order) {
+    case Allocation_Site_Order::ALLOCATED_BYTES:
+        return site->allocated_bytes;
+    case Allocation_Site_Order::ALLOCATION_COUNT:
+        return site->allocation_count;
+    case Allocation_Site_Order::LIVE_BYTES:
+        return site->live_bytes;
+    }
+
+    return 0;
+}
+
+u32 allocation_tracker_get_top_sites(
+    Allocation_Tracker* tracker,
+    Allocation_Site_Order order,
+    Allocation_Site* out_sites,
+    u32 max_sites) {
+
+    u32 count = 0;
+
+    // Insertion into the sorted output, which is cheap as long as max_sites is
+    // small compared to the number of sites
+    for (u32 i = 0; i < tracker->site_capacity && max_sites; ++i) {
+        const Allocation_Site* site = &tracker->sites[i];
+        if (!site->file)
+            continue;
+
+        u64 value = site_order_value(site, order);
+
+        if (count == max_sites &&
+            value <= site_order_value(&out_sites[count - 1], order))
+            continue;
+
+        u32 position = count < max_sites ? count++ : count - 1;
+
+        while (position > 0 &&
+               site_order_value(&out_sites[position - 1], order) < value) {
+            out_sites[position] = out_sites[position - 1];
+            --position;
+        }
+
+        out_sites[position] = *site;
+    }
+
+    return count;
+}
+
+u64 allocation_tracker_report_leaks(
+    Allocation_Tracker* tracker) {
+
+    u64 leaked_blocks = 0;
+    u64 leaked_bytes = 0;
+
+    for (u32 i = 0; i < tracker->site_capacity; ++i) {
+        const Allocation_Site* site = &tracker->sites[i];
+        if (!site->file || !site->live_count)
+            continue;
+
+        ENGINE_WARN(
+            "Leak: %llu bytes in %llu blocks allocated at %s:%u (tag %u)",
+            site->live_bytes,
+            site->live_count,
+            site->file,
+            site->line,
+            (u32)site->tag);
+
+        leaked_blocks += site->live_count;
+        leaked_bytes += site->live_bytes;
+    }
+
+    if (leaked_blocks)
+        ENGINE_WARN("Leaked %llu bytes in %llu blocks", leaked_bytes, leaked_blocks);
+
+    if (tracker->dropped_count)
+        ENGINE_WARN("%llu allocations were not tracked because the tracking tables were full", tracker->dropped_count);
+
+    return leaked_blocks;
+}
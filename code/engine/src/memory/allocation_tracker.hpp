@@ -0,0 +1,99 @@
+#pragma once
+
+#include "defines.hpp"
+#include "core/memory.hpp"
+
+// Debug bookkeeping of the live allocations. Every live block has a record in
+// an open addressing table keyed by its address, and every callsite that ever
+// allocated has an entry in a second table keyed by file and line, so leaks can
+// be grouped by the code that caused them and the hottest allocation sites can
+// be ranked. Both tables have a fixed capacity and never allocate, the memory
+// is provided by the caller.
+
+struct Allocation_Record {
+    const void* block;
+    const char* file;
+    u64 size;
+    u32 line;
+    // Frame in which the block was allocated
+    u32 frame;
+    Memory_Tag tag;
+};
+
+struct Allocation_Site {
+    const char* file;
+    u32 line;
+    Memory_Tag tag;
+
+    // Since the tracker was created
+    u64 allocation_count;
+    u64 allocated_bytes;
+
+    // Blocks of the site that are still allocated
+    u64 live_count;
+    u64 live_bytes;
+};
+
+enum class Allocation_Site_Order {
+    ALLOCATED_BYTES,
+    ALLOCATION_COUNT,
+    LIVE_BYTES
+};
+
+struct Allocation_Tracker {
+    u32 record_capacity;
+    u32 record_count;
+    Allocation_Record* records;
+
+    u32 site_capacity;
+    u32 site_count;
+    Allocation_Site* sites;
+
+    // Allocations not recorded because one of the tables was full
+    u64 dropped_count;
+};
+
+// Both capacities must be powers of two. The tables are kept at most 3/4 full
+// to keep the probe sequences short
+KOALA_API u64 allocation_tracker_memory_requirement(
+    u32 record_capacity,
+    u32 site_capacity);
+
+// The memory must be at least allocation_tracker_memory_requirement bytes
+KOALA_API b8 allocation_tracker_create(
+    u32 record_capacity,
+    u32 site_capacity,
+    void* memory,
+    Allocation_Tracker* out_tracker);
+
+KOALA_API void allocation_tracker_destroy(
+    Allocation_Tracker* tracker);
+
+KOALA_API void allocation_tracker_add(
+    Allocation_Tracker* tracker,
+    const void* block,
+    u64 size,
+    Memory_Tag tag,
+    const char* file,
+    u32 line,
+    u32 frame);
+
+// Removes the record of the block and copies it to out_record when provided.
+// Returns false when the block is not tracked
+KOALA_API b8 allocation_tracker_remove(
+    Allocation_Tracker* tracker,
+    const void* block,
+    Allocation_Record* out_record);
+
+// Fills out_sites with up to max_sites sites, sorted in descending order by the
+// given criteria, and returns how many were written
+KOALA_API u32 allocation_tracker_get_top_sites(
+    Allocation_Tracker* tracker,
+    Allocation_Site_Order order,
+    Allocation_Site* out_sites,
+    u32 max_sites);
+
+// Logs every site that still has live blocks and returns the number of leaked
+// blocks
+KOALA_API u64 allocation_tracker_report_leaks(
+    Allocation_Tracker* tracker);
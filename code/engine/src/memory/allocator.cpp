@@ -0,0 +1,208 @@
+#include "allocator.hpp"
+#include "core/logger.hpp"
+#include "memory/dynamic_allocator.hpp"
+#include "memory/frame_allocator.hpp"
+#include "memory/linear_allocator.hpp"
+#include "memory/pool_allocator.hpp"
+
+// Reallocation of the allocators that cannot resize the block: a new block is
+// allocated and the contents copied. The old block is released when the
+// allocator supports it
+internal void* allocator_move_block(
+    const Allocator* allocator,
+    void* block,
+    u64 old_size,
+    u64 new_size,
+    u64 alignment,
+    Memory_Tag tag) {
+
+    void* new_block = allocator->allocate(allocator->state, new_size, alignment, tag);
+    if (!new_block)
+        return nullptr;
+
+    if (block) {
+        memory_copy(new_block, block, old_size < new_size ? old_size : new_size);
+
+        if (allocator->free)
+            allocator->free(allocator->state, block, old_size, tag);
+    }
+
+    return new_block;
+}
+
+// Engine heap
+
+internal void* heap_allocate(void* state, u64 size, u64 alignment, Memory_Tag tag) {
+    if (alignment > MEMORY_DEFAULT_ALIGNMENT)
+        return memory_allocate_aligned(size, alignment, tag);
+
+    return memory_allocate_uninitialized(size, tag);
+}
+
+internal void heap_free(void* state, void* block, u64 size, Memory_Tag tag) {
+    memory_deallocate(block, size, tag);
+}
+
+internal void* heap_reallocate(void* state, void* block, u64 old_size, u64 new_size, u64 alignment, Memory_Tag tag) {
+    // memory_reallocate only keeps the default alignment
+    if (alignment > MEMORY_DEFAULT_ALIGNMENT)
+        return allocator_move_block(allocator_get_heap(), block, old_size, new_size, alignment, tag);
+
+    return memory_reallocate(block, old_size, new_size, tag);
+}
+
+internal const Allocator heap_allocator = {nullptr, heap_allocate, heap_reallocate, heap_free};
+
+const Allocator* allocator_get_heap() {
+    return &heap_allocator;
+}
+
+// Linear allocator
+
+internal void* linear_allocate(void* state, u64 size, u64 alignment, Memory_Tag tag) {
+    return linear_allocator_allocate_aligned(static_cast<Linear_Allocator*>(state), size, alignment);
+}
+
+internal void* linear_reallocate(void* state, void* block, u64 old_size, u64 new_size, u64 alignment, Memory_Tag tag) {
+    Linear_Allocator* linear = static_cast<Linear_Allocator*>(state);
+
+    if (block && new_size <= old_size)
+        return block;
+
+    // The last block can take the space right after it
+    u8* top = static_cast<u8*>(linear->memory) + linear->allocated;
+    if (block && static_cast<u8*>(block) + old_size == top &&
+        linear->allocated + new_size - old_size <= linear->total_size) {
+        linear->allocated += new_size - old_size;
+        return block;
+    }
+
+    Allocator allocator;
+    allocator_from_linear(linear, &allocator);
+
+    return allocator_move_block(&allocator, block, old_size, new_size, alignment, tag);
+}
+
+void allocator_from_linear(
+    Linear_Allocator* linear,
+    Allocator* out_allocator) {
+
+    out_allocator->state = linear;
+    out_allocator->allocate = linear_allocate;
+    out_allocator->reallocate = linear_reallocate;
+    out_allocator->free = nullptr;
+}
+
+// Frame allocator
+
+internal void* frame_allocate(void* state, u64 size, u64 alignment, Memory_Tag tag) {
+    return frame_allocator_allocate_aligned(static_cast<Frame_Allocator*>(state), size, alignment);
+}
+
+internal void* frame_reallocate(void* state, void* block, u64 old_size, u64 new_size, u64 alignment, Memory_Tag tag) {
+    Frame_Allocator* frame = static_cast<Frame_Allocator*>(state);
+    Virtual_Arena* arena = &frame->frames[frame->current_frame];
+
+    if (block && new_size <= old_size)
+        return block;
+
+    // The last block can take the space right after it. Without padding the
+    // extension starts right at the end of the block
+    u8* top = static_cast<u8*>(arena->memory) + arena->allocated;
+    if (block && static_cast<u8*>(block) + old_size == top &&
+        arena->allocated + new_size - old_size <= arena->reserved_size &&
+        virtual_arena_allocate_aligned(arena, new_size - old_size, 1))
+        return block;
+
+    Allocator allocator;
+    allocator_from_frame(frame, &allocator);
+
+    return allocator_move_block(&allocator, block, old_size, new_size, alignment, tag);
+}
+
+void allocator_from_frame(
+    Frame_Allocator* frame,
+    Allocator* out_allocator) {
+
+    out_allocator->state = frame;
+    out_allocator->allocate = frame_allocate;
+    out_allocator->reallocate = frame_reallocate;
+    out_allocator->free = nullptr;
+}
+
+// Pool allocator
+
+internal void* pool_allocate(void* state, u64 size, u64 alignment, Memory_Tag tag) {
+    Pool_Allocator* pool = static_cast<Pool_Allocator*>(state);
+
+    if (size > pool->block_size) {
+        ENGINE_ERROR("Pool allocator interface - %llu bytes do not fit in blocks of %llu bytes", size, pool->block_size);
+        return nullptr;
+    }
+
+    void* block = pool_allocator_allocate(pool);
+
+    if (block && reinterpret_cast<u64>(block) % alignment != 0) {
+        ENGINE_ERROR("Pool allocator interface - Blocks are not aligned to %llu bytes", alignment);
+        pool_allocator_free(pool, block);
+        return nullptr;
+    }
+
+    return block;
+}
+
+internal void* pool_reallocate(void* state, void* block, u64 old_size, u64 new_size, u64 alignment, Memory_Tag tag) {
+    Pool_Allocator* pool = static_cast<Pool_Allocator*>(state);
+
+    // Every block already has the whole block size
+    if (block && new_size <= pool->block_size)
+        return block;
+
+    return pool_allocate(state, new_size, alignment, tag);
+}
+
+internal void pool_free(void* state, void* block, u64 size, Memory_Tag tag) {
+    pool_allocator_free(static_cast<Pool_Allocator*>(state), block);
+}
+
+void allocator_from_pool(
+    Pool_Allocator* pool,
+    Allocator* out_allocator) {
+
+    out_allocator->state = pool;
+    out_allocator->allocate = pool_allocate;
+    out_allocator->reallocate = pool_reallocate;
+    out_allocator->free = pool_free;
+}
+
+// Dynamic allocator
+
+internal void* dynamic_allocate(void* state, u64 size, u64 alignment, Memory_Tag tag) {
+    return dynamic_allocator_allocate_aligned(static_cast<Dynamic_Allocator*>(state), size, alignment);
+}
+
+internal void dynamic_free(void* state, void* block, u64 size, Memory_Tag tag) {
+    dynamic_allocator_free(static_cast<Dynamic_Allocator*>(state), block);
+}
+
+internal void* dynamic_reallocate(void* state, void* block, u64 old_size, u64 new_size, u64 alignment, Memory_Tag tag) {
+    Dynamic_Allocator* dynamic = static_cast<Dynamic_Allocator*>(state);
+
+    if (block && dynamic_allocator_resize(dynamic, block, new_size))
+        return block;
+
+    Allocator allocator;
+    allocator_from_dynamic(dynamic, &allocator);
+
+    return allocator_move_block(&allocator, block, old_size, new_size, alignment, tag);
+}
+
+void allocator_from_dynamic(
+    Dynamic_Allocator* dynamic,
+    Allocator* out_allocator) {
+
+    out_allocator->state = dynamic;
+    out_allocator->allocate = dynamic_allocate;
+    out_allocator->reallocate = dynamic_reallocate;
+    out_allocator->free = dynamic_free;
+}
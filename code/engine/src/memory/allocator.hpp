@@ -0,0 +1,58 @@
+#pragma once
+
+#include "defines.hpp"
+#include "core/memory.hpp"
+
+struct Dynamic_Allocator;
+struct Frame_Allocator;
+struct Linear_Allocator;
+struct Pool_Allocator;
+
+// Interface the containers allocate their memory through, so the same
+// container can live in the engine heap, in an arena or in a pool. The
+// interface only points at the allocator, which must outlive every container
+// using it.
+//
+// The tag is the one of the container. Only the engine heap accounts the
+// blocks under it, the other allocators were accounted when their own memory
+// was allocated
+struct Allocator {
+    void* state;
+
+    // Alignment is a power of two. The block is not set to 0. Returns nullptr
+    // when the allocator is out of memory
+    void* (*allocate)(void* state, u64 size, u64 alignment, Memory_Tag tag);
+
+    // Keeps the contents up to the smaller of the two sizes, the block can
+    // move. Returns nullptr and leaves the block untouched on failure
+    void* (*reallocate)(void* state, void* block, u64 old_size, u64 new_size, u64 alignment, Memory_Tag tag);
+
+    // nullptr for the allocators that release everything at once, which makes
+    // freeing a container free of any cost
+    void (*free)(void* state, void* block, u64 size, Memory_Tag tag);
+};
+
+// The engine heap through memory_allocate, the default of the containers
+KOALA_API const Allocator* allocator_get_heap();
+
+// Blocks at the top of the allocator grow in place, the others are copied
+// and their old space is only reclaimed by linear_allocator_free_all
+KOALA_API void allocator_from_linear(
+    Linear_Allocator* linear,
+    Allocator* out_allocator);
+
+// Blocks of the current frame, released when the arena of the frame is
+// reused. Grows in place like the linear allocator
+KOALA_API void allocator_from_frame(
+    Frame_Allocator* frame,
+    Allocator* out_allocator);
+
+// Every allocation takes a whole block of the pool, so requests larger than
+// the block size fail
+KOALA_API void allocator_from_pool(
+    Pool_Allocator* pool,
+    Allocator* out_allocator);
+
+KOALA_API void allocator_from_dynamic(
+    Dynamic_Allocator* dynamic,
+    Allocator* out_allocator);
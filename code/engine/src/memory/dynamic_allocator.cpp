@@ -0,0 +1,515 @@
+#include "dynamic_allocator.hpp"
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The header always precedes the payload of a block. The free list links are
+// stored in the payload of the free blocks, which is why the payload of a
+// block can never be smaller than two pointers
+struct Dynamic_Block_Header {
+    Dynamic_Block_Header* prev_physical;
+    // Payload size. The lowest bits are free since the sizes are multiples of
+    // the alignment, so the first one is used to flag free blocks
+    u64 size_and_flags;
+
+    // Only valid while the block is free
+    Dynamic_Block_Header* next_free;
+    Dynamic_Block_Header* prev_free;
+};
+
+constexpr u64 BLOCK_HEADER_SIZE = 2 * sizeof(void*);
+constexpr u64 BLOCK_MIN_PAYLOAD = 2 * sizeof(void*);
+constexpr u64 BLOCK_FREE_FLAG = 1;
+constexpr u64 BLOCK_SIZE_MASK = ~(DYNAMIC_ALLOCATOR_ALIGNMENT - 1);
+
+constexpr u64 SMALL_BLOCK_SIZE = 1 << DYNAMIC_ALLOCATOR_FL_SHIFT;
+constexpr u64 BLOCK_MAX_PAYLOAD = (1ull << DYNAMIC_ALLOCATOR_FL_MAX) - 1;
+
+STATIC_ASSERT(BLOCK_HEADER_SIZE == DYNAMIC_ALLOCATOR_ALIGNMENT, "Block header must preserve the payload alignment");
+STATIC_ASSERT(DYNAMIC_ALLOCATOR_FL_COUNT <= 64, "First level bitmap must fit in a u64");
+STATIC_ASSERT(DYNAMIC_ALLOCATOR_SL_COUNT <= 32, "Second level bitmap must fit in a u32");
+
+// Index of the least significant set bit. Value must not be 0
+KOALA_INLINE u32 bit_scan_forward(u64 value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// Index of the most significant set bit. Value must not be 0
+KOALA_INLINE u32 bit_scan_reverse(u64 value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+KOALA_INLINE u64 block_size(const Dynamic_Block_Header* block) {
+    return block->size_and_flags & BLOCK_SIZE_MASK;
+}
+
+KOALA_INLINE b8 block_is_free(const Dynamic_Block_Header* block) {
+    return block->size_and_flags & BLOCK_FREE_FLAG;
+}
+
+KOALA_INLINE void block_set_size(Dynamic_Block_Header* block, u64 size) {
+    block->size_and_flags = size | (block->size_and_flags & BLOCK_FREE_FLAG);
+}
+
+KOALA_INLINE void block_set_free(Dynamic_Block_Header* block, b8 is_free) {
+    block->size_and_flags = is_free
+                                ? block->size_and_flags | BLOCK_FREE_FLAG
+                                : block->size_and_flags & ~BLOCK_FREE_FLAG;
+}
+
+KOALA_INLINE void* block_to_payload(Dynamic_Block_Header* block) {
+    return reinterpret_cast<u8*>(block) + BLOCK_HEADER_SIZE;
+}
+
+KOALA_INLINE Dynamic_Block_Header* block_from_payload(const void* payload) {
+    return reinterpret_cast<Dynamic_Block_Header*>(
+        const_cast<u8*>(static_cast<const u8*>(payload)) - BLOCK_HEADER_SIZE);
+}
+
+KOALA_INLINE Dynamic_Block_Header* block_next_physical(Dynamic_Block_Header* block) {
+    return reinterpret_cast<Dynamic_Block_Header*>(
+        static_cast<u8*>(block_to_payload(block)) + block_size(block));
+}
+
+// Level indices of the list that stores blocks of exactly this size
+KOALA_INLINE void mapping_insert(u64 size, u32* fl, u32* sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = static_cast<u32>(size / (SMALL_BLOCK_SIZE / DYNAMIC_ALLOCATOR_SL_COUNT));
+    } else {
+        u32 msb = bit_scan_reverse(size);
+        *sl = static_cast<u32>(size >> (msb - DYNAMIC_ALLOCATOR_SL_COUNT_LOG2)) ^
+              DYNAMIC_ALLOCATOR_SL_COUNT;
+        *fl = msb - (DYNAMIC_ALLOCATOR_FL_SHIFT - 1);
+    }
+}
+
+// Level indices of the first list whose blocks are all large enough for the
+// requested size. The size is rounded up to the next list boundary so that
+// any block found there can satisfy the request without searching the list
+KOALA_INLINE void mapping_search(u64 size, u32* fl, u32* sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        u64 round = (1ull << (bit_scan_reverse(size) - DYNAMIC_ALLOCATOR_SL_COUNT_LOG2)) - 1;
+        size += round;
+    }
+
+    mapping_insert(size, fl, sl);
+}
+
+internal void insert_free_block(
+    Dynamic_Allocator* allocator,
+    Dynamic_Block_Header* block) {
+
+    u32 fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    Dynamic_Block_Header* head = allocator->free_lists[fl][sl];
+
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head)
+        head->prev_free = block;
+
+    allocator->free_lists[fl][sl] = block;
+    allocator->fl_bitmap |= 1ull << fl;
+    allocator->sl_bitmap[fl] |= 1u << sl;
+}
+
+internal void remove_free_block(
+    Dynamic_Allocator* allocator,
+    Dynamic_Block_Header* block) {
+
+    u32 fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+
+    if (block->prev_free)
+        block->prev_free->next_free = block->next_free;
+    if (block->next_free)
+        block->next_free->prev_free = block->prev_free;
+
+    if (allocator->free_lists[fl][sl] == block) {
+        allocator->free_lists[fl][sl] = block->next_free;
+
+        // The list is now empty, so clear its bits
+        if (!block->next_free) {
+            allocator->sl_bitmap[fl] &= ~(1u << sl);
+            if (!allocator->sl_bitmap[fl])
+                allocator->fl_bitmap &= ~(1ull << fl);
+        }
+    }
+}
+
+internal Dynamic_Block_Header* find_suitable_block(
+    Dynamic_Allocator* allocator,
+    u32 fl,
+    u32 sl) {
+
+    // First look for a list with large enough blocks in the same first level
+    u32 sl_map = allocator->sl_bitmap[fl] & (~0u << sl);
+
+    if (!sl_map) {
+        // Otherwise take the smallest non empty list of the upper levels
+        if (fl + 1 >= DYNAMIC_ALLOCATOR_FL_COUNT)
+            return nullptr;
+
+        u64 fl_map = allocator->fl_bitmap & (~0ull << (fl + 1));
+        if (!fl_map)
+            return nullptr;
+
+        fl = bit_scan_forward(fl_map);
+        sl_map = allocator->sl_bitmap[fl];
+    }
+
+    sl = bit_scan_forward(sl_map);
+
+    return allocator->free_lists[fl][sl];
+}
+
+// Merge the block with the next physical block, which must be free and
+// already removed from the free lists
+internal void merge_with_next(
+    Dynamic_Block_Header* block,
+    Dynamic_Block_Header* next) {
+
+    block_set_size(block, block_size(block) + BLOCK_HEADER_SIZE + block_size(next));
+    block_next_physical(block)->prev_physical = block;
+}
+
+b8 dynamic_allocator_create(
+    u64 total_size,
+    void* memory,
+    Dynamic_Allocator* out_allocator) {
+
+    if (!out_allocator) {
+        ENGINE_ERROR("dynamic_allocator_create - requires a valid pointer to out_allocator");
+        return false;
+    }
+
+    if (total_size < DYNAMIC_ALLOCATOR_MIN_SIZE) {
+        ENGINE_ERROR("dynamic_allocator_create - total_size must be at least %llu bytes", DYNAMIC_ALLOCATOR_MIN_SIZE);
+        return false;
+    }
+
+    memory_zero(out_allocator, sizeof(Dynamic_Allocator));
+
+    out_allocator->total_size = total_size;
+    out_allocator->owns_memory = memory == nullptr;
+    if (memory)
+        out_allocator->memory = memory;
+    else
+        out_allocator->memory = memory_allocate_uninitialized(
+            total_size,
+            Memory_Tag::DYNAMIC_ALLOCATOR);
+
+    // Start the first block at an aligned address, and reserve one header at
+    // the end of the memory as a sentinel. The sentinel is never free, so the
+    // coalescing stops there without any bounds check
+    u64 base = reinterpret_cast<u64>(out_allocator->memory);
+    u64 aligned_base = (base + DYNAMIC_ALLOCATOR_ALIGNMENT - 1) & BLOCK_SIZE_MASK;
+    u64 end = (base + total_size) & BLOCK_SIZE_MASK;
+
+    u64 payload = end - aligned_base - 2 * BLOCK_HEADER_SIZE;
+    if (payload > BLOCK_MAX_PAYLOAD)
+        payload = BLOCK_MAX_PAYLOAD & BLOCK_SIZE_MASK;
+
+    Dynamic_Block_Header* block = reinterpret_cast<Dynamic_Block_Header*>(aligned_base);
+    block->prev_physical = nullptr;
+    block->size_and_flags = payload | BLOCK_FREE_FLAG;
+
+    Dynamic_Block_Header* sentinel = block_next_physical(block);
+    sentinel->prev_physical = block;
+    sentinel->size_and_flags = 0;
+
+    insert_free_block(out_allocator, block);
+
+    return true;
+}
+
+void dynamic_allocator_destroy(
+    Dynamic_Allocator* allocator) {
+    if (allocator) {
+        if (allocator->owns_memory && allocator->memory) {
+            memory_deallocate(
+                allocator->memory,
+                allocator->total_size,
+                Memory_Tag::DYNAMIC_ALLOCATOR);
+        }
+
+        memory_zero(allocator, sizeof(Dynamic_Allocator));
+    }
+}
+
+void* dynamic_allocator_allocate(
+    Dynamic_Allocator* allocator,
+    u64 size) {
+    return dynamic_allocator_allocate_aligned(
+        allocator,
+        size,
+        DYNAMIC_ALLOCATOR_ALIGNMENT);
+}
+
+void* dynamic_allocator_allocate_aligned(
+    Dynamic_Allocator* allocator,
+    u64 size,
+    u64 alignment) {
+
+    if (!allocator || !allocator->memory) {
+        ENGINE_ERROR("dynamic_allocator_allocate_aligned - allocator not initialized");
+        return nullptr;
+    }
+
+    if (alignment < DYNAMIC_ALLOCATOR_ALIGNMENT)
+        alignment = DYNAMIC_ALLOCATOR_ALIGNMENT;
+
+    if (size > BLOCK_MAX_PAYLOAD - DYNAMIC_ALLOCATOR_ALIGNMENT ||
+        alignment > BLOCK_MAX_PAYLOAD - size)
+        return nullptr;
+
+    u64 adjusted = (size + DYNAMIC_ALLOCATOR_ALIGNMENT - 1) & BLOCK_SIZE_MASK;
+    if (adjusted < BLOCK_MIN_PAYLOAD)
+        adjusted = BLOCK_MIN_PAYLOAD;
+
+    // Over aligned requests need room to move the payload forward to the
+    // alignment boundary, leaving in front a gap that is either empty or large
+    // enough to become a free block of its own
+    u64 search_size = adjusted;
+    if (alignment > DYNAMIC_ALLOCATOR_ALIGNMENT)
+        search_size += alignment + BLOCK_HEADER_SIZE + BLOCK_MIN_PAYLOAD;
+
+    u32 fl, sl;
+    mapping_search(search_size, &fl, &sl);
+
+    if (fl >= DYNAMIC_ALLOCATOR_FL_COUNT)
+        return nullptr;
+
+    Dynamic_Block_Header* block = find_suitable_block(allocator, fl, sl);
+    if (!block)
+        return nullptr;
+
+    remove_free_block(allocator, block);
+
+    if (alignment > DYNAMIC_ALLOCATOR_ALIGNMENT) {
+        u64 payload = reinterpret_cast<u64>(block_to_payload(block));
+        u64 aligned = (payload + alignment - 1) & ~(alignment - 1);
+
+        if (aligned != payload && aligned - payload < BLOCK_HEADER_SIZE + BLOCK_MIN_PAYLOAD)
+            aligned = (payload + BLOCK_HEADER_SIZE + BLOCK_MIN_PAYLOAD + alignment - 1) &
+                      ~(alignment - 1);
+
+        u64 gap = aligned - payload;
+        if (gap) {
+            // The leading gap stays free as a block of its own. Its previous
+            // physical block is not free, otherwise they would be coalesced
+            u64 available = block_size(block);
+            Dynamic_Block_Header* leading = block;
+
+            block = block_from_payload(reinterpret_cast<void*>(aligned));
+            block->prev_physical = leading;
+            block->size_and_flags = available - gap;
+            block_next_physical(block)->prev_physical = block;
+
+            block_set_size(leading, gap - BLOCK_HEADER_SIZE);
+            insert_free_block(allocator, leading);
+        }
+    }
+
+    // Split the remainder in a new free block when it is large enough to
+    // hold a header and the smallest payload
+    u64 available = block_size(block);
+    if (available >= adjusted + BLOCK_HEADER_SIZE + BLOCK_MIN_PAYLOAD) {
+        block_set_size(block, adjusted);
+
+        Dynamic_Block_Header* remainder = block_next_physical(block);
+        remainder->prev_physical = block;
+        remainder->size_and_flags =
+            (available - adjusted - BLOCK_HEADER_SIZE) | BLOCK_FREE_FLAG;
+        block_next_physical(remainder)->prev_physical = remainder;
+
+        insert_free_block(allocator, remainder);
+    }
+
+    block_set_free(block, false);
+
+    allocator->allocated += block_size(block);
+    allocator->allocated_blocks++;
+
+    return block_to_payload(block);
+}
+
+void dynamic_allocator_free(
+    Dynamic_Allocator* allocator,
+    void* payload) {
+
+    if (!allocator || !allocator->memory || !payload) {
+        ENGINE_ERROR("dynamic_allocator_free - allocator not initialized or invalid block");
+        return;
+    }
+
+    if (!dynamic_allocator_owns(allocator, payload)) {
+        ENGINE_ERROR("dynamic_allocator_free - Block %p does not belong to the allocator", payload);
+        return;
+    }
+
+    Dynamic_Block_Header* block = block_from_payload(payload);
+
+    if (block_is_free(block)) {
+        ENGINE_ERROR("dynamic_allocator_free - Block %p has already been freed", payload);
+        return;
+    }
+
+    allocator->allocated -= block_size(block);
+    allocator->allocated_blocks--;
+
+    block_set_free(block, true);
+
+    // Coalesce with the physical neighbours
+    Dynamic_Block_Header* prev = block->prev_physical;
+    if (prev && block_is_free(prev)) {
+        remove_free_block(allocator, prev);
+        merge_with_next(prev, block);
+        block = prev;
+    }
+
+    Dynamic_Block_Header* next = block_next_physical(block);
+    if (block_is_free(next)) {
+        remove_free_block(allocator, next);
+        merge_with_next(block, next);
+    }
+
+    insert_free_block(allocator, block);
+}
+
+b8 dynamic_allocator_resize(
+    Dynamic_Allocator* allocator,
+    void* payload,
+    u64 new_size) {
+
+    if (!allocator || !allocator->memory || !payload) {
+        ENGINE_ERROR("dynamic_allocator_resize - allocator not initialized or invalid block");
+        return false;
+    }
+
+    if (!dynamic_allocator_owns(allocator, payload)) {
+        ENGINE_ERROR("dynamic_allocator_resize - Block %p does not belong to the allocator", payload);
+        return false;
+    }
+
+    Dynamic_Block_Header* block = block_from_payload(payload);
+
+    if (block_is_free(block)) {
+        ENGINE_ERROR("dynamic_allocator_resize - Block %p has been freed", payload);
+        return false;
+    }
+
+    if (new_size > BLOCK_MAX_PAYLOAD - DYNAMIC_ALLOCATOR_ALIGNMENT)
+        return false;
+
+    u64 adjusted = (new_size + DYNAMIC_ALLOCATOR_ALIGNMENT - 1) & BLOCK_SIZE_MASK;
+    if (adjusted < BLOCK_MIN_PAYLOAD)
+        adjusted = BLOCK_MIN_PAYLOAD;
+
+    u64 current = block_size(block);
+
+    // Growing takes over the next physical block, which only works when it is
+    // free and large enough. The sentinel is never free, so this stops there
+    if (adjusted > current) {
+        Dynamic_Block_Header* next = block_next_physical(block);
+
+        if (!block_is_free(next) || current + BLOCK_HEADER_SIZE + block_size(next) < adjusted)
+            return false;
+
+        remove_free_block(allocator, next);
+        merge_with_next(block, next);
+    }
+
+    // Give back the tail when it is large enough to be a block of its own,
+    // coalescing it with the next physical block if that one is free
+    u64 available = block_size(block);
+    if (available >= adjusted + BLOCK_HEADER_SIZE + BLOCK_MIN_PAYLOAD) {
+        block_set_size(block, adjusted);
+
+        Dynamic_Block_Header* remainder = block_next_physical(block);
+        remainder->prev_physical = block;
+        remainder->size_and_flags =
+            (available - adjusted - BLOCK_HEADER_SIZE) | BLOCK_FREE_FLAG;
+        block_next_physical(remainder)->prev_physical = remainder;
+
+        Dynamic_Block_Header* next = block_next_physical(remainder);
+        if (block_is_free(next)) {
+            remove_free_block(allocator, next);
+            merge_with_next(remainder, next);
+        }
+
+        insert_free_block(allocator, remainder);
+    }
+
+    allocator->allocated = allocator->allocated - current + block_size(block);
+
+    return true;
+}
+
+b8 dynamic_allocator_owns(
+    Dynamic_Allocator* allocator,
+    const void* block) {
+
+    u64 address = reinterpret_cast<u64>(block);
+    u64 base = reinterpret_cast<u64>(allocator->memory);
+
+    return allocator->memory &&
+           address >= base + BLOCK_HEADER_SIZE &&
+           address < base + allocator->total_size;
+}
+
+u64 dynamic_allocator_block_size(
+    const void* block) {
+    return block_size(block_from_payload(block));
+}
+
+void dynamic_allocator_get_stats(
+    Dynamic_Allocator* allocator,
+    Dynamic_Allocator_Stats* out_stats) {
+
+    memory_zero(out_stats, sizeof(Dynamic_Allocator_Stats));
+
+    if (!allocator || !allocator->memory)
+        return;
+
+    out_stats->total_size = allocator->total_size;
+    out_stats->allocated = allocator->allocated;
+    out_stats->allocated_blocks = allocator->allocated_blocks;
+
+    for (u32 fl = 0; fl < DYNAMIC_ALLOCATOR_FL_COUNT; ++fl) {
+        if (!(allocator->fl_bitmap & (1ull << fl)))
+            continue;
+
+        for (u32 sl = 0; sl < DYNAMIC_ALLOCATOR_SL_COUNT; ++sl) {
+            Dynamic_Block_Header* block = allocator->free_lists[fl][sl];
+
+            while (block) {
+                u64 size = block_size(block);
+
+                out_stats->free_space += size;
+                out_stats->free_blocks++;
+                if (size > out_stats->largest_free_block)
+                    out_stats->largest_free_block = size;
+
+                block = block->next_free;
+            }
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "defines.hpp"
+
+// General purpose allocator based on the Two-Level Segregated Fit (TLSF)
+// design. The free blocks are kept in size-segregated free lists indexed by a
+// first level (power of two range) and a second level (linear subdivision of
+// that range). Two bitmaps record which lists are non empty, so finding a
+// suitable free block is a couple of bit scans and both allocate and free run
+// in O(1). Freed blocks are immediately coalesced with their free physical
+// neighbours to keep external fragmentation low.
+//
+// Every block is preceded by a 16 byte header and the payloads are 16 byte
+// aligned, given that the backing memory is 16 byte aligned as well.
+
+constexpr u64 DYNAMIC_ALLOCATOR_ALIGNMENT_LOG2 = 4;
+constexpr u64 DYNAMIC_ALLOCATOR_ALIGNMENT = 1 << DYNAMIC_ALLOCATOR_ALIGNMENT_LOG2;
+
+constexpr u64 DYNAMIC_ALLOCATOR_SL_COUNT_LOG2 = 4;
+constexpr u64 DYNAMIC_ALLOCATOR_SL_COUNT = 1 << DYNAMIC_ALLOCATOR_SL_COUNT_LOG2;
+
+// Blocks smaller than 1 << FL_SHIFT bytes are all stored in the first level 0
+// and linearly subdivided by the second level
+constexpr u64 DYNAMIC_ALLOCATOR_FL_SHIFT =
+    DYNAMIC_ALLOCATOR_SL_COUNT_LOG2 + DYNAMIC_ALLOCATOR_ALIGNMENT_LOG2;
+
+// Supports blocks up to 1 TiB
+constexpr u64 DYNAMIC_ALLOCATOR_FL_MAX = 40;
+constexpr u64 DYNAMIC_ALLOCATOR_FL_COUNT =
+    DYNAMIC_ALLOCATOR_FL_MAX - DYNAMIC_ALLOCATOR_FL_SHIFT + 1;
+
+struct Dynamic_Block_Header; // Implementation detail, defined in the .cpp
+
+struct Dynamic_Allocator {
+    u64 total_size;
+    void* memory;
+
+    // Bytes handed out to the users, including the rounding to the alignment
+    // but excluding the block headers
+    u64 allocated;
+    u64 allocated_blocks;
+
+    u64 fl_bitmap;
+    u32 sl_bitmap[DYNAMIC_ALLOCATOR_FL_COUNT];
+    Dynamic_Block_Header* free_lists[DYNAMIC_ALLOCATOR_FL_COUNT][DYNAMIC_ALLOCATOR_SL_COUNT];
+
+    // Mark whether the memory is owned by the allocator, so that if the memory
+    // is owned by the allocator, it should be freed when the allocator is
+    // destroyed
+    b8 owns_memory;
+};
+
+struct Dynamic_Allocator_Stats {
+    u64 total_size;
+    u64 allocated;
+    u64 allocated_blocks;
+    u64 free_space;
+    u64 free_blocks;
+    u64 largest_free_block;
+};
+
+// Smallest amount of backing memory that can hold a single allocation
+constexpr u64 DYNAMIC_ALLOCATOR_MIN_SIZE = DYNAMIC_ALLOCATOR_ALIGNMENT * 4;
+
+// If memory is nullptr the allocator allocates its own backing memory. The
+// memory provided should be 16 byte aligned to guarantee aligned payloads
+KOALA_API b8 dynamic_allocator_create(
+    u64 total_size,
+    void* memory,
+    Dynamic_Allocator* out_allocator);
+
+KOALA_API void dynamic_allocator_destroy(
+    Dynamic_Allocator* allocator);
+
+// Returns nullptr when there is no free block large enough for the request
+KOALA_API void* dynamic_allocator_allocate(
+    Dynamic_Allocator* allocator,
+    u64 size);
+
+// Alignment must be a power of two. Alignments below the default one of the
+// allocator are raised to it. The block is released with dynamic_allocator_free
+KOALA_API void* dynamic_allocator_allocate_aligned(
+    Dynamic_Allocator* allocator,
+    u64 size,
+    u64 alignment);
+
+KOALA_API void dynamic_allocator_free(
+    Dynamic_Allocator* allocator,
+    void* block);
+
+// Grows or shrinks an allocated block without moving it. Growing merges the
+// block with the free block that physically follows it, so it fails and leaves
+// the block untouched when that block is missing or too small. Shrinking
+// always succeeds, the tail is given back when it can hold a block
+KOALA_API b8 dynamic_allocator_resize(
+    Dynamic_Allocator* allocator,
+    void* block,
+    u64 new_size);
+
+// Check whether a block was allocated from the memory of the allocator
+KOALA_API b8 dynamic_allocator_owns(
+    Dynamic_Allocator* allocator,
+    const void* block);
+
+// Usable size of an allocated block, which can be larger than the size that
+// was requested because of alignment and of unsplittable remainders
+KOALA_API u64 dynamic_allocator_block_size(
+    const void* block);
+
+// Walks the free lists, so should be used for reporting and not on hot paths
+KOALA_API void dynamic_allocator_get_stats(
+    Dynamic_Allocator* allocator,
+    Dynamic_Allocator_Stats* out_stats);
@@ -0,0 +1,91 @@
+#include "frame_allocator.hpp"
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+
+// Pages are committed in chunks of this size while a frame arena grows
+constexpr u64 FRAME_ALLOCATOR_COMMIT_GRANULARITY = 64 * KIB;
+
+b8 frame_allocator_create(
+    u64 frame_size,
+    u32 frame_count,
+    Frame_Allocator* out_allocator) {
+
+    if (!out_allocator) {
+        ENGINE_ERROR("frame_allocator_create - requires a valid pointer to out_allocator");
+        return false;
+    }
+
+    if (frame_count == 0 || frame_count > FRAME_ALLOCATOR_MAX_FRAMES) {
+        ENGINE_ERROR("frame_allocator_create - frame_count must be between 1 and %u", FRAME_ALLOCATOR_MAX_FRAMES);
+        return false;
+    }
+
+    memory_zero(out_allocator, sizeof(Frame_Allocator));
+
+    for (u32 i = 0; i < frame_count; ++i) {
+        if (!virtual_arena_create(
+                frame_size,
+                FRAME_ALLOCATOR_COMMIT_GRANULARITY,
+                false,
+                &out_allocator->frames[i])) {
+            frame_allocator_destroy(out_allocator);
+            return false;
+        }
+    }
+
+    out_allocator->frame_count = frame_count;
+    out_allocator->current_frame = 0;
+
+    return true;
+}
+
+void frame_allocator_destroy(
+    Frame_Allocator* allocator) {
+
+    if (allocator) {
+        for (u32 i = 0; i < FRAME_ALLOCATOR_MAX_FRAMES; ++i)
+            virtual_arena_destroy(&allocator->frames[i]);
+
+        allocator->frame_count = 0;
+        allocator->current_frame = 0;
+    }
+}
+
+void frame_allocator_begin_frame(
+    Frame_Allocator* allocator) {
+
+    if (!allocator || !allocator->frame_count) {
+        ENGINE_ERROR("frame_allocator_begin_frame - allocator not initialized");
+        return;
+    }
+
+    allocator->current_frame = (allocator->current_frame + 1) % allocator->frame_count;
+
+    // The pages stay committed, so a steady state frame does not reach the OS
+    virtual_arena_free_all(&allocator->frames[allocator->current_frame]);
+}
+
+void* frame_allocator_allocate(
+    Frame_Allocator* allocator,
+    u64 size) {
+
+    if (!allocator || !allocator->frame_count) {
+        ENGINE_ERROR("frame_allocator_allocate - allocator not initialized");
+        return nullptr;
+    }
+
+    return virtual_arena_allocate(&allocator->frames[allocator->current_frame], size);
+}
+
+void* frame_allocator_allocate_aligned(
+    Frame_Allocator* allocator,
+    u64 size,
+    u64 alignment) {
+
+    if (!allocator || !allocator->frame_count) {
+        ENGINE_ERROR("frame_allocator_allocate_aligned - allocator not initialized");
+        return nullptr;
+    }
+
+    return virtual_arena_allocate_aligned(&allocator->frames[allocator->current_frame], size, alignment);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "defines.hpp"
+#include "memory/virtual_arena.hpp"
+
+constexpr u32 FRAME_ALLOCATOR_MAX_FRAMES = 3;
+
+// Scratch memory that lives for a fixed number of frames. Every frame gets its
+// own arena and the arenas are used round robin, so a block allocated in a
+// frame stays valid until the same arena comes around again, frame_count
+// frames later. With frame_count matching the frames in flight, the data
+// handed to the GPU during a frame is not overwritten while it is still read.
+// Freeing individual blocks is not supported, everything of a frame is
+// released at once when its arena is reused
+struct Frame_Allocator {
+    u32 frame_count;
+    u32 current_frame;
+    Virtual_Arena frames[FRAME_ALLOCATOR_MAX_FRAMES];
+};
+
+// Every frame reserves frame_size bytes of address space, committed on demand
+KOALA_API b8 frame_allocator_create(
+    u64 frame_size,
+    u32 frame_count,
+    Frame_Allocator* out_allocator);
+
+KOALA_API void frame_allocator_destroy(
+    Frame_Allocator* allocator);
+
+// Moves to the arena of the next frame and resets it. Called once at the start
+// of every frame
+KOALA_API void frame_allocator_begin_frame(
+    Frame_Allocator* allocator);
+
+// Same alignment rules as linear_allocator_allocate
+KOALA_API void* frame_allocator_allocate(
+    Frame_Allocator* allocator,
+    u64 size);
+
+// Alignment must be a power of two
+KOALA_API void* frame_allocator_allocate_aligned(
+    Frame_Allocator* allocator,
+    u64 size,
+    u64 alignment);
@@ -0,0 +1,226 @@
+#include "guard_allocator.hpp"
+#include "core/asserts.hpp"
+#include "core/logger.hpp"
+#include "platform/platform.hpp"
+
+constexpr u64 GUARD_INVALID_PAGE = ~0ull;
+
+KOALA_INLINE b8 page_is_used(const Guard_Allocator* allocator, u64 page) {
+    return (allocator->page_bitmap[page / 64] >> (page % 64)) & 1;
+}
+
+internal void mark_pages(Guard_Allocator* allocator, u64 first, u64 count, b8 used) {
+    for (u64 page = first; page < first + count; ++page) {
+        u64 bit = 1ull << (page % 64);
+
+        if (used)
+            allocator->page_bitmap[page / 64] |= bit;
+        else
+            allocator->page_bitmap[page / 64] &= ~bit;
+    }
+}
+
+// Next-fit search of count free pages starting at the cursor. Runs cannot
+// wrap around the end of the range
+internal u64 find_free_pages(Guard_Allocator* allocator, u64 count) {
+    u64 page = allocator->cursor;
+    u64 run = 0;
+
+    for (u64 scanned = 0; scanned < allocator->page_count + count; ++scanned) {
+        if (page == allocator->page_count) {
+            page = 0;
+            run = 0;
+        }
+
+        // Skip words of fully used pages at once
+        if (page % 64 == 0 &&
+            allocator->page_bitmap[page / 64] == ~0ull &&
+            page + 64 <= allocator->page_count) {
+            page += 64;
+            scanned += 63;
+            run = 0;
+            continue;
+        }
+
+        if (page_is_used(allocator, page))
+            run = 0;
+        else if (++run == count)
+            return page + 1 - count;
+
+        ++page;
+    }
+
+    return GUARD_INVALID_PAGE;
+}
+
+KOALA_INLINE u64 data_page_count(const Guard_Allocator* allocator, u64 size) {
+    // Blocks of 0 bytes still get a page, so that they have a unique address
+    if (size == 0)
+        size = 1;
+
+    return (size + allocator->page_size - 1) / allocator->page_size;
+}
+
+// First page of the block including its guard page
+internal u64 block_first_page(const Guard_Allocator* allocator, void* block, u64 size) {
+    u64 offset = static_cast<u8*>(block) - allocator->memory;
+
+    if (allocator->mode == Memory_Guard_Mode::UNDERRUN)
+        return offset / allocator->page_size - 1;
+
+    // The block ends less than the alignment, and so less than a page, before
+    // the guard page
+    u64 end_page = (offset + (size ? size : 1) + allocator->page_size - 1) / allocator->page_size;
+    return end_page - data_page_count(allocator, size);
+}
+
+u64 guard_allocator_memory_requirement(
+    u64 reserved_size) {
+
+    u64 page_size = platform_get_page_size();
+    u64 page_count = (reserved_size + page_size - 1) / page_size;
+
+    return ((page_count + 63) / 64) * sizeof(u64);
+}
+
+b8 guard_allocator_create(
+    u64 reserved_size,
+    Memory_Guard_Mode mode,
+    void* memory,
+    Guard_Allocator* out_allocator) {
+
+    if (!out_allocator || !memory) {
+        ENGINE_ERROR("guard_allocator_create - requires valid pointers to memory and out_allocator");
+        return false;
+    }
+
+    if (mode == Memory_Guard_Mode::DISABLED) {
+        ENGINE_ERROR("guard_allocator_create - The guard mode must select a side");
+        return false;
+    }
+
+    u64 page_size = platform_get_page_size();
+    reserved_size = (reserved_size + page_size - 1) & ~(page_size - 1);
+
+    if (reserved_size < 2 * page_size) {
+        ENGINE_ERROR("guard_allocator_create - The range must hold at least two pages");
+        return false;
+    }
+
+    u8* range = static_cast<u8*>(platform_reserve_memory(reserved_size, false));
+    if (!range) {
+        ENGINE_ERROR("guard_allocator_create - Failed to reserve %llu bytes", reserved_size);
+        return false;
+    }
+
+    out_allocator->mode = mode;
+    out_allocator->memory = range;
+    out_allocator->reserved_size = reserved_size;
+    out_allocator->page_size = page_size;
+    out_allocator->page_count = reserved_size / page_size;
+    out_allocator->page_bitmap = static_cast<u64*>(memory);
+    out_allocator->cursor = 0;
+    out_allocator->allocated_blocks = 0;
+    out_allocator->allocated_pages = 0;
+
+    memory_zero(memory, guard_allocator_memory_requirement(reserved_size));
+
+    return true;
+}
+
+void guard_allocator_destroy(
+    Guard_Allocator* allocator) {
+
+    if (!allocator)
+        return;
+
+    if (allocator->memory)
+        platform_release_memory(allocator->memory, allocator->reserved_size);
+
+    memory_zero(allocator, sizeof(Guard_Allocator));
+}
+
+void* guard_allocator_allocate(
+    Guard_Allocator* allocator,
+    u64 size,
+    u64 alignment) {
+
+    RUNTIME_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+    if (alignment > allocator->page_size) {
+        ENGINE_ERROR("guard_allocator_allocate - Alignment of %llu bytes is larger than a page", alignment);
+        return nullptr;
+    }
+
+    u64 data_pages = data_page_count(allocator, size);
+
+    u64 first_page = find_free_pages(allocator, data_pages + 1);
+    if (first_page == GUARD_INVALID_PAGE) {
+        ENGINE_ERROR("guard_allocator_allocate - No room left for %llu bytes", size);
+        return nullptr;
+    }
+
+    u64 data_page = allocator->mode == Memory_Guard_Mode::UNDERRUN
+                        ? first_page + 1
+                        : first_page;
+
+    u8* data = allocator->memory + data_page * allocator->page_size;
+    u64 data_size = data_pages * allocator->page_size;
+
+    // The guard page is never committed, so it stays inaccessible
+    if (!platform_commit_memory(data, data_size))
+        return nullptr;
+
+    mark_pages(allocator, first_page, data_pages + 1, true);
+    allocator->cursor = first_page + data_pages + 1;
+    allocator->allocated_blocks++;
+    allocator->allocated_pages += data_pages + 1;
+
+    if (allocator->mode == Memory_Guard_Mode::UNDERRUN)
+        return data;
+
+    // Push the block against the guard page as far as the alignment allows
+    u64 block_size = size ? size : 1;
+    u64 aligned_size = (block_size + alignment - 1) & ~(alignment - 1);
+    return data + data_size - aligned_size;
+}
+
+void guard_allocator_free(
+    Guard_Allocator* allocator,
+    void* block,
+    u64 size) {
+
+    u64 first_page = block_first_page(allocator, block, size);
+    u64 data_pages = data_page_count(allocator, size);
+
+    u64 data_page = allocator->mode == Memory_Guard_Mode::UNDERRUN
+                        ? first_page + 1
+                        : first_page;
+
+    // Released pages become inaccessible, and the next-fit search reaches them
+    // again only after cycling through the rest of the range
+    platform_decommit_memory(
+        allocator->memory + data_page * allocator->page_size,
+        data_pages * allocator->page_size);
+
+    mark_pages(allocator, first_page, data_pages + 1, false);
+    allocator->allocated_blocks--;
+    allocator->allocated_pages -= data_pages + 1;
+}
+
+b8 guard_allocator_owns(
+    Guard_Allocator* allocator,
+    void* block) {
+
+    u8* address = static_cast<u8*>(block);
+
+    return address >= allocator->memory &&
+           address < allocator->memory + allocator->reserved_size;
+}
+
+u64 guard_allocator_block_size(
+    Guard_Allocator* allocator,
+    u64 size) {
+
+    return data_page_count(allocator, size) * allocator->page_size;
+}
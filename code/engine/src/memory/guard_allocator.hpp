@@ -0,0 +1,76 @@
+#pragma once
+
+#include "defines.hpp"
+#include "core/memory.hpp"
+
+// Debug allocator that gives every block its own pages, followed (OVERRUN) or
+// preceded (UNDERRUN) by an inaccessible guard page, so a read or write past
+// the block faults at the offending instruction instead of silently corrupting
+// a neighbour. Freed pages are made inaccessible as well and the pages are
+// handed out next-fit over a large reserved range, so they are reused only
+// after the whole range has been cycled through, which turns most use after
+// free bugs into faults too.
+//
+// Every block costs at least two pages of address space and one page of
+// memory, and splits the mapping of the range, so the number of live blocks is
+// bounded by the memory map limit of the OS (about 32k blocks with the default
+// vm.max_map_count of Linux). Meant for soak tests, not for regular runs.
+//
+// In OVERRUN mode the end of the block is aligned only to the requested
+// alignment, so overruns smaller than the padding up to it are not caught.
+
+struct Guard_Allocator {
+    Memory_Guard_Mode mode;
+
+    u8* memory;
+    u64 reserved_size;
+    u64 page_size;
+    u64 page_count;
+
+    // One bit per page of the range, set for the pages of the live blocks
+    // including their guard pages
+    u64* page_bitmap;
+    // Page where the search for the next block starts
+    u64 cursor;
+
+    u64 allocated_blocks;
+    u64 allocated_pages;
+};
+
+// Bytes of caller provided memory needed for the page bitmap
+KOALA_API u64 guard_allocator_memory_requirement(
+    u64 reserved_size);
+
+// Reserves reserved_size bytes of address space, rounded up to the page size.
+// The memory must be at least guard_allocator_memory_requirement bytes
+KOALA_API b8 guard_allocator_create(
+    u64 reserved_size,
+    Memory_Guard_Mode mode,
+    void* memory,
+    Guard_Allocator* out_allocator);
+
+KOALA_API void guard_allocator_destroy(
+    Guard_Allocator* allocator);
+
+// Alignment must be a power of two no larger than the page size. Returns
+// nullptr when the range has no free run of pages large enough
+KOALA_API void* guard_allocator_allocate(
+    Guard_Allocator* allocator,
+    u64 size,
+    u64 alignment);
+
+// The size must be the one passed to guard_allocator_allocate
+KOALA_API void guard_allocator_free(
+    Guard_Allocator* allocator,
+    void* block,
+    u64 size);
+
+KOALA_API b8 guard_allocator_owns(
+    Guard_Allocator* allocator,
+    void* block);
+
+// Bytes of accessible memory backing a block of the given size, which is the
+// requested size rounded up to whole pages
+KOALA_API u64 guard_allocator_block_size(
+    Guard_Allocator* allocator,
+    u64 size);
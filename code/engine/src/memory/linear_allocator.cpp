@@ -1,4 +1,5 @@
 #include "linear_allocator.hpp"
+#include "core/asserts.hpp"
 #include "core/logger.hpp"
 #include "core/memory.hpp"
 
@@ -11,9 +12,12 @@ void linear_allocator_create(
         out_allocator->total_size = total_size;
         out_allocator->allocated = 0;
         out_allocator->owns_memory = memory == nullptr;
-        if (memory)
+        if (memory) {
+            // free_all only clears the used range, which relies on the rest
+            // of the block being zeroed, and the caller memory may not be
             out_allocator->memory = memory;
-        else
+            memory_zero(memory, total_size);
+        } else
             out_allocator->memory = memory_allocate(
                 total_size,
                 Memory_Tag::LINEAR_ALLOCATOR);
@@ -40,21 +44,42 @@ void linear_allocator_destroy(
 void* linear_allocator_allocate(
     Linear_Allocator* allocator,
     u64 size) {
+
+    // Lowest set bit of the size, which is its natural alignment
+    u64 alignment = size & (~size + 1);
+    if (alignment == 0 || alignment > MEMORY_DEFAULT_ALIGNMENT)
+        alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+    return linear_allocator_allocate_aligned(allocator, size, alignment);
+}
+
+void* linear_allocator_allocate_aligned(
+    Linear_Allocator* allocator,
+    u64 size,
+    u64 alignment) {
     if (allocator && allocator->memory) {
-        if (allocator->allocated + size > allocator->total_size) {
+        RUNTIME_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+        // Align the address and not the offset, since the memory provided
+        // to the allocator is not necessarily aligned itself
+        u64 base = reinterpret_cast<u64>(allocator->memory);
+        u64 current = base + allocator->allocated;
+        u64 padding = ((current + alignment - 1) & ~(alignment - 1)) - current;
+
+        if (allocator->allocated + padding + size > allocator->total_size) {
             u64 remaining = allocator->total_size - allocator->allocated;
-            ENGINE_ERROR("linear_allocator_allocate - Tried to allocate %llu but only %llu bytes are available", size, remaining);
+            ENGINE_ERROR("linear_allocator_allocate_aligned - Tried to allocate %llu but only %llu bytes are available", size + padding, remaining);
             return nullptr;
         }
 
         void* block =
-            static_cast<u8*>(allocator->memory) + allocator->allocated;
+            static_cast<u8*>(allocator->memory) + allocator->allocated + padding;
 
-        allocator->allocated += size;
+        allocator->allocated += padding + size;
         return block;
     }
 
-    ENGINE_ERROR("linear_allocator_allocate - allocator not initialized");
+    ENGINE_ERROR("linear_allocator_allocate_aligned - allocator not initialized");
     return nullptr;
 }
 
@@ -62,8 +87,11 @@ void linear_allocator_free_all(
     Linear_Allocator* allocator) {
 
     if (allocator && allocator->memory) {
+        // The memory past the allocated offset has never been handed out since
+        // the last reset, so it is still zeroed and only the used range needs
+        // to be cleared
+        memory_zero(allocator->memory, allocator->allocated);
         allocator->allocated = 0;
-        memory_zero(allocator->memory, allocator->total_size);
         return;
     }
 
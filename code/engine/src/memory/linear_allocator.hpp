@@ -12,6 +12,8 @@ struct Linear_Allocator {
     b8 owns_memory;
 };
 
+// Memory given by the caller is zeroed here, like the one the allocator
+// allocates itself
 KOALA_API void linear_allocator_create(
     u64 total_size,
     void* memory,
@@ -20,9 +22,21 @@ KOALA_API void linear_allocator_create(
 KOALA_API void linear_allocator_destroy(
     Linear_Allocator* allocator);
 
+// The block is aligned to the largest power of two that divides size, up to
+// MEMORY_DEFAULT_ALIGNMENT. Since the size of a type is always a multiple of
+// its alignment, allocating sizeof(T) bytes always returns a block suitable
+// for T
 KOALA_API void* linear_allocator_allocate(
     Linear_Allocator* allocator,
     u64 size);
 
+// Alignment must be a power of two
+KOALA_API void* linear_allocator_allocate_aligned(
+    Linear_Allocator* allocator,
+    u64 size,
+    u64 alignment);
+
+// Only the range allocated since the last reset is set back to 0, so the cost
+// is proportional to the memory actually used and not to total_size
 KOALA_API void linear_allocator_free_all(
     Linear_Allocator* allocator);
@@ -0,0 +1,158 @@
+#include "pool_allocator.hpp"
+#include "core/logger.hpp"
+
+// Every block must be able to hold the free list pointer and keep the next
+// block at the natural alignment of the block size, up to the alignment that
+// the memory system guarantees, so that blocks of vectors and matrices can be
+// used with aligned loads
+internal u64 pool_allocator_block_stride(u64 block_size) {
+    if (block_size < sizeof(void*))
+        block_size = sizeof(void*);
+
+    u64 alignment = block_size & (~block_size + 1);
+
+    if (alignment < sizeof(void*))
+        alignment = sizeof(void*);
+
+    if (alignment > MEMORY_DEFAULT_ALIGNMENT)
+        alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+    return (block_size + alignment - 1) & ~(alignment - 1);
+}
+
+// Chain all the blocks of the pool in the free list, in address order
+internal void pool_allocator_build_free_list(Pool_Allocator* allocator) {
+    u8* base = static_cast<u8*>(allocator->memory);
+
+    for (u64 i = 0; i < allocator->block_count; ++i) {
+        void** block = reinterpret_cast<void**>(base + i * allocator->block_size);
+
+        *block = i + 1 < allocator->block_count
+                     ? base + (i + 1) * allocator->block_size
+                     : nullptr;
+    }
+
+    allocator->free_list = allocator->block_count ? base : nullptr;
+    allocator->allocated_count = 0;
+}
+
+u64 pool_allocator_memory_requirement(
+    u64 block_size,
+    u64 block_count) {
+
+    return pool_allocator_block_stride(block_size) * block_count;
+}
+
+void pool_allocator_create(
+    u64 block_size,
+    u64 block_count,
+    void* memory,
+    Memory_Tag tag,
+    Pool_Allocator* out_allocator) {
+
+    if (out_allocator) {
+        out_allocator->block_size = pool_allocator_block_stride(block_size);
+        out_allocator->block_count = block_count;
+        out_allocator->tag = tag;
+        out_allocator->owns_memory = memory == nullptr;
+        if (memory)
+            out_allocator->memory = memory;
+        else
+            out_allocator->memory = memory_allocate(
+                out_allocator->block_size * block_count,
+                tag);
+
+        pool_allocator_build_free_list(out_allocator);
+    }
+}
+
+void pool_allocator_destroy(
+    Pool_Allocator* allocator) {
+    if (allocator) {
+        if (allocator->owns_memory && allocator->memory) {
+            memory_deallocate(
+                allocator->memory,
+                allocator->block_size * allocator->block_count,
+                allocator->tag);
+        }
+
+        allocator->memory = nullptr;
+        allocator->free_list = nullptr;
+        allocator->block_size = 0;
+        allocator->block_count = 0;
+        allocator->allocated_count = 0;
+        allocator->owns_memory = false;
+    }
+}
+
+void* pool_allocator_allocate(
+    Pool_Allocator* allocator) {
+    if (allocator && allocator->memory) {
+        if (!allocator->free_list) {
+            ENGINE_ERROR("pool_allocator_allocate - All %llu blocks are in use", allocator->block_count);
+            return nullptr;
+        }
+
+        void* block = allocator->free_list;
+        allocator->free_list = *static_cast<void**>(block);
+        allocator->allocated_count++;
+
+        return block;
+    }
+
+    ENGINE_ERROR("pool_allocator_allocate - allocator not initialized");
+    return nullptr;
+}
+
+void pool_allocator_free(
+    Pool_Allocator* allocator,
+    void* block) {
+    if (allocator && allocator->memory && block) {
+        u64 base = reinterpret_cast<u64>(allocator->memory);
+        u64 address = reinterpret_cast<u64>(block);
+        u64 pool_size = allocator->block_size * allocator->block_count;
+
+        // Reject addresses that were not handed out by this pool, otherwise
+        // the free list would be corrupted silently
+        if (address < base ||
+            address >= base + pool_size ||
+            (address - base) % allocator->block_size != 0) {
+            ENGINE_ERROR("pool_allocator_free - Block %p does not belong to the pool", block);
+            return;
+        }
+
+        if (allocator->allocated_count == 0) {
+            ENGINE_ERROR("pool_allocator_free - Block %p freed while no block is allocated", block);
+            return;
+        }
+
+#ifdef DEBUG_BUILD
+        // Walking the free list is O(n), so the blocks freed twice while other
+        // blocks are still allocated are only caught in debug builds
+        for (void* free_block = allocator->free_list; free_block; free_block = *static_cast<void**>(free_block)) {
+            if (free_block == block) {
+                ENGINE_ERROR("pool_allocator_free - Block %p is already free", block);
+                return;
+            }
+        }
+#endif
+
+        *static_cast<void**>(block) = allocator->free_list;
+        allocator->free_list = block;
+        allocator->allocated_count--;
+        return;
+    }
+
+    ENGINE_ERROR("pool_allocator_free - allocator not initialized or invalid block");
+}
+
+void pool_allocator_free_all(
+    Pool_Allocator* allocator) {
+
+    if (allocator && allocator->memory) {
+        pool_allocator_build_free_list(allocator);
+        return;
+    }
+
+    ENGINE_ERROR("pool_allocator_free_all - allocator not initialized");
+}
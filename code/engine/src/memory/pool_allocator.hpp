@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/memory.hpp"
+#include "defines.hpp"
+
+// Fixed-size block allocator. The memory is split in block_count blocks of
+// block_size bytes each, and the free blocks are chained together through an
+// intrusive singly linked list that is stored inside the free blocks
+// themselves, so both allocate and free are O(1) with no extra bookkeeping
+struct Pool_Allocator {
+    u64 block_size;
+    u64 block_count;
+    u64 allocated_count;
+    void* memory;
+    // Head of the free list. Each free block stores the address of the next
+    // free block in its first bytes
+    void* free_list;
+    // Tag used to account the backing memory when owned by the allocator
+    Memory_Tag tag;
+    // Mark whether the memory is owned by the allocator, so that if the memory
+    // is owned by the allocator, it should be freed when the allocator is
+    // destroyed
+    b8 owns_memory;
+};
+
+// Returns the number of bytes needed to back a pool with the given layout. Can
+// be used to request memory for the pool before calling pool_allocator_create
+KOALA_API u64 pool_allocator_memory_requirement(
+    u64 block_size,
+    u64 block_count);
+
+// If memory is nullptr the allocator allocates its own backing memory under
+// the given tag, otherwise memory must be at least
+// pool_allocator_memory_requirement() bytes
+KOALA_API void pool_allocator_create(
+    u64 block_size,
+    u64 block_count,
+    void* memory,
+    Memory_Tag tag,
+    Pool_Allocator* out_allocator);
+
+KOALA_API void pool_allocator_destroy(
+    Pool_Allocator* allocator);
+
+KOALA_API void* pool_allocator_allocate(
+    Pool_Allocator* allocator);
+
+KOALA_API void pool_allocator_free(
+    Pool_Allocator* allocator,
+    void* block);
+
+KOALA_API void pool_allocator_free_all(
+    Pool_Allocator* allocator);
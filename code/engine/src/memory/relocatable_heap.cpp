@@ -0,0 +1,301 @@
+#include "relocatable_heap.hpp"
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+#include "platform/platform.hpp"
+
+// Precedes every block. The slot lets the compaction update the address of
+// the block it moves
+struct Relocatable_Block_Header {
+    u64 size;
+    u32 slot;
+    u32 flags;
+};
+
+struct Relocatable_Heap_Slot {
+    // Offset of the block payload in the heap memory
+    u64 offset;
+    // Odd while the slot holds a block, so the handles of a freed block stop
+    // matching. The invalid handle has the even generation 0 and never does
+    u32 generation;
+    u32 next_free;
+};
+
+constexpr u64 RELOCATABLE_HEAP_ALIGNMENT = 16;
+constexpr u64 RELOCATABLE_BLOCK_HEADER_SIZE = sizeof(Relocatable_Block_Header);
+constexpr u32 RELOCATABLE_BLOCK_FREE_FLAG = 1;
+
+// Pages are committed in chunks of this size while the heap grows
+constexpr u64 RELOCATABLE_HEAP_COMMIT_GRANULARITY = 64 * KIB;
+
+constexpr u32 RELOCATABLE_HEAP_NO_SLOT = 0xFFFFFFFF;
+constexpr u64 RELOCATABLE_HEAP_NO_HOLE = ~0ull;
+
+STATIC_ASSERT(RELOCATABLE_BLOCK_HEADER_SIZE == RELOCATABLE_HEAP_ALIGNMENT, "Block header must preserve the payload alignment");
+
+KOALA_INLINE u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+KOALA_INLINE Relocatable_Block_Header* block_at(Relocatable_Heap* heap, u64 offset) {
+    return reinterpret_cast<Relocatable_Block_Header*>(static_cast<u8*>(heap->memory) + offset);
+}
+
+internal Relocatable_Heap_Slot* get_live_slot(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle) {
+
+    if (!heap || !heap->slots || handle.index >= heap->slot_count)
+        return nullptr;
+
+    Relocatable_Heap_Slot* slot = &heap->slots[handle.index];
+    if (slot->generation != handle.generation || !(slot->generation & 1))
+        return nullptr;
+
+    return slot;
+}
+
+b8 relocatable_heap_create(
+    u64 reserved_size,
+    u32 slot_capacity,
+    Relocatable_Heap* out_heap) {
+
+    if (!out_heap) {
+        ENGINE_ERROR("relocatable_heap_create - requires a valid pointer to out_heap");
+        return false;
+    }
+
+    if (!reserved_size || !slot_capacity || slot_capacity == RELOCATABLE_HEAP_NO_SLOT) {
+        ENGINE_ERROR("relocatable_heap_create - reserved_size and slot_capacity must not be 0");
+        return false;
+    }
+
+    memory_zero(out_heap, sizeof(Relocatable_Heap));
+
+    u64 page_size = platform_get_page_size();
+
+    out_heap->reserved_size = align_up(reserved_size, page_size);
+    out_heap->memory = platform_reserve_memory(out_heap->reserved_size, false);
+
+    if (!out_heap->memory) {
+        ENGINE_ERROR("relocatable_heap_create - Failed to reserve %llu bytes", out_heap->reserved_size);
+        memory_zero(out_heap, sizeof(Relocatable_Heap));
+        return false;
+    }
+
+    out_heap->slots = static_cast<Relocatable_Heap_Slot*>(
+        memory_allocate(sizeof(Relocatable_Heap_Slot) * slot_capacity, Memory_Tag::DYNAMIC_ALLOCATOR));
+
+    if (!out_heap->slots) {
+        ENGINE_ERROR("relocatable_heap_create - Failed to allocate %u slots", slot_capacity);
+        platform_release_memory(out_heap->memory, out_heap->reserved_size);
+        memory_zero(out_heap, sizeof(Relocatable_Heap));
+        return false;
+    }
+
+    out_heap->slot_capacity = slot_capacity;
+    out_heap->first_free_slot = RELOCATABLE_HEAP_NO_SLOT;
+    out_heap->first_hole = RELOCATABLE_HEAP_NO_HOLE;
+
+    return true;
+}
+
+void relocatable_heap_destroy(
+    Relocatable_Heap* heap) {
+
+    if (heap) {
+        if (heap->memory)
+            platform_release_memory(heap->memory, heap->reserved_size);
+
+        memory_deallocate(
+            heap->slots,
+            sizeof(Relocatable_Heap_Slot) * heap->slot_capacity,
+            Memory_Tag::DYNAMIC_ALLOCATOR);
+
+        memory_zero(heap, sizeof(Relocatable_Heap));
+    }
+}
+
+Relocatable_Handle relocatable_heap_allocate(
+    Relocatable_Heap* heap,
+    u64 size) {
+
+    Relocatable_Handle handle = {};
+
+    if (!heap || !heap->memory) {
+        ENGINE_ERROR("relocatable_heap_allocate - heap not initialized");
+        return handle;
+    }
+
+    if (heap->first_free_slot == RELOCATABLE_HEAP_NO_SLOT && heap->slot_count == heap->slot_capacity) {
+        ENGINE_ERROR("relocatable_heap_allocate - All the %u slots are in use", heap->slot_capacity);
+        return handle;
+    }
+
+    if (size > heap->reserved_size)
+        return handle;
+
+    u64 total = RELOCATABLE_BLOCK_HEADER_SIZE + align_up(size ? size : 1, RELOCATABLE_HEAP_ALIGNMENT);
+
+    // Only pause for a full compaction when the freed blocks are the one
+    // thing standing in the way
+    if (heap->top + total > heap->reserved_size &&
+        heap->live_bytes + total <= heap->reserved_size) {
+        ENGINE_WARN("relocatable_heap_allocate - Heap full, compacting %llu bytes of holes at once", relocatable_heap_free_bytes(heap));
+        relocatable_heap_compact(heap, ~0ull);
+    }
+
+    if (heap->top + total > heap->reserved_size)
+        return handle;
+
+    u64 end = heap->top + total;
+    if (end > heap->committed_size) {
+        u64 new_committed = align_up(end, RELOCATABLE_HEAP_COMMIT_GRANULARITY);
+        if (new_committed > heap->reserved_size)
+            new_committed = heap->reserved_size;
+
+        if (!platform_commit_memory(
+                static_cast<u8*>(heap->memory) + heap->committed_size,
+                new_committed - heap->committed_size))
+            return handle;
+
+        heap->committed_size = new_committed;
+    }
+
+    u32 index;
+    if (heap->first_free_slot != RELOCATABLE_HEAP_NO_SLOT) {
+        index = heap->first_free_slot;
+        heap->first_free_slot = heap->slots[index].next_free;
+    } else {
+        index = heap->slot_count++;
+    }
+
+    Relocatable_Heap_Slot* slot = &heap->slots[index];
+    slot->generation++;
+    slot->offset = heap->top + RELOCATABLE_BLOCK_HEADER_SIZE;
+
+    // The range past the top holds the moved and freed blocks of before
+    Relocatable_Block_Header* header = block_at(heap, heap->top);
+    memory_zero(header, total);
+    header->size = total - RELOCATABLE_BLOCK_HEADER_SIZE;
+    header->slot = index;
+
+    heap->top = end;
+    heap->live_bytes += total;
+    heap->live_blocks++;
+
+    handle.index = index;
+    handle.generation = slot->generation;
+
+    return handle;
+}
+
+void relocatable_heap_free(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle) {
+
+    Relocatable_Heap_Slot* slot = get_live_slot(heap, handle);
+    if (!slot) {
+        ENGINE_ERROR("relocatable_heap_free - Handle %u:%u is not a live block", handle.index, handle.generation);
+        return;
+    }
+
+    u64 offset = slot->offset - RELOCATABLE_BLOCK_HEADER_SIZE;
+    Relocatable_Block_Header* header = block_at(heap, offset);
+    u64 total = RELOCATABLE_BLOCK_HEADER_SIZE + header->size;
+
+    header->flags |= RELOCATABLE_BLOCK_FREE_FLAG;
+
+    heap->live_bytes -= total;
+    heap->live_blocks--;
+
+    slot->generation++;
+    slot->next_free = heap->first_free_slot;
+    heap->first_free_slot = handle.index;
+
+    // The last block is given back right away. Any other one becomes a hole,
+    // the running compaction only visits the ones from compact_src on
+    if (offset + total == heap->top && (!heap->compacting || offset >= heap->compact_src))
+        heap->top = offset;
+    else if ((!heap->compacting || offset < heap->compact_dst) && offset < heap->first_hole)
+        heap->first_hole = offset;
+}
+
+void* relocatable_heap_resolve(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle) {
+
+    Relocatable_Heap_Slot* slot = get_live_slot(heap, handle);
+    if (!slot)
+        return nullptr;
+
+    return static_cast<u8*>(heap->memory) + slot->offset;
+}
+
+u64 relocatable_heap_block_size(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle) {
+
+    Relocatable_Heap_Slot* slot = get_live_slot(heap, handle);
+    if (!slot)
+        return 0;
+
+    return block_at(heap, slot->offset - RELOCATABLE_BLOCK_HEADER_SIZE)->size;
+}
+
+u64 relocatable_heap_compact(
+    Relocatable_Heap* heap,
+    u64 max_bytes) {
+
+    if (!heap || !heap->memory || !max_bytes)
+        return 0;
+
+    u64 moved = 0;
+
+    while (moved < max_bytes) {
+        if (!heap->compacting) {
+            if (heap->first_hole == RELOCATABLE_HEAP_NO_HOLE)
+                break;
+
+            heap->compacting = true;
+            heap->compact_dst = heap->first_hole;
+            heap->compact_src = heap->first_hole;
+            heap->first_hole = RELOCATABLE_HEAP_NO_HOLE;
+        }
+
+        // Everything past the packed blocks is free now
+        if (heap->compact_src >= heap->top) {
+            heap->top = heap->compact_dst;
+            heap->compacting = false;
+            continue;
+        }
+
+        Relocatable_Block_Header* header = block_at(heap, heap->compact_src);
+        u64 total = RELOCATABLE_BLOCK_HEADER_SIZE + header->size;
+
+        if (header->flags & RELOCATABLE_BLOCK_FREE_FLAG) {
+            heap->compact_src += total;
+            continue;
+        }
+
+        if (moved && moved + total > max_bytes)
+            break;
+
+        // The ranges overlap when the hole is smaller than the block
+        memory_move(block_at(heap, heap->compact_dst), header, total);
+        heap->slots[block_at(heap, heap->compact_dst)->slot].offset =
+            heap->compact_dst + RELOCATABLE_BLOCK_HEADER_SIZE;
+
+        heap->compact_dst += total;
+        heap->compact_src += total;
+        moved += total;
+    }
+
+    heap->moved_bytes += moved;
+
+    return moved;
+}
+
+u64 relocatable_heap_free_bytes(
+    const Relocatable_Heap* heap) {
+    return heap->top - heap->live_bytes;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "defines.hpp"
+
+// Heap of movable blocks, meant for large resources that are only reached
+// through a handle (asset blobs, streamed data etc.). The handles go through an
+// indirection table, so the blocks can be moved to close the holes left by the
+// freed ones and the heap never fragments for good.
+//
+// The blocks are packed one after the other from the start of a reserved range
+// and new ones are always appended at the end. Freed blocks stay in place as
+// holes until the compaction slides the live blocks after them down. The
+// compaction is incremental: every call moves at most the given number of
+// bytes and continues from where the previous call stopped, so it can run a
+// little every frame instead of pausing the whole heap at once.
+//
+// A pointer returned by relocatable_heap_resolve is valid until the next call
+// to relocatable_heap_compact or relocatable_heap_allocate, which can compact
+// when the heap is full. The heap is not thread safe.
+
+// Handle of a block. Both fields are 0 for the invalid handle. The generation
+// changes when the block is freed, so stale handles resolve to nullptr
+struct Relocatable_Handle {
+    u32 index;
+    u32 generation;
+};
+
+struct Relocatable_Heap_Slot; // Implementation detail, defined in the .cpp
+
+struct Relocatable_Heap {
+    void* memory;
+    u64 reserved_size;
+    u64 committed_size;
+
+    // End of the last block. The blocks, live or freed, fill [0, top)
+    u64 top;
+
+    // Block headers included
+    u64 live_bytes;
+    u64 live_blocks;
+
+    // Total bytes moved by the compaction since the creation
+    u64 moved_bytes;
+
+    Relocatable_Heap_Slot* slots;
+    u32 slot_capacity;
+    u32 slot_count;
+    u32 first_free_slot;
+
+    // While compacting, the blocks below compact_dst are packed, the range up
+    // to compact_src is free and the blocks from compact_src on are not
+    // visited yet
+    b8 compacting;
+    u64 compact_dst;
+    u64 compact_src;
+
+    // Lowest hole the running compaction will not visit, where the next one
+    // starts. U64 max when there is none
+    u64 first_hole;
+};
+
+// Reserves reserved_size bytes of address space, committed as the heap grows.
+// slot_capacity is the largest number of blocks allocated at the same time
+KOALA_API b8 relocatable_heap_create(
+    u64 reserved_size,
+    u32 slot_capacity,
+    Relocatable_Heap* out_heap);
+
+KOALA_API void relocatable_heap_destroy(
+    Relocatable_Heap* heap);
+
+// The block is set to 0 and aligned to 16 bytes. When the end of the
+// reservation is reached, the heap is compacted at once before giving up.
+// Returns the invalid handle on failure
+KOALA_API Relocatable_Handle relocatable_heap_allocate(
+    Relocatable_Heap* heap,
+    u64 size);
+
+KOALA_API void relocatable_heap_free(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle);
+
+// Current address of the block, nullptr for freed and invalid handles
+KOALA_API void* relocatable_heap_resolve(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle);
+
+// Size of the block, rounded up to the alignment. 0 for freed and invalid
+// handles
+KOALA_API u64 relocatable_heap_block_size(
+    Relocatable_Heap* heap,
+    Relocatable_Handle handle);
+
+// Moves up to max_bytes of live blocks to close the holes, a single block
+// larger than that is still moved when it is the first one of the call.
+// Returns the bytes moved, 0 once the heap is fully packed
+KOALA_API u64 relocatable_heap_compact(
+    Relocatable_Heap* heap,
+    u64 max_bytes);
+
+// Bytes of the freed blocks not reclaimed by the compaction yet
+KOALA_API u64 relocatable_heap_free_bytes(
+    const Relocatable_Heap* heap);
@@ -0,0 +1,248 @@
+#include "stack_allocator.hpp"
+#include "core/asserts.hpp"
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+
+// Lowest set bit of the size, which is its natural alignment, capped at
+// MEMORY_DEFAULT_ALIGNMENT
+internal u64 stack_allocator_natural_alignment(u64 size) {
+    u64 alignment = size & (~size + 1);
+    if (alignment == 0 || alignment > MEMORY_DEFAULT_ALIGNMENT)
+        alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+    return alignment;
+}
+
+void stack_allocator_create(
+    u64 total_size,
+    void* memory,
+    Stack_Allocator* out_allocator) {
+
+    if (out_allocator) {
+        out_allocator->total_size = total_size;
+        out_allocator->allocated = 0;
+        out_allocator->owns_memory = memory == nullptr;
+        if (memory)
+            out_allocator->memory = memory;
+        else
+            out_allocator->memory = memory_allocate(
+                total_size,
+                Memory_Tag::STACK_ALLOCATOR);
+    }
+}
+
+void stack_allocator_destroy(
+    Stack_Allocator* allocator) {
+    if (allocator) {
+        allocator->allocated = 0;
+        if (allocator->owns_memory && allocator->memory) {
+            memory_deallocate(
+                allocator->memory,
+                allocator->total_size,
+                Memory_Tag::STACK_ALLOCATOR);
+        }
+
+        allocator->memory = nullptr;
+        allocator->total_size = 0;
+        allocator->owns_memory = false;
+    }
+}
+
+void* stack_allocator_allocate(
+    Stack_Allocator* allocator,
+    u64 size) {
+    return stack_allocator_allocate_aligned(
+        allocator,
+        size,
+        stack_allocator_natural_alignment(size));
+}
+
+void* stack_allocator_allocate_aligned(
+    Stack_Allocator* allocator,
+    u64 size,
+    u64 alignment) {
+    if (allocator && allocator->memory) {
+        RUNTIME_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+        // The padding is part of the allocation, so rolling back to a marker
+        // taken before it releases the padding too
+        u64 current = reinterpret_cast<u64>(allocator->memory) + allocator->allocated;
+        u64 padding = ((current + alignment - 1) & ~(alignment - 1)) - current;
+
+        if (allocator->allocated + padding + size > allocator->total_size) {
+            u64 remaining = allocator->total_size - allocator->allocated;
+            ENGINE_ERROR("stack_allocator_allocate_aligned - Tried to allocate %llu but only %llu bytes are available", size + padding, remaining);
+            return nullptr;
+        }
+
+        void* block =
+            static_cast<u8*>(allocator->memory) + allocator->allocated + padding;
+
+        allocator->allocated += padding + size;
+        return block;
+    }
+
+    ENGINE_ERROR("stack_allocator_allocate_aligned - allocator not initialized");
+    return nullptr;
+}
+
+Stack_Allocator_Marker stack_allocator_get_marker(
+    Stack_Allocator* allocator) {
+    if (allocator)
+        return allocator->allocated;
+
+    return 0;
+}
+
+void stack_allocator_free_to_marker(
+    Stack_Allocator* allocator,
+    Stack_Allocator_Marker marker) {
+    if (allocator && allocator->memory) {
+        // A marker above the current top belongs to memory that has already
+        // been released, so rolling back to it would resurrect freed blocks
+        if (marker > allocator->allocated) {
+            ENGINE_ERROR("stack_allocator_free_to_marker - Marker %llu is above the top of the stack (%llu)", marker, allocator->allocated);
+            return;
+        }
+
+        allocator->allocated = marker;
+        return;
+    }
+
+    ENGINE_ERROR("stack_allocator_free_to_marker - allocator not initialized");
+}
+
+void stack_allocator_free_all(
+    Stack_Allocator* allocator) {
+    stack_allocator_free_to_marker(allocator, 0);
+}
+
+void double_stack_allocator_create(
+    u64 total_size,
+    void* memory,
+    Double_Stack_Allocator* out_allocator) {
+
+    if (out_allocator) {
+        out_allocator->total_size = total_size;
+        out_allocator->lower_allocated = 0;
+        out_allocator->upper_allocated = 0;
+        out_allocator->owns_memory = memory == nullptr;
+        if (memory)
+            out_allocator->memory = memory;
+        else
+            out_allocator->memory = memory_allocate(
+                total_size,
+                Memory_Tag::STACK_ALLOCATOR);
+    }
+}
+
+void double_stack_allocator_destroy(
+    Double_Stack_Allocator* allocator) {
+    if (allocator) {
+        allocator->lower_allocated = 0;
+        allocator->upper_allocated = 0;
+        if (allocator->owns_memory && allocator->memory) {
+            memory_deallocate(
+                allocator->memory,
+                allocator->total_size,
+                Memory_Tag::STACK_ALLOCATOR);
+        }
+
+        allocator->memory = nullptr;
+        allocator->total_size = 0;
+        allocator->owns_memory = false;
+    }
+}
+
+void* double_stack_allocator_allocate(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side,
+    u64 size) {
+    return double_stack_allocator_allocate_aligned(
+        allocator,
+        side,
+        size,
+        stack_allocator_natural_alignment(size));
+}
+
+void* double_stack_allocator_allocate_aligned(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side,
+    u64 size,
+    u64 alignment) {
+    if (allocator && allocator->memory) {
+        RUNTIME_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+        u64 remaining = allocator->total_size -
+                        allocator->lower_allocated -
+                        allocator->upper_allocated;
+
+        u64 base = reinterpret_cast<u64>(allocator->memory);
+        u64 padding;
+
+        if (side == Stack_Side::LOWER) {
+            u64 current = base + allocator->lower_allocated;
+            padding = ((current + alignment - 1) & ~(alignment - 1)) - current;
+        } else {
+            // The upper stack grows downwards, so the block starts below the
+            // current top of the upper side, rounded down to the alignment
+            u64 current = base + allocator->total_size - allocator->upper_allocated;
+            padding = (current - size) & (alignment - 1);
+        }
+
+        if (size > remaining || padding > remaining - size) {
+            ENGINE_ERROR("double_stack_allocator_allocate_aligned - Tried to allocate %llu but only %llu bytes are available", size + padding, remaining);
+            return nullptr;
+        }
+
+        if (side == Stack_Side::LOWER) {
+            void* block = reinterpret_cast<u8*>(base) + allocator->lower_allocated + padding;
+            allocator->lower_allocated += padding + size;
+            return block;
+        }
+
+        allocator->upper_allocated += size + padding;
+        return reinterpret_cast<u8*>(base) + allocator->total_size - allocator->upper_allocated;
+    }
+
+    ENGINE_ERROR("double_stack_allocator_allocate_aligned - allocator not initialized");
+    return nullptr;
+}
+
+Stack_Allocator_Marker double_stack_allocator_get_marker(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side) {
+    if (allocator)
+        return side == Stack_Side::LOWER
+                   ? allocator->lower_allocated
+                   : allocator->upper_allocated;
+
+    return 0;
+}
+
+void double_stack_allocator_free_to_marker(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side,
+    Stack_Allocator_Marker marker) {
+    if (allocator && allocator->memory) {
+        u64* allocated = side == Stack_Side::LOWER
+                             ? &allocator->lower_allocated
+                             : &allocator->upper_allocated;
+
+        if (marker > *allocated) {
+            ENGINE_ERROR("double_stack_allocator_free_to_marker - Marker %llu is above the top of the stack (%llu)", marker, *allocated);
+            return;
+        }
+
+        *allocated = marker;
+        return;
+    }
+
+    ENGINE_ERROR("double_stack_allocator_free_to_marker - allocator not initialized");
+}
+
+void double_stack_allocator_free_all(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side) {
+    double_stack_allocator_free_to_marker(allocator, side, 0);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "defines.hpp"
+
+// A marker stores the top of the stack at the time it was retrieved. Rolling
+// back to a marker frees every allocation performed after the marker was taken
+typedef u64 Stack_Allocator_Marker;
+
+// Like the linear allocator, but allocations can be released in LIFO order by
+// rolling the top of the stack back to a previously retrieved marker
+struct Stack_Allocator {
+    u64 total_size;
+    u64 allocated;
+    void* memory;
+    // Mark whether the memory is owned by the allocator, so that if the memory
+    // is owned by the allocator, it should be freed when the allocator is
+    // destroyed
+    b8 owns_memory;
+};
+
+enum class Stack_Side {
+    LOWER,
+    UPPER
+};
+
+// Two stacks sharing the same block of memory. The lower stack grows from the
+// beginning of the block upwards and the upper stack from the end of the block
+// downwards, so the two sides can be used for data with different life-cycles
+// (i.e. persistent data at one end and transient scratch at the other) while
+// sharing the same free space in the middle
+struct Double_Stack_Allocator {
+    u64 total_size;
+    u64 lower_allocated;
+    u64 upper_allocated;
+    void* memory;
+    b8 owns_memory;
+};
+
+KOALA_API void stack_allocator_create(
+    u64 total_size,
+    void* memory,
+    Stack_Allocator* out_allocator);
+
+KOALA_API void stack_allocator_destroy(
+    Stack_Allocator* allocator);
+
+// Aligned like linear_allocator_allocate, to the natural alignment of the
+// size up to MEMORY_DEFAULT_ALIGNMENT
+KOALA_API void* stack_allocator_allocate(
+    Stack_Allocator* allocator,
+    u64 size);
+
+// Alignment must be a power of two
+KOALA_API void* stack_allocator_allocate_aligned(
+    Stack_Allocator* allocator,
+    u64 size,
+    u64 alignment);
+
+KOALA_API Stack_Allocator_Marker stack_allocator_get_marker(
+    Stack_Allocator* allocator);
+
+KOALA_API void stack_allocator_free_to_marker(
+    Stack_Allocator* allocator,
+    Stack_Allocator_Marker marker);
+
+KOALA_API void stack_allocator_free_all(
+    Stack_Allocator* allocator);
+
+KOALA_API void double_stack_allocator_create(
+    u64 total_size,
+    void* memory,
+    Double_Stack_Allocator* out_allocator);
+
+KOALA_API void double_stack_allocator_destroy(
+    Double_Stack_Allocator* allocator);
+
+// Aligned like stack_allocator_allocate on both sides. The upper side rounds
+// the start of the block down, so the padding sits above the block
+KOALA_API void* double_stack_allocator_allocate(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side,
+    u64 size);
+
+KOALA_API void* double_stack_allocator_allocate_aligned(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side,
+    u64 size,
+    u64 alignment);
+
+KOALA_API Stack_Allocator_Marker double_stack_allocator_get_marker(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side);
+
+KOALA_API void double_stack_allocator_free_to_marker(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side,
+    Stack_Allocator_Marker marker);
+
+KOALA_API void double_stack_allocator_free_all(
+    Double_Stack_Allocator* allocator,
+    Stack_Side side);
@@ -0,0 +1,172 @@
+#include "virtual_arena.hpp"
+#include "core/asserts.hpp"
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+#include "platform/platform.hpp"
+
+KOALA_INLINE u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+b8 virtual_arena_create(
+    u64 reserved_size,
+    u64 commit_granularity,
+    b8 huge_pages,
+    Virtual_Arena* out_arena) {
+
+    if (!out_arena) {
+        ENGINE_ERROR("virtual_arena_create - requires a valid pointer to out_arena");
+        return false;
+    }
+
+    u64 page_size = platform_get_page_size();
+
+    // Committing whole huge pages at a time lets the OS back every commit with
+    // huge pages instead of splitting them into regular ones
+    if (huge_pages && platform_get_huge_page_size())
+        page_size = platform_get_huge_page_size();
+    else
+        huge_pages = false;
+
+    out_arena->reserved_size = align_up(reserved_size, page_size);
+    out_arena->commit_granularity = align_up(
+        commit_granularity ? commit_granularity : page_size,
+        page_size);
+    out_arena->committed_size = 0;
+    out_arena->allocated = 0;
+    out_arena->huge_pages = huge_pages;
+    out_arena->memory = platform_reserve_memory(out_arena->reserved_size, huge_pages);
+
+    if (!out_arena->memory) {
+        out_arena->reserved_size = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void virtual_arena_destroy(
+    Virtual_Arena* arena) {
+    if (arena) {
+        if (arena->memory)
+            platform_release_memory(arena->memory, arena->reserved_size);
+
+        arena->memory = nullptr;
+        arena->reserved_size = 0;
+        arena->committed_size = 0;
+        arena->allocated = 0;
+        arena->huge_pages = false;
+    }
+}
+
+void* virtual_arena_allocate(
+    Virtual_Arena* arena,
+    u64 size) {
+
+    // Lowest set bit of the size, which is its natural alignment
+    u64 alignment = size & (~size + 1);
+    if (alignment == 0 || alignment > MEMORY_DEFAULT_ALIGNMENT)
+        alignment = MEMORY_DEFAULT_ALIGNMENT;
+
+    return virtual_arena_allocate_aligned(arena, size, alignment);
+}
+
+void* virtual_arena_allocate_aligned(
+    Virtual_Arena* arena,
+    u64 size,
+    u64 alignment) {
+
+    if (!arena || !arena->memory) {
+        ENGINE_ERROR("virtual_arena_allocate_aligned - arena not initialized");
+        return nullptr;
+    }
+
+    RUNTIME_ASSERT_MSG((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+    // The reservation is page aligned so aligning the offset is enough
+    u64 offset = align_up(arena->allocated, alignment);
+
+    if (offset + size > arena->reserved_size) {
+        u64 remaining = arena->reserved_size - arena->allocated;
+        ENGINE_ERROR("virtual_arena_allocate_aligned - Tried to allocate %llu but only %llu bytes are reserved", size, remaining);
+        return nullptr;
+    }
+
+    u64 end = offset + size;
+
+    if (end > arena->committed_size) {
+        u64 new_committed = align_up(end, arena->commit_granularity);
+        if (new_committed > arena->reserved_size)
+            new_committed = arena->reserved_size;
+
+        if (!platform_commit_memory(
+                static_cast<u8*>(arena->memory) + arena->committed_size,
+                new_committed - arena->committed_size)) {
+            return nullptr;
+        }
+
+        arena->committed_size = new_committed;
+    }
+
+    arena->allocated = end;
+
+    return static_cast<u8*>(arena->memory) + offset;
+}
+
+u64 virtual_arena_get_marker(
+    Virtual_Arena* arena) {
+
+    return arena ? arena->allocated : 0;
+}
+
+void virtual_arena_free_to_marker(
+    Virtual_Arena* arena,
+    u64 marker) {
+
+    if (!arena || !arena->memory) {
+        ENGINE_ERROR("virtual_arena_free_to_marker - arena not initialized");
+        return;
+    }
+
+    if (marker > arena->allocated) {
+        ENGINE_ERROR("virtual_arena_free_to_marker - Marker %llu is past the allocated range of %llu bytes", marker, arena->allocated);
+        return;
+    }
+
+    // Keeps the bytes past the allocation offset zeroed, like free_all
+    memory_zero(static_cast<u8*>(arena->memory) + marker, arena->allocated - marker);
+    arena->allocated = marker;
+}
+
+void virtual_arena_free_all(
+    Virtual_Arena* arena) {
+
+    if (arena && arena->memory) {
+        // Like the linear allocator, only the used range needs to be zeroed
+        // since the pages past it are still zero filled
+        memory_zero(arena->memory, arena->allocated);
+        arena->allocated = 0;
+        return;
+    }
+
+    ENGINE_ERROR("virtual_arena_free_all - arena not initialized");
+}
+
+void virtual_arena_decommit_unused(
+    Virtual_Arena* arena) {
+
+    if (arena && arena->memory) {
+        u64 keep = align_up(arena->allocated, arena->commit_granularity);
+
+        if (keep < arena->committed_size) {
+            platform_decommit_memory(
+                static_cast<u8*>(arena->memory) + keep,
+                arena->committed_size - keep);
+
+            arena->committed_size = keep;
+        }
+        return;
+    }
+
+    ENGINE_ERROR("virtual_arena_decommit_unused - arena not initialized");
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "defines.hpp"
+
+// Linear allocator backed by virtual memory. The arena reserves a large range
+// of the address space upfront and commits pages only when the allocations
+// reach them, so it can grow up to the reserved size without ever moving the
+// blocks already handed out, while only the used pages cost physical memory
+struct Virtual_Arena {
+    u64 reserved_size;
+    u64 committed_size;
+    u64 allocated;
+    // Pages are committed in chunks of this size to limit the number of
+    // system calls while the arena grows
+    u64 commit_granularity;
+    void* memory;
+    // Whether the reservation was requested with huge pages, see
+    // platform_reserve_memory
+    b8 huge_pages;
+};
+
+// The reserved size is rounded up to the page size. A commit_granularity of 0
+// commits a single page at a time. With huge_pages both are rounded up to the
+// huge page size instead, which suits large arenas that are traversed often
+KOALA_API b8 virtual_arena_create(
+    u64 reserved_size,
+    u64 commit_granularity,
+    b8 huge_pages,
+    Virtual_Arena* out_arena);
+
+KOALA_API void virtual_arena_destroy(
+    Virtual_Arena* arena);
+
+// Same alignment rules as linear_allocator_allocate
+KOALA_API void* virtual_arena_allocate(
+    Virtual_Arena* arena,
+    u64 size);
+
+// Alignment must be a power of two
+KOALA_API void* virtual_arena_allocate_aligned(
+    Virtual_Arena* arena,
+    u64 size,
+    u64 alignment);
+
+// Offset of the next allocation, to release everything allocated after it with
+// virtual_arena_free_to_marker
+KOALA_API u64 virtual_arena_get_marker(
+    Virtual_Arena* arena);
+
+// Clears the range allocated since the marker was taken
+KOALA_API void virtual_arena_free_to_marker(
+    Virtual_Arena* arena,
+    u64 marker);
+
+// Clears the used range and keeps the pages committed for the next use
+KOALA_API void virtual_arena_free_all(
+    Virtual_Arena* arena);
+
+// Returns the committed pages past the current allocation offset to the OS
+KOALA_API void virtual_arena_decommit_unused(
+    Virtual_Arena* arena);
@@ -76,7 +76,7 @@ b8 filesystem_read_line(
             u64 length = strlen(buffer);
 
             *line_buf = static_cast<char*>(
-                memory_allocate(
+                memory_allocate_uninitialized(
                     (sizeof(char) * length) + 1,
                     Memory_Tag::STRING));
 
@@ -159,7 +159,7 @@ b8 filesystem_read_all_bytes(
         rewind(static_cast<FILE*>(handle->handle));
 
         *out_bytes = static_cast<u8*>(
-            memory_allocate(
+            memory_allocate_uninitialized(
                 size,
                 Memory_Tag::STRING));
 
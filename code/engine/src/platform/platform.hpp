@@ -14,9 +14,44 @@ void platform_shutdown(void* state);
 
 b8 platform_message_pump();
 
-void* platform_allocate(u64 size, b8 aligned);
+// Alignment must be 0 for the default alignment of the platform allocator, or
+// a power of two. The block must be freed passing the same alignment
+KOALA_API void* platform_allocate(u64 size, u64 alignment);
 
-void platform_free(void* block, b8 aligned);
+KOALA_API void platform_free(void* block, u64 alignment);
+
+// Resizes a block from platform_allocate, keeping its contents up to the
+// smaller of the two sizes. The block can move, the old pointer is invalid
+// after a successful call and still valid when nullptr is returned
+void* platform_reallocate(void* block, u64 old_size, u64 new_size, u64 alignment);
+
+// Virtual memory. Reserving only claims a range of the address space, which
+// does not cost any physical memory until pages of it are committed. All the
+// addresses and sizes passed to commit and decommit must be multiples of the
+// page size. Committed pages are zero filled by the OS
+KOALA_API u64 platform_get_page_size();
+
+// Size of a huge page (2 MiB on x86-64), which maps the same memory with far
+// fewer TLB entries than regular pages. Returns 0 when huge pages are not
+// supported by the platform
+KOALA_API u64 platform_get_huge_page_size();
+
+// With huge_pages set the size must be a multiple of the huge page size. The
+// platform first tries to back the range with explicit huge pages and, when
+// none are available, falls back to regular pages marked as transparent huge
+// page candidates, so the flag is a hint and never makes the reservation fail
+void* platform_reserve_memory(u64 size, b8 huge_pages);
+
+b8 platform_commit_memory(void* address, u64 size);
+
+// Returns the physical pages to the OS while keeping the range reserved
+void platform_decommit_memory(void* address, u64 size);
+
+void platform_release_memory(void* address, u64 size);
+
+// Bytes of the process memory currently backed by huge pages, either explicit
+// or transparent ones
+u64 platform_get_huge_page_usage();
 
 void* platform_zero_memory(void* block, u64 size);
 
@@ -2,9 +2,12 @@
 
 #if ENGINE_PLATFORM_LINUX
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_icccm.h>
 #include <xcb/xcb_keysyms.h>
@@ -143,7 +146,7 @@ b8 platform_startup(u64* mem_req,
 }
 
 // Vulkan platform specific definitions
-void platform_get_required_extensions(Auto_Array<const char*>* required_extensions) {
+void platform_get_required_extensions(Vulkan_Extension_Array* required_extensions) {
     ENGINE_INFO("Attaching XCB surface for LINUX platform");
     required_extensions->add("VK_KHR_xcb_surface");
 }
@@ -304,14 +307,176 @@ void platform_shutdown(void* state) {
     ENGINE_DEBUG("Platform layer shutting down...");
 }
 
-void* platform_allocate(u64 size, b8 aligned) {
-    return malloc(size);
+void* platform_allocate(u64 size, u64 alignment) {
+    // malloc already guarantees the alignment of max_align_t
+    if (alignment <= alignof(max_align_t))
+        return malloc(size);
+
+    // aligned_alloc requires the size to be a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
 }
 
-void platform_free(void* block, b8 aligned) {
+void platform_free(void* block, u64 alignment) {
+    // Blocks from aligned_alloc are released with free as well
     free(block);
 }
 
+void* platform_reallocate(void* block, u64 old_size, u64 new_size, u64 alignment) {
+    // glibc serves large blocks with their own mapping and grows them with
+    // mremap, so the pages are moved in the page tables instead of copied
+    if (alignment <= alignof(max_align_t))
+        return realloc(block, new_size);
+
+    // realloc does not preserve alignments above the default one
+    void* new_block = platform_allocate(new_size, alignment);
+    if (!new_block)
+        return nullptr;
+
+    memcpy(new_block, block, old_size < new_size ? old_size : new_size);
+    free(block);
+
+    return new_block;
+}
+
+u64 platform_get_page_size() {
+    return static_cast<u64>(sysconf(_SC_PAGESIZE));
+}
+
+u64 platform_get_huge_page_size() {
+    local_persist u64 huge_page_size = 0;
+
+    if (!huge_page_size) {
+        // Default huge page size of the kernel, 2 MiB on x86-64
+        huge_page_size = 2 * MIB;
+
+        FILE* meminfo = fopen("/proc/meminfo", "r");
+        if (meminfo) {
+            char line[128];
+            u64 kib = 0;
+            while (fgets(line, sizeof(line), meminfo)) {
+                if (sscanf(line, "Hugepagesize: %llu kB", &kib) == 1) {
+                    huge_page_size = kib * KIB;
+                    break;
+                }
+            }
+            fclose(meminfo);
+        }
+    }
+
+    return huge_page_size;
+}
+
+void* platform_reserve_memory(u64 size, b8 huge_pages) {
+    if (huge_pages) {
+        // Explicit huge pages come from the pool configured in
+        // /proc/sys/vm/nr_hugepages. Without MAP_NORESERVE the kernel reserves
+        // the whole range from the pool upfront, so the mapping fails right
+        // away instead of faulting later when the pool is too small
+        void* address = mmap(
+            nullptr,
+            size,
+            PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+            -1,
+            0);
+
+        if (address != MAP_FAILED)
+            return address;
+
+        // Transparent huge pages can only back ranges aligned to the huge page
+        // size, so over-reserve and trim the unaligned head and tail
+        u64 huge_page_size = platform_get_huge_page_size();
+        u8* mapping = static_cast<u8*>(mmap(
+            nullptr,
+            size + huge_page_size,
+            PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+            -1,
+            0));
+
+        if (mapping == MAP_FAILED) {
+            ENGINE_ERROR("platform_reserve_memory - Failed to reserve %llu bytes", size);
+            return nullptr;
+        }
+
+        u8* aligned = reinterpret_cast<u8*>(
+            (reinterpret_cast<u64>(mapping) + huge_page_size - 1) & ~(huge_page_size - 1));
+
+        u64 head = aligned - mapping;
+        if (head)
+            munmap(mapping, head);
+
+        u64 tail = huge_page_size - head;
+        if (tail)
+            munmap(aligned + size, tail);
+
+        // The advice is kept by the mapping when parts of it are committed
+        // later with mprotect. It is only a hint and does not fail when THP is
+        // disabled system wide
+        madvise(aligned, size, MADV_HUGEPAGE);
+
+        return aligned;
+    }
+
+    // MAP_NORESERVE avoids accounting the whole range against the overcommit
+    // limits, since only the committed pages will ever be touched
+    void* address = mmap(
+        nullptr,
+        size,
+        PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+        -1,
+        0);
+
+    if (address == MAP_FAILED) {
+        ENGINE_ERROR("platform_reserve_memory - Failed to reserve %llu bytes", size);
+        return nullptr;
+    }
+
+    return address;
+}
+
+b8 platform_commit_memory(void* address, u64 size) {
+    if (mprotect(address, size, PROT_READ | PROT_WRITE) != 0) {
+        ENGINE_ERROR("platform_commit_memory - Failed to commit %llu bytes at %p", size, address);
+        return false;
+    }
+
+    return true;
+}
+
+void platform_decommit_memory(void* address, u64 size) {
+    // MADV_DONTNEED drops the pages, and the next commit will get zero filled
+    // pages again
+    madvise(address, size, MADV_DONTNEED);
+    mprotect(address, size, PROT_NONE);
+}
+
+void platform_release_memory(void* address, u64 size) {
+    munmap(address, size);
+}
+
+u64 platform_get_huge_page_usage() {
+    // smaps_rollup sums the mappings of the process, AnonHugePages counts the
+    // transparent huge pages and the Hugetlb fields the explicit ones
+    FILE* smaps = fopen("/proc/self/smaps_rollup", "r");
+    if (!smaps)
+        return 0;
+
+    u64 total_kib = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), smaps)) {
+        u64 kib = 0;
+        if (sscanf(line, "AnonHugePages: %llu kB", &kib) == 1 ||
+            sscanf(line, "Shared_Hugetlb: %llu kB", &kib) == 1 ||
+            sscanf(line, "Private_Hugetlb: %llu kB", &kib) == 1)
+            total_kib += kib;
+    }
+    fclose(smaps);
+
+    return total_kib * KIB;
+}
+
 void* platform_zero_memory(void* block, u64 size) {
     return memset(block, 0, size);
 }
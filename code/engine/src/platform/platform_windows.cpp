@@ -9,6 +9,7 @@
 
 #include <windows.h>
 #include <windowsx.h>  // param input extraction
+#include <psapi.h>     // QueryWorkingSetEx
 #include <stdlib.h>
 
 #include "containers/auto_array.hpp"
@@ -147,12 +148,97 @@ b8 platform_message_pump() {
     return true;
 }
 
-void *platform_allocate(u64 size, b8 aligned) {
-    return malloc(size);
+void *platform_allocate(u64 size, u64 alignment) {
+    if (alignment == 0)
+        return malloc(size);
+
+    return _aligned_malloc(size, alignment);
+}
+
+void platform_free(void *block, u64 alignment) {
+    // Blocks from _aligned_malloc cannot be released with free
+    if (alignment == 0)
+        free(block);
+    else
+        _aligned_free(block);
+}
+
+void *platform_reallocate(void *block, u64 old_size, u64 new_size, u64 alignment) {
+    if (alignment == 0)
+        return realloc(block, new_size);
+
+    return _aligned_realloc(block, new_size, alignment);
+}
+
+u64 platform_get_page_size() {
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return system_info.dwPageSize;
+}
+
+u64 platform_get_huge_page_size() {
+    return GetLargePageMinimum();
+}
+
+// Bytes currently reserved with large pages, since unlike Linux Windows does
+// not report them per process
+internal u64 large_page_bytes = 0;
+
+void *platform_reserve_memory(u64 size, b8 huge_pages) {
+    if (huge_pages && GetLargePageMinimum()) {
+        // Large pages cannot be committed later, so the whole range is
+        // committed upfront. This needs the SeLockMemoryPrivilege, and without
+        // it the reservation falls back to regular pages. Windows has no
+        // transparent huge pages to fall back to
+        void *address = VirtualAlloc(
+            nullptr,
+            size,
+            MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+            PAGE_READWRITE);
+
+        if (address) {
+            large_page_bytes += size;
+            return address;
+        }
+    }
+
+    void *address = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+
+    if (!address) {
+        ENGINE_ERROR("platform_reserve_memory - Failed to reserve %llu bytes", size);
+        return nullptr;
+    }
+
+    return address;
+}
+
+b8 platform_commit_memory(void *address, u64 size) {
+    if (!VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE)) {
+        ENGINE_ERROR("platform_commit_memory - Failed to commit %llu bytes at %p", size, address);
+        return false;
+    }
+
+    return true;
+}
+
+void platform_decommit_memory(void *address, u64 size) {
+    VirtualFree(address, size, MEM_DECOMMIT);
+}
+
+void platform_release_memory(void *address, u64 size) {
+    PSAPI_WORKING_SET_EX_INFORMATION info = {};
+    info.VirtualAddress = address;
+
+    if (QueryWorkingSetEx(GetCurrentProcess(), &info, sizeof(info)) &&
+        info.VirtualAttributes.LargePage)
+        large_page_bytes -= size;
+
+    // The whole reservation is released at once, so the size must be 0
+    VirtualFree(address, 0, MEM_RELEASE);
 }
 
-void platform_free(void *block, b8 aligned) {
-    free(block);
+u64 platform_get_huge_page_usage() {
+    return large_page_bytes;
 }
 
 void *platform_zero_memory(void *block, u64 size) {
@@ -183,7 +269,7 @@ void platform_console_write(const char *message, u8 colour) {
 	SetConsoleTextAttribute(console_handle, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
 }
 // Vulkan platform specific definitions
-void platform_get_required_extensions(Auto_Array<const char*>* required_extensions) {
+void platform_get_required_extensions(Vulkan_Extension_Array* required_extensions) {
     ENGINE_INFO("Attaching WIN32 surface for Windows platform");
     required_extensions->add("VK_KHR_win32_surface");
 }
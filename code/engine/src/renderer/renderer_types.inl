@@ -4,6 +4,10 @@
 // This file contains declarations that are going to exposed to multiple subsystems
 // Initially it contained the renderer backend defition too
 
+// Number of frames the CPU can record while the GPU still works on the previous
+// ones. Memory written during a frame must stay untouched for this many frames
+constexpr u32 RENDERER_MAX_IN_FLIGHT_FRAMES = 2;
+
 // Renderer_backend is the interface of the renderer classes
 struct Renderer_Backend {
     u64 frame_number;
@@ -0,0 +1,207 @@
+#include "vulkan_allocator.hpp"
+#include "core/logger.hpp"
+#include "core/memory.hpp"
+
+// Vulkan frees and reallocates by pointer only, so the size of every block is
+// stored right before it. The header sits in the padding needed to keep the
+// block aligned, which is at least MEMORY_DEFAULT_ALIGNMENT bytes
+struct Vulkan_Allocation_Header {
+    u64 size;
+    u64 offset;
+};
+
+// Frames after which the renderer is expected to stop allocating host memory
+constexpr u64 VULKAN_ALLOCATOR_WARM_UP_FRAMES = 60;
+
+internal const char* vulkan_allocation_scope_strings[VULKAN_ALLOCATION_SCOPE_COUNT] = {
+    "COMMAND",
+    "OBJECT",
+    "CACHE",
+    "DEVICE",
+    "INSTANCE"};
+
+KOALA_INLINE Vulkan_Allocation_Header* vulkan_allocation_header(void* block) {
+    return reinterpret_cast<Vulkan_Allocation_Header*>(block) - 1;
+}
+
+internal void* vulkan_allocate_block(u64 size, u64 alignment) {
+    u64 offset = alignment > sizeof(Vulkan_Allocation_Header)
+                     ? alignment
+                     : sizeof(Vulkan_Allocation_Header);
+
+    // The driver does not expect the memory to be zeroed
+    u8* base = static_cast<u8*>(memory_allocate_aligned_uninitialized(
+        size + offset,
+        alignment,
+        Memory_Tag::DRIVER));
+
+    if (!base)
+        return nullptr;
+
+    void* block = base + offset;
+
+    Vulkan_Allocation_Header* header = vulkan_allocation_header(block);
+    header->size = size;
+    header->offset = offset;
+
+    return block;
+}
+
+internal void vulkan_free_block(void* block) {
+    Vulkan_Allocation_Header* header = vulkan_allocation_header(block);
+
+    memory_deallocate(
+        static_cast<u8*>(block) - header->offset,
+        header->size + header->offset,
+        Memory_Tag::DRIVER);
+}
+
+internal void* VKAPI_CALL vulkan_allocation(
+    void* user_data,
+    size_t size,
+    size_t alignment,
+    VkSystemAllocationScope scope) {
+
+    // The spec allows returning nullptr for size 0
+    if (size == 0)
+        return nullptr;
+
+    Vulkan_Allocator_Stats* stats = static_cast<Vulkan_Allocator_Stats*>(user_data);
+    stats->allocation_count[scope].fetch_add(1, std::memory_order_relaxed);
+    stats->frame_allocation_count[scope].fetch_add(1, std::memory_order_relaxed);
+
+    return vulkan_allocate_block(size, alignment);
+}
+
+internal void* VKAPI_CALL vulkan_reallocation(
+    void* user_data,
+    void* original,
+    size_t size,
+    size_t alignment,
+    VkSystemAllocationScope scope) {
+
+    if (!original)
+        return vulkan_allocation(user_data, size, alignment, scope);
+
+    Vulkan_Allocator_Stats* stats = static_cast<Vulkan_Allocator_Stats*>(user_data);
+
+    if (size == 0) {
+        stats->free_count.fetch_add(1, std::memory_order_relaxed);
+        vulkan_free_block(original);
+        return nullptr;
+    }
+
+    stats->reallocation_count.fetch_add(1, std::memory_order_relaxed);
+    stats->frame_allocation_count[scope].fetch_add(1, std::memory_order_relaxed);
+
+    // On failure the original block must be left untouched
+    void* block = vulkan_allocate_block(size, alignment);
+    if (!block)
+        return nullptr;
+
+    u64 old_size = vulkan_allocation_header(original)->size;
+    memory_copy(block, original, old_size < size ? old_size : size);
+    vulkan_free_block(original);
+
+    return block;
+}
+
+internal void VKAPI_CALL vulkan_free(
+    void* user_data,
+    void* block) {
+
+    if (!block)
+        return;
+
+    Vulkan_Allocator_Stats* stats = static_cast<Vulkan_Allocator_Stats*>(user_data);
+    stats->free_count.fetch_add(1, std::memory_order_relaxed);
+
+    vulkan_free_block(block);
+}
+
+// Notifications of memory the driver allocated on its own, for example
+// executable memory for the shaders. Only counted
+internal void VKAPI_CALL vulkan_internal_allocation(
+    void* user_data,
+    size_t size,
+    VkInternalAllocationType type,
+    VkSystemAllocationScope scope) {
+
+    Vulkan_Allocator_Stats* stats = static_cast<Vulkan_Allocator_Stats*>(user_data);
+    stats->internal_allocated.fetch_add(size, std::memory_order_relaxed);
+}
+
+internal void VKAPI_CALL vulkan_internal_free(
+    void* user_data,
+    size_t size,
+    VkInternalAllocationType type,
+    VkSystemAllocationScope scope) {
+
+    Vulkan_Allocator_Stats* stats = static_cast<Vulkan_Allocator_Stats*>(user_data);
+    stats->internal_allocated.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void vulkan_allocator_create(
+    Vulkan_Context* context) {
+
+    memory_zero(&context->allocator_stats, sizeof(Vulkan_Allocator_Stats));
+
+    VkAllocationCallbacks* callbacks = &context->allocation_callbacks;
+    callbacks->pUserData = &context->allocator_stats;
+    callbacks->pfnAllocation = vulkan_allocation;
+    callbacks->pfnReallocation = vulkan_reallocation;
+    callbacks->pfnFree = vulkan_free;
+    callbacks->pfnInternalAllocation = vulkan_internal_allocation;
+    callbacks->pfnInternalFree = vulkan_internal_free;
+
+    context->allocator = callbacks;
+}
+
+void vulkan_allocator_end_frame(
+    Vulkan_Context* context) {
+
+    Vulkan_Allocator_Stats* stats = &context->allocator_stats;
+    u64* last_frame = stats->last_frame_allocation_count;
+    u64 frame_total = 0;
+
+    for (u32 i = 0; i < VULKAN_ALLOCATION_SCOPE_COUNT; ++i) {
+        last_frame[i] = stats->frame_allocation_count[i].exchange(0, std::memory_order_relaxed);
+        frame_total += last_frame[i];
+    }
+
+    stats->frame_index++;
+
+    // Past the warm up every frame should run without driver allocations, so
+    // the ones left are reported on the frame they happen
+    if (frame_total && stats->frame_index > VULKAN_ALLOCATOR_WARM_UP_FRAMES) {
+        ENGINE_WARN(
+            "Vulkan frame %llu performed %llu host allocations (command %llu, object %llu, cache %llu, device %llu, instance %llu)",
+            stats->frame_index,
+            frame_total,
+            last_frame[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND],
+            last_frame[VK_SYSTEM_ALLOCATION_SCOPE_OBJECT],
+            last_frame[VK_SYSTEM_ALLOCATION_SCOPE_CACHE],
+            last_frame[VK_SYSTEM_ALLOCATION_SCOPE_DEVICE],
+            last_frame[VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE]);
+    }
+}
+
+void vulkan_allocator_report(
+    Vulkan_Context* context) {
+
+    Vulkan_Allocator_Stats* stats = &context->allocator_stats;
+
+    for (u32 i = 0; i < VULKAN_ALLOCATION_SCOPE_COUNT; ++i) {
+        ENGINE_DEBUG(
+            "Vulkan %s scope: %llu allocations, %llu in the last frame",
+            vulkan_allocation_scope_strings[i],
+            stats->allocation_count[i].load(std::memory_order_relaxed),
+            stats->last_frame_allocation_count[i]);
+    }
+
+    ENGINE_DEBUG(
+        "Vulkan reallocations: %llu, frees: %llu, internal allocations: %llu bytes",
+        stats->reallocation_count.load(std::memory_order_relaxed),
+        stats->free_count.load(std::memory_order_relaxed),
+        stats->internal_allocated.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "vulkan_types.hpp"
+
+// Sets the allocation callbacks of the context, so the host memory of the
+// driver is served by the engine allocator under the DRIVER tag and shows up
+// in the memory statistics. The counters live in context->allocator_stats
+void vulkan_allocator_create(
+    Vulkan_Context* context);
+
+// Closes the per-frame counters and warns about every frame that still
+// allocates once the renderer is warmed up. Called once per frame by the
+// backend
+void vulkan_allocator_end_frame(
+    Vulkan_Context* context);
+
+// Logs the totals per allocation scope, and the allocations of the last
+// frame that was presented, which should be 0 once the renderer is warmed up
+void vulkan_allocator_report(
+    Vulkan_Context* context);
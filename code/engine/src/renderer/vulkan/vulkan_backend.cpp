@@ -2,6 +2,7 @@
 #include "core/string.hpp"
 
 #include "renderer/renderer_types.inl"
+#include "vulkan_allocator.hpp"
 #include "vulkan_command_buffer.hpp"
 #include "vulkan_device.hpp"
 #include "vulkan_fence.hpp"
@@ -62,8 +63,8 @@ b8 vulkan_initialize(
     // Function pointer assignment
     context.find_memory_index = find_memory_index;
 
-    // TODO: Custom allocator with memory arenas (Ryan Fleury tutorial)
-    context.allocator = nullptr;
+    // Host allocations of the driver go through the engine allocator
+    vulkan_allocator_create(&context);
 
     // TODO: I do not like that the renderer calls the application layer,
     // since the dependency should be inverse.
@@ -103,7 +104,7 @@ b8 vulkan_initialize(
 
     createInfo.pApplicationInfo = &app_info;
 
-    Auto_Array<const char*> required_extensions_array;
+    Vulkan_Extension_Array required_extensions_array(Memory_Tag::RENDERER);
 
     // Get list of required extensions
     required_extensions_array.add(VK_KHR_SURFACE_EXTENSION_NAME);
@@ -111,7 +112,7 @@ b8 vulkan_initialize(
     // Get platform specific extensions
     platform_get_required_extensions(&required_extensions_array);
 
-    Auto_Array<const char*> required_layers_array;
+    Auto_Array<const char*> required_layers_array(Memory_Tag::RENDERER);
 
 // Only enable validation layer in debug builds
 #ifdef DEBUG_BUILD
@@ -151,7 +152,7 @@ b8 vulkan_initialize(
     vulkan_create_debug_logger(&context.instance);
 #endif
 
-    Auto_Array<const char*> device_level_extension_requirements;
+    Vulkan_Extension_Array device_level_extension_requirements(Memory_Tag::RENDERER);
 
     // The swapchain is a device specific property (whether it supports it
     // or it doesn't) so we need to query specificly for the swapchain support
@@ -201,6 +202,14 @@ b8 vulkan_initialize(
         0);
 
     // Allocate the framebuffers
+    // The arrays of the context are accounted with the rest of the renderer
+    context.swapchain.framebuffers.set_allocator(Memory_Tag::RENDERER);
+    context.graphics_command_buffers.set_allocator(Memory_Tag::RENDERER);
+    context.image_available_semaphores.set_allocator(Memory_Tag::RENDERER);
+    context.render_finished_semaphores.set_allocator(Memory_Tag::RENDERER);
+    context.in_flight_fences.set_allocator(Memory_Tag::RENDERER);
+    context.images_in_flight.set_allocator(Memory_Tag::RENDERER);
+
     context.swapchain.framebuffers.reserve(context.swapchain.image_count);
 
     create_framebuffers(
@@ -363,6 +372,8 @@ void vulkan_shutdown(
         context.instance,
         context.allocator);
 
+    vulkan_allocator_report(&context);
+
     ENGINE_DEBUG("Vulkan renderer shut down");
 }
 
@@ -575,6 +586,8 @@ b8 vulkan_frame_present(
     if (!present_frame(backend))
         return false;
 
+    vulkan_allocator_end_frame(&context);
+
     return true;
 }
 
@@ -597,7 +610,7 @@ b8 vulkan_enable_validation_layers(
         vkEnumerateInstanceLayerProperties(&available_layer_count,
                                            nullptr));
 
-    Auto_Array<VkLayerProperties> available_layers_array;
+    Auto_Array<VkLayerProperties> available_layers_array(Memory_Tag::RENDERER);
     available_layers_array.reserve(available_layer_count);
 
     VK_ENSURE_SUCCESS(
@@ -98,7 +98,7 @@ b8 select_physical_device(Vulkan_Context* context,
     // Allocate in heap and then deallocate to keep the compiler happy
     // VkPhysicalDevice physical_devices_array[physical_device_count];
 
-    Auto_Array<VkPhysicalDevice> physical_devices_array;
+    Auto_Array<VkPhysicalDevice> physical_devices_array(Memory_Tag::RENDERER);
     physical_devices_array.reserve(physical_device_count);
 
     vkEnumeratePhysicalDevices(context->instance, &physical_device_count,
@@ -223,8 +223,8 @@ b8 create_logical_device(Vulkan_Context* context) {
     if (!does_present_share_queue)
         distinct_queue_family_indices_count++;
 
-    // u32 queue_family_indeces[distinct_queue_family_indices_count];
-    Auto_Array<u32> queue_family_indices;
+    // At most one family for each of graphics, transfer and present
+    Small_Array<u32, 3> queue_family_indices(Memory_Tag::RENDERER);
     queue_family_indices.reserve(distinct_queue_family_indices_count);
 
     queue_family_indices[0] = context->device.graphics_queue_index;
@@ -236,7 +236,7 @@ b8 create_logical_device(Vulkan_Context* context) {
         queue_family_indices[2] = context->device.present_queue_index;
 
     // Information for the queues that we want to request
-    Auto_Array<VkDeviceQueueCreateInfo> queue_create_infos;
+    Small_Array<VkDeviceQueueCreateInfo, 3> queue_create_infos(Memory_Tag::RENDERER);
     queue_create_infos.reserve(distinct_queue_family_indices_count);
 
     u32 max_queue_count = 2;
@@ -344,7 +344,7 @@ b8 is_device_suitable(
         nullptr);
 
     auto queue_family_properties_array = static_cast<VkQueueFamilyProperties*>(
-        memory_allocate(
+        memory_allocate_uninitialized(
             sizeof(VkQueueFamilyProperties) * queue_family_count,
             Memory_Tag::RENDERER));
 
@@ -482,7 +482,7 @@ b8 is_device_suitable(
 
             // Allocate in heap because the data turned out to be large
             auto extension_properties = static_cast<VkExtensionProperties*>(
-                memory_allocate(
+                memory_allocate_uninitialized(
                     sizeof(VkExtensionProperties) * available_extensions_count,
                     Memory_Tag::RENDERER));
 
@@ -18,7 +18,7 @@ void vulkan_framebuffer_create(
     Vulkan_Framebuffer* out_framebuffer) {
 
     out_framebuffer->attachments = static_cast<VkImageView*>(
-        memory_allocate(
+        memory_allocate_uninitialized(
             sizeof(VkImageView) * attachment_count,
             Memory_Tag::RENDERER));
 
@@ -5,6 +5,6 @@
 
 struct Platform_State;
 
-void platform_get_required_extensions(Auto_Array<const char*>* required_extensions);
+void platform_get_required_extensions(Vulkan_Extension_Array* required_extensions);
 
 b8 platform_create_vulkan_surface(Vulkan_Context* context);
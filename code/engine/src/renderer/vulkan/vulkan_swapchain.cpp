@@ -5,6 +5,7 @@
 
 #include "defines.hpp"
 
+#include "renderer/renderer_types.inl"
 #include "renderer/vulkan/vulkan_device.hpp"
 #include "renderer/vulkan/vulkan_image.hpp"
 #include "renderer/vulkan/vulkan_types.hpp"
@@ -101,7 +102,7 @@ void create_swapchain(
         0,
         swapchain_info->capabilities.maxImageCount);
 
-    out_swapchain->max_in_flight_frames = 2;
+    out_swapchain->max_in_flight_frames = RENDERER_MAX_IN_FLIGHT_FRAMES;
 
     create_info.minImageCount = image_count;
 
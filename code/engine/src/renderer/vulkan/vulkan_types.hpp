@@ -7,8 +7,16 @@
 
 #include <vulkan/vulkan.h>
 
+#include <atomic>
+
 #define VK_ENSURE_SUCCESS(expr) RUNTIME_ASSERT(expr == VK_SUCCESS);
 
+// The extension lists of the renderer hold a few names, which then stay in the
+// array instead of taking a heap block for every list built at startup
+constexpr u32 VULKAN_INLINE_EXTENSION_COUNT = 4;
+
+using Vulkan_Extension_Array = Small_Array<const char*, VULKAN_INLINE_EXTENSION_COUNT>;
+
 struct Vulkan_Swapchain_Support_Info {
     VkSurfaceCapabilitiesKHR capabilities;
     u32 formats_count;
@@ -137,10 +145,35 @@ struct Vulkan_Object_Shader {
 	Vulkan_Pipeline pipeline;
 };
 
+constexpr u32 VULKAN_ALLOCATION_SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+// Host allocations of the driver, indexed by VkSystemAllocationScope. The
+// COMMAND scope covers the allocations that last a single Vulkan call, so
+// non zero frame counts there point at calls that allocate on the hot path.
+// The driver can call the callbacks from its own threads, so the counters
+// they update are relaxed atomics
+struct Vulkan_Allocator_Stats {
+    std::atomic<u64> allocation_count[VULKAN_ALLOCATION_SCOPE_COUNT];
+    std::atomic<u64> frame_allocation_count[VULKAN_ALLOCATION_SCOPE_COUNT];
+
+    std::atomic<u64> reallocation_count;
+    std::atomic<u64> free_count;
+
+    // Memory the driver allocated on its own and only reported to us
+    std::atomic<u64> internal_allocated;
+
+    // Only written by vulkan_allocator_end_frame
+    u64 frame_index;
+    u64 last_frame_allocation_count[VULKAN_ALLOCATION_SCOPE_COUNT];
+};
+
 struct Vulkan_Context {
     VkInstance instance;
     VkSurfaceKHR surface;
+    // Points to allocation_callbacks, see vulkan_allocator_create
     VkAllocationCallbacks* allocator;
+    VkAllocationCallbacks allocation_callbacks;
+    Vulkan_Allocator_Stats allocator_stats;
     VkPhysicalDevice physical_device; // Implicitly destroyed destroying VkInstance
 
     u32 framebuffer_width;
@@ -189,7 +222,7 @@ struct Vulkan_Physical_Device_Requirements {
     b8 transfer;
     b8 discrete_gpu;
     b8 sampler_anisotropy;
-    Auto_Array<const char*>* device_extension_names;
+    Vulkan_Extension_Array* device_extension_names;
 };
 
 #define VK_DEVICE_LEVEL_FUNCTION(device, name)                        \
@@ -14,6 +14,11 @@ b8 create_game(Game* game_inst) {
     game_inst->config.start_width = 1280;
     game_inst->config.start_height = 720;
     game_inst->config.limit_frame = true;
+    // Switch to OVERRUN or UNDERRUN for soak tests hunting memory corruption
+    game_inst->config.memory_guard_mode = Memory_Guard_Mode::DISABLED;
+    // Set to a file path, e.g. "koala_allocations.trace", to record the
+    // allocations for the trace_analyzer tool
+    game_inst->config.memory_trace_path = nullptr;
     game_inst->initialize = game_initialize;
     game_inst->render = game_render;
     game_inst->update = game_update;
@@ -2,6 +2,10 @@
 #include <core/input.hpp>
 #include <core/logger.hpp>
 #include <core/memory.hpp>
+#include <memory/frame_allocator.hpp>
+
+// Frames after which the testbed is expected to stop using the heap
+constexpr u64 STEADY_STATE_FRAME = 60;
 
 b8 game_initialize(Game* game_inst) {
     GAME_INFO("Called game_initialize()");
@@ -10,17 +14,35 @@ b8 game_initialize(Game* game_inst) {
 
 b8 game_update(Game* game_inst, f32 delta_time) {
     // GAME_INFO("Called game_update() with delta_t %.4f ms", delta_time * 1000);
-    local_persist u64 alloc_count = 0;
-    u64 current_alloc_count = alloc_count;
-    alloc_count = memory_get_allocations_count();
+    Memory_Frame_Stats frame_stats;
+    memory_get_frame_stats(&frame_stats);
+
+    // Transient data belongs in the frame allocator, so once the startup is
+    // over every frame should run without touching the heap
+    if (frame_stats.frame_index > STEADY_STATE_FRAME &&
+        frame_stats.allocation_count != 0) {
+        GAME_WARN(
+            "Frame %llu performed %llu heap allocations",
+            frame_stats.frame_index,
+            frame_stats.allocation_count);
+    }
 
     if (input_is_key_up(Keyboard_Key::M) &&
         input_was_key_down(Keyboard_Key::M)) {
 
         GAME_DEBUG(
-            "Allocations: %llu (%llu this frame)",
-            alloc_count,
-            alloc_count - current_alloc_count);
+            "Allocations: %llu (%llu last frame, %lld bytes)",
+            memory_get_allocations_count(),
+            frame_stats.allocation_count,
+            frame_stats.bytes_delta);
+
+        char* usage = static_cast<char*>(frame_allocator_allocate(
+            application_get_frame_allocator(),
+            MEMORY_USAGE_STRING_SIZE));
+
+        memory_refresh_huge_page_usage();
+        memory_get_current_usage(usage, MEMORY_USAGE_STRING_SIZE);
+        GAME_DEBUG("%s", usage);
     }
 
     return true;
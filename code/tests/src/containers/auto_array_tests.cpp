@@ -0,0 +1,370 @@
+#include "auto_array_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <containers/auto_array.hpp>
+#include <core/absolute_clock.hpp>
+#include <core/logger.hpp>
+#include <core/memory.hpp>
+
+// Owns a heap block, so copying its bytes would free the block twice. Counts
+// the live instances to catch missing or extra destructor calls
+struct Tracked_Value {
+    inline static s32 live_count = 0;
+
+    u64* value;
+
+    Tracked_Value(u64 initial) {
+        value = static_cast<u64*>(memory_allocate(sizeof(u64), Memory_Tag::GAME));
+        *value = initial;
+        ++live_count;
+    }
+
+    Tracked_Value()
+        : Tracked_Value(0) {
+    }
+
+    Tracked_Value(const Tracked_Value& other)
+        : Tracked_Value(*other.value) {
+    }
+
+    Tracked_Value(Tracked_Value&& other) {
+        value = other.value;
+        other.value = nullptr;
+        ++live_count;
+    }
+
+    Tracked_Value& operator=(Tracked_Value&& other) {
+        memory_deallocate(value, sizeof(u64), Memory_Tag::GAME);
+        value = other.value;
+        other.value = nullptr;
+        return *this;
+    }
+
+    ~Tracked_Value() {
+        memory_deallocate(value, sizeof(u64), Memory_Tag::GAME);
+        --live_count;
+    }
+};
+
+STATIC_ASSERT(!Is_Trivially_Relocatable<Tracked_Value>::value, "Tracked_Value must take the move path");
+
+u8 auto_array_should_move_non_trivial_elements() {
+    {
+        Auto_Array<Tracked_Value> array;
+
+        for (u64 i = 0; i < 100; ++i)
+            array.emplace(i);
+
+        expect_should_be(100, Tracked_Value::live_count);
+
+        // Copy of an element that is moved by the growth it causes
+        while (array.length < array.capacity)
+            array.emplace(0);
+
+        u64 length = array.length;
+        array.add(array[5]);
+        expect_should_be(5, *array[length].value);
+
+        for (u64 i = 0; i < 100; ++i)
+            expect_should_be(i, *array[i].value);
+
+        array.pop_at(0);
+        expect_should_be(1, *array[0].value);
+        expect_should_be(99, *array[98].value);
+        expect_should_be(array.length, Tracked_Value::live_count);
+
+        array.pop();
+        expect_should_be(array.length, Tracked_Value::live_count);
+
+        array.clear();
+        expect_should_be(0, Tracked_Value::live_count);
+        expect_should_not_be(0, array.capacity);
+
+        array.emplace(7);
+        array.free();
+        expect_should_be(0, Tracked_Value::live_count);
+        expect_should_be(nullptr, array.data);
+    }
+
+    {
+        Auto_Array<Tracked_Value> array;
+        array.reserve(4);
+        expect_should_be(4, array.length);
+        expect_should_be(4, Tracked_Value::live_count);
+        expect_should_be(0, *array[3].value);
+
+        array.free();
+        expect_should_be(0, Tracked_Value::live_count);
+    }
+
+    return true;
+}
+
+u8 auto_array_should_keep_order_on_pop_at() {
+    Auto_Array<u32> array;
+    for (u32 i = 0; i < 10; ++i)
+        array.add(i);
+
+    array.pop_at(3);
+    array.pop_at(8);
+
+    expect_should_be(8, array.length);
+    expect_should_be(2, array[2]);
+    expect_should_be(4, array[3]);
+    expect_should_be(8, array[7]);
+
+    array.free();
+
+    return true;
+}
+
+u8 auto_array_should_release_its_whole_capacity() {
+    Memory_System_Config config = {};
+    config.track_allocations = true;
+
+    void* state = memory_tests_startup(&config);
+
+    Auto_Array<Tracked_Value> array;
+    for (u64 i = 0; i < 5; ++i)
+        array.emplace(i);
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::DARRAY, &stats);
+    expect_should_be(sizeof(Tracked_Value) * array.capacity, stats.allocated);
+
+    array.free();
+
+    memory_get_tag_stats(Memory_Tag::DARRAY, &stats);
+    expect_should_be(0, stats.allocated);
+    memory_get_tag_stats(Memory_Tag::GAME, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 small_array_should_stay_inline_until_full() {
+    Memory_System_Config config = {};
+    config.track_allocations = true;
+
+    void* state = memory_tests_startup(&config);
+
+    Small_Array<u32, 4> array;
+    expect_should_be(nullptr, array.data);
+
+    for (u32 i = 0; i < 4; ++i)
+        array.add(i);
+
+    expect_should_be(true, array.is_inline());
+    expect_should_be(4, array.capacity);
+    expect_should_be(0, memory_get_allocations_count());
+
+    // The fifth element moves all of them to the heap
+    array.add(4);
+    expect_should_be(false, array.is_inline());
+    expect_should_be(8, array.capacity);
+    expect_should_be(1, memory_get_allocations_count());
+
+    for (u32 i = 0; i < 5; ++i)
+        expect_should_be(i, array[i]);
+
+    array.pop_at(1);
+    expect_should_be(2, array[1]);
+    expect_should_be(4, array.length);
+
+    array.free();
+    expect_should_be(nullptr, array.data);
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::DARRAY, &stats);
+    expect_should_be(0, stats.allocated);
+
+    // Small reservations take the inline elements
+    array.reserve(3);
+    expect_should_be(true, array.is_inline());
+    expect_should_be(3, array.length);
+    expect_should_be(0, array[2]);
+
+    array.reserve(6);
+    expect_should_be(false, array.is_inline());
+    expect_should_be(6, array.capacity);
+
+    array.free();
+
+    memory_get_tag_stats(Memory_Tag::DARRAY, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 small_array_should_move_non_trivial_elements() {
+    Small_Array<Tracked_Value, 2> array;
+
+    for (u64 i = 0; i < 2; ++i)
+        array.emplace(i);
+
+    expect_should_be(true, array.is_inline());
+
+    // Copy of an inline element that is moved out by the growth it causes
+    array.add(array[1]);
+    expect_should_be(false, array.is_inline());
+    expect_should_be(3, Tracked_Value::live_count);
+    expect_should_be(0, *array[0].value);
+    expect_should_be(1, *array[1].value);
+    expect_should_be(1, *array[2].value);
+
+    array.free();
+    expect_should_be(0, Tracked_Value::live_count);
+
+    array.reserve(2);
+    expect_should_be(true, array.is_inline());
+    expect_should_be(2, Tracked_Value::live_count);
+
+    array.free();
+    expect_should_be(0, Tracked_Value::live_count);
+
+    return true;
+}
+
+struct Benchmark_Listener {
+    void* listener;
+    void* callback;
+};
+
+// Registers listeners like the engine systems do at startup, most codes get
+// one or two of them, and returns the heap allocations and the time it took
+template <typename Array>
+internal void benchmark_register_listeners(
+    Array* entries,
+    u64 entry_count,
+    u64* out_allocations,
+    f64* out_time) {
+
+    u64 allocations = memory_get_allocations_count();
+
+    Absolute_Clock clock;
+    absolute_clock_start(&clock);
+
+    for (u64 i = 0; i < entry_count; ++i) {
+        u64 listener_count = 1 + (i % 7 == 0) + (i % 31 == 0) * 2;
+
+        for (u64 j = 0; j < listener_count; ++j)
+            entries[i].add({reinterpret_cast<void*>(j + 1), nullptr});
+    }
+
+    for (u64 i = 0; i < entry_count; ++i)
+        entries[i].free();
+
+    absolute_clock_update(&clock);
+    *out_time = clock.elapsed_time;
+    absolute_clock_stop(&clock);
+
+    *out_allocations = memory_get_allocations_count() - allocations;
+}
+
+// Builds the short extension lists of the renderer startup
+template <typename Array>
+internal void benchmark_build_extension_lists(
+    u64 list_count,
+    u64* out_allocations,
+    f64* out_time) {
+
+    u64 allocations = memory_get_allocations_count();
+
+    Absolute_Clock clock;
+    absolute_clock_start(&clock);
+
+    for (u64 i = 0; i < list_count; ++i) {
+        Array extensions;
+        extensions.add("VK_KHR_surface");
+        extensions.add("VK_KHR_xcb_surface");
+        extensions.add("VK_EXT_debug_utils");
+        extensions.free();
+    }
+
+    absolute_clock_update(&clock);
+    *out_time = clock.elapsed_time;
+    absolute_clock_stop(&clock);
+
+    *out_allocations = memory_get_allocations_count() - allocations;
+}
+
+u8 small_array_benchmark_against_auto_array() {
+    constexpr u64 ENTRY_COUNT = 16384;
+    constexpr u64 LIST_COUNT = 100000;
+
+    Memory_System_Config config = {};
+    config.track_allocations = true;
+
+    void* state = memory_tests_startup(&config);
+
+    // Zeroed like the event system state
+    auto* heap_entries = static_cast<Auto_Array<Benchmark_Listener>*>(
+        memory_allocate(sizeof(Auto_Array<Benchmark_Listener>) * ENTRY_COUNT, Memory_Tag::GAME));
+    auto* small_entries = static_cast<Small_Array<Benchmark_Listener, 2>*>(
+        memory_allocate(sizeof(Small_Array<Benchmark_Listener, 2>) * ENTRY_COUNT, Memory_Tag::GAME));
+
+    u64 heap_allocations, small_allocations;
+    f64 heap_time, small_time;
+
+    benchmark_register_listeners(heap_entries, ENTRY_COUNT, &heap_allocations, &heap_time);
+    benchmark_register_listeners(small_entries, ENTRY_COUNT, &small_allocations, &small_time);
+
+    expect_should_be(true, (small_allocations < heap_allocations));
+
+    ENGINE_INFO(
+        "Listener registration: Auto_Array %llu allocations in %.6f sec, Small_Array %llu allocations in %.6f sec",
+        heap_allocations,
+        heap_time,
+        small_allocations,
+        small_time);
+
+    memory_deallocate(heap_entries, sizeof(Auto_Array<Benchmark_Listener>) * ENTRY_COUNT, Memory_Tag::GAME);
+    memory_deallocate(small_entries, sizeof(Small_Array<Benchmark_Listener, 2>) * ENTRY_COUNT, Memory_Tag::GAME);
+
+    benchmark_build_extension_lists<Auto_Array<const char*>>(LIST_COUNT, &heap_allocations, &heap_time);
+    benchmark_build_extension_lists<Small_Array<const char*, 4>>(LIST_COUNT, &small_allocations, &small_time);
+
+    expect_should_be(0, small_allocations);
+
+    ENGINE_INFO(
+        "Extension lists: Auto_Array %llu allocations in %.6f sec, Small_Array %llu allocations in %.6f sec",
+        heap_allocations,
+        heap_time,
+        small_allocations,
+        small_time);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+void auto_array_register_tests() {
+    test_manager_register_test(
+        auto_array_should_move_non_trivial_elements,
+        "Auto array should construct, move and destroy non trivial elements");
+
+    test_manager_register_test(
+        auto_array_should_keep_order_on_pop_at,
+        "Auto array should keep the order of the elements when removing one");
+
+    test_manager_register_test(
+        auto_array_should_release_its_whole_capacity,
+        "Auto array should release the whole capacity it allocated");
+
+    test_manager_register_test(
+        small_array_should_stay_inline_until_full,
+        "Small array should keep its first elements inline and spill to the heap");
+
+    test_manager_register_test(
+        small_array_should_move_non_trivial_elements,
+        "Small array should move non trivial elements out of the inline storage");
+
+    test_manager_register_test(
+        small_array_benchmark_against_auto_array,
+        "Small array benchmark against auto array");
+}
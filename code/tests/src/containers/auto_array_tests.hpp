@@ -0,0 +1,3 @@
+#pragma once
+
+void auto_array_register_tests();
@@ -0,0 +1,398 @@
+#include "hash_map_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <containers/hash_map.hpp>
+#include <core/absolute_clock.hpp>
+#include <core/logger.hpp>
+#include <core/memory.hpp>
+
+#include <unordered_map>
+
+// Counts the live instances to catch missing or extra destructor calls when
+// the entries are shifted around
+struct Counted_Value {
+    inline static s32 live_count = 0;
+
+    u64 value;
+
+    Counted_Value()
+        : value(0) {
+        ++live_count;
+    }
+
+    Counted_Value(u64 initial)
+        : value(initial) {
+        ++live_count;
+    }
+
+    Counted_Value(const Counted_Value& other)
+        : value(other.value) {
+        ++live_count;
+    }
+
+    Counted_Value& operator=(const Counted_Value& other) = default;
+
+    ~Counted_Value() {
+        --live_count;
+    }
+};
+
+struct Resource_Id {
+    u32 type;
+    u32 index;
+
+    b8 operator==(const Resource_Id& other) const {
+        return type == other.type && index == other.index;
+    }
+};
+
+// Only varies in the low bits, the map must still spread the keys
+struct Resource_Id_Hasher {
+    u64 operator()(const Resource_Id& id) const {
+        return (static_cast<u64>(id.type) << 16) ^ id.index;
+    }
+};
+
+// Sends every key to the same bucket, the worst a hasher can do
+struct Constant_Hasher {
+    u64 operator()(const u64& key) const {
+        return 0;
+    }
+};
+
+// Inverse of the multiplier of Hash_Map::bucket_of, so the hashers below
+// choose the bits the bucket is taken from
+constexpr u64 hash_map_test_multiplier_inverse() {
+    u64 multiplier = 0x9E3779B97F4A7C15ull;
+    u64 inverse = multiplier;
+    for (u32 i = 0; i < 5; ++i)
+        inverse *= 2 - multiplier * inverse;
+
+    return inverse;
+}
+
+// Consecutive keys take consecutive buckets once the map has 2048 of them.
+// With fewer, every two keys share a bucket and they all pile up in a single
+// run from the first one
+struct Clustered_Hasher {
+    u64 operator()(const u64& key) const {
+        return (key << 53) * hash_map_test_multiplier_inverse();
+    }
+};
+
+u8 hash_map_should_insert_find_and_remove() {
+    Hash_Map<u64, u64> map;
+    expect_should_be(nullptr, map.find(1));
+    expect_should_be(false, map.remove(1));
+
+    for (u64 i = 0; i < 10000; ++i)
+        expect_should_be(true, map.insert(i * 7919, i));
+
+    expect_should_be(10000, map.length);
+    expect_should_be(false, map.insert(7919, 0));
+    expect_should_be(1, *map.find(7919));
+
+    for (u64 i = 0; i < 10000; i += 2)
+        expect_should_be(true, map.remove(i * 7919));
+
+    expect_should_be(5000, map.length);
+
+    for (u64 i = 0; i < 10000; ++i) {
+        u64* value = map.find(i * 7919);
+        if (i % 2) {
+            expect_should_not_be(nullptr, value);
+            expect_should_be(i, *value);
+        } else {
+            expect_should_be(nullptr, value);
+        }
+    }
+
+    *map.find_or_insert(3) += 5;
+    *map.find_or_insert(3) += 5;
+    expect_should_be(10, *map.find(3));
+
+    u64 visited = 0;
+    u64 sum = 0;
+    for (auto& entry : map) {
+        ++visited;
+        sum += entry.value;
+    }
+
+    // The odd values from 1 to 9999 and the 10 of key 3
+    expect_should_be(map.length, visited);
+    expect_should_be(25000000 + 10, sum);
+
+    map.clear();
+    expect_should_be(0, map.length);
+    expect_should_be(nullptr, map.find(7919));
+
+    map.free();
+    expect_should_be(nullptr, map.entries);
+
+    return true;
+}
+
+u8 hash_map_should_support_string_and_custom_keys() {
+    Hash_Map<const char*, u32> names;
+    names.insert("default_shader", 1);
+    names.insert("ui_shader", 2);
+
+    // Same characters at another address
+    char name[32] = "ui_";
+    name[3] = 's';
+    name[4] = 'h';
+    name[5] = 'a';
+    name[6] = 'd';
+    name[7] = 'e';
+    name[8] = 'r';
+    name[9] = 0;
+
+    expect_should_not_be(nullptr, names.find(name));
+    expect_should_be(2, *names.find(name));
+    expect_should_be(nullptr, names.find("missing_shader"));
+    names.free();
+
+    Hash_Map<Resource_Id, u32, Resource_Id_Hasher> resources;
+    for (u32 type = 0; type < 4; ++type)
+        for (u32 index = 0; index < 1000; ++index)
+            resources.insert({type, index}, type * 1000 + index);
+
+    expect_should_be(4000, resources.length);
+    expect_should_be(2500, *resources.find({2, 500}));
+    expect_should_be(nullptr, resources.find({4, 0}));
+    resources.free();
+
+    return true;
+}
+
+u8 hash_map_should_grow_or_refuse_long_probes() {
+    // The run gets too long past 500 keys, the map grows earlier than its
+    // load asks for and splits it
+    Hash_Map<u64, u64, Clustered_Hasher> clustered;
+    for (u64 key = 0; key < 800; ++key)
+        expect_should_be(true, clustered.insert(key, key));
+
+    expect_should_be(800, clustered.length);
+    expect_should_be(2048, clustered.capacity);
+    for (u64 key = 0; key < 800; ++key)
+        expect_should_be(key, *clustered.find(key));
+
+    clustered.free();
+
+    // Growing cannot split keys of the same bucket, the map refuses them
+    // once it is mostly empty
+    Hash_Map<u64, u64, Constant_Hasher> constant;
+    u32 inserted = 0;
+    for (u64 key = 0; key < 300; ++key)
+        inserted += constant.insert(key, key);
+
+    expect_should_be(HASH_MAP_MAX_DISTANCE - 1, inserted);
+    expect_should_be(HASH_MAP_MAX_DISTANCE - 1, constant.length);
+    expect_should_be(1024, constant.capacity);
+    expect_should_be(nullptr, constant.find(299));
+    expect_should_be(nullptr, constant.find_or_insert(299));
+
+    for (u64 key = 0; key < inserted; ++key)
+        expect_should_be(key, *constant.find(key));
+
+    // A removal makes room again
+    expect_should_be(true, constant.remove(0));
+    expect_should_be(true, constant.insert(299, 299));
+    expect_should_be(299, *constant.find(299));
+
+    constant.free();
+
+    return true;
+}
+
+u8 hash_map_should_construct_and_destroy_values() {
+    {
+        Hash_Map<u32, Counted_Value> map;
+        for (u32 i = 0; i < 1000; ++i)
+            map.insert(i, Counted_Value(i));
+
+        expect_should_be(1000, Counted_Value::live_count);
+
+        // The removals shift the following entries back
+        for (u32 i = 0; i < 1000; i += 3)
+            map.remove(i);
+
+        expect_should_be(map.length, Counted_Value::live_count);
+        expect_should_be(500, map.find(500)->value);
+
+        map.free();
+        expect_should_be(0, Counted_Value::live_count);
+    }
+
+    return true;
+}
+
+u8 hash_map_should_reserve_under_its_tag() {
+    Memory_System_Config config = {};
+    config.track_allocations = true;
+
+    void* state = memory_tests_startup(&config);
+
+    using Map = Hash_Map<u32, u64>;
+
+    Map map(Memory_Tag::RENDERER);
+    map.reserve(1000);
+
+    u64 capacity = map.capacity;
+    expect_should_be(true, (Map::max_length(capacity) >= 1000));
+
+    u64 allocations = memory_get_allocations_count();
+    for (u32 i = 0; i < 1000; ++i)
+        map.insert(i, i);
+
+    // Reserved up front, no rehash on the way
+    expect_should_be(capacity, map.capacity);
+    expect_should_be(allocations, memory_get_allocations_count());
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::RENDERER, &stats);
+    expect_should_be(Map::block_size(capacity), stats.allocated);
+
+    // Only grows, never below the length
+    map.rehash(16);
+    expect_should_be(capacity, map.capacity);
+    map.rehash(capacity * 4);
+    expect_should_be(true, (map.capacity > capacity));
+    expect_should_be(999, *map.find(999));
+
+    map.free();
+
+    memory_get_tag_stats(Memory_Tag::RENDERER, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+// Simple deterministic generator so that both maps see the same keys
+internal u64 hash_map_benchmark_next_key(u64* seed) {
+    *seed = *seed * 6364136223846793005ull + 1442695040888963407ull;
+    return *seed >> 16;
+}
+
+u8 hash_map_benchmark_against_unordered_map() {
+    constexpr u64 KEY_COUNT = 200000;
+
+    Absolute_Clock clock;
+    f64 map_times[4];
+    f64 std_times[4];
+    u64 map_found = 0;
+    u64 std_found = 0;
+
+    {
+        Hash_Map<u64, u64> map;
+        u64 seed = 7;
+
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            map.insert(hash_map_benchmark_next_key(&seed), i);
+        absolute_clock_update(&clock);
+        map_times[0] = clock.elapsed_time;
+
+        seed = 7;
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            map_found += map.find(hash_map_benchmark_next_key(&seed)) != nullptr;
+        absolute_clock_update(&clock);
+        map_times[1] = clock.elapsed_time;
+
+        // Keys past the inserted ones are missing
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            map_found += map.find(hash_map_benchmark_next_key(&seed)) != nullptr;
+        absolute_clock_update(&clock);
+        map_times[2] = clock.elapsed_time;
+
+        seed = 7;
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            map.remove(hash_map_benchmark_next_key(&seed));
+        absolute_clock_update(&clock);
+        map_times[3] = clock.elapsed_time;
+
+        expect_should_be(0, map.length);
+        map.free();
+    }
+
+    {
+        std::unordered_map<u64, u64> map;
+        u64 seed = 7;
+
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            map.emplace(hash_map_benchmark_next_key(&seed), i);
+        absolute_clock_update(&clock);
+        std_times[0] = clock.elapsed_time;
+
+        seed = 7;
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            std_found += map.find(hash_map_benchmark_next_key(&seed)) != map.end();
+        absolute_clock_update(&clock);
+        std_times[1] = clock.elapsed_time;
+
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            std_found += map.find(hash_map_benchmark_next_key(&seed)) != map.end();
+        absolute_clock_update(&clock);
+        std_times[2] = clock.elapsed_time;
+
+        seed = 7;
+        absolute_clock_start(&clock);
+        for (u64 i = 0; i < KEY_COUNT; ++i)
+            map.erase(hash_map_benchmark_next_key(&seed));
+        absolute_clock_update(&clock);
+        std_times[3] = clock.elapsed_time;
+
+        expect_should_be(0, map.size());
+    }
+
+    absolute_clock_stop(&clock);
+
+    expect_should_be(std_found, map_found);
+
+    const char* operations[4] = {"insert", "find hit", "find miss", "remove"};
+    for (u32 i = 0; i < 4; ++i)
+        ENGINE_INFO(
+            "Hash map %s: %llu keys in %.6f sec, std::unordered_map: %.6f sec (%.2fx)",
+            operations[i],
+            KEY_COUNT,
+            map_times[i],
+            std_times[i],
+            map_times[i] > 0 ? std_times[i] / map_times[i] : 0.0);
+
+    return true;
+}
+
+void hash_map_register_tests() {
+    test_manager_register_test(
+        hash_map_should_insert_find_and_remove,
+        "Hash map should insert, find and remove keys");
+
+    test_manager_register_test(
+        hash_map_should_support_string_and_custom_keys,
+        "Hash map should hash C strings by content and accept custom hashers");
+
+    test_manager_register_test(
+        hash_map_should_grow_or_refuse_long_probes,
+        "Hash map should grow or refuse the keys that probe too far");
+
+    test_manager_register_test(
+        hash_map_should_construct_and_destroy_values,
+        "Hash map should construct and destroy non trivial values");
+
+    test_manager_register_test(
+        hash_map_should_reserve_under_its_tag,
+        "Hash map should reserve and rehash its memory under its tag");
+
+    test_manager_register_test(
+        hash_map_benchmark_against_unordered_map,
+        "Hash map benchmark against std::unordered_map");
+}
@@ -0,0 +1,252 @@
+#include <atomic>
+#include <thread>
+
+#include "mpmc_queue_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <containers/mpmc_queue.hpp>
+#include <core/absolute_clock.hpp>
+#include <core/logger.hpp>
+
+constexpr u32 MPMC_QUEUE_MAX_THREADS = 8;
+
+u8 mpmc_queue_should_enqueue_and_dequeue_in_order() {
+    Mpmc_Queue<u32> queue;
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    expect_should_be(false, queue.create(12));
+
+    expect_should_be(true, queue.create(8));
+
+    u32 value = 0;
+    expect_should_be(false, queue.try_dequeue(&value));
+
+    for (u32 i = 0; i < 8; ++i)
+        expect_should_be(true, queue.try_enqueue(i));
+
+    expect_should_be(false, queue.try_enqueue(8));
+    expect_should_be(8, queue.size());
+
+    u32 values[16];
+    expect_should_be(5, queue.try_dequeue_batch(values, 5));
+    for (u32 i = 0; i < 5; ++i)
+        expect_should_be(i, values[i]);
+
+    // Only the cells given back are claimed, across the end of the buffer
+    u32 batch[16] = {8, 9, 10, 11, 12, 13, 14, 15};
+    expect_should_be(5, queue.try_enqueue_batch(batch, 8));
+
+    expect_should_be(8, queue.try_dequeue_batch(values, 16));
+    for (u32 i = 0; i < 8; ++i)
+        expect_should_be(i + 5, values[i]);
+
+    expect_should_be(0, queue.try_dequeue_batch(values, 16));
+    expect_should_be(0, queue.size());
+
+    queue.destroy();
+
+    return true;
+}
+
+// Values carry their producer in the high bits and their rank in the low
+// ones, so the consumers can check the order and the totals
+internal u64 mpmc_queue_make_value(u64 producer, u64 rank) {
+    return (producer << 32) | rank;
+}
+
+struct Mpmc_Queue_Run {
+    Mpmc_Queue<u64>* queue;
+    u64 values_per_producer;
+    u64 batch_size;
+    u32 producer_count;
+    u32 consumer_count;
+
+    std::atomic<u64> consumed;
+    std::atomic<u64> sum;
+    std::atomic<u64> out_of_order;
+};
+
+internal void mpmc_queue_produce(Mpmc_Queue_Run* run, u64 producer) {
+    constexpr u64 MAX_BATCH_SIZE = 64;
+    u64 batch[MAX_BATCH_SIZE];
+    u64 rank = 0;
+
+    while (rank < run->values_per_producer) {
+        u64 count = run->values_per_producer - rank < run->batch_size
+                        ? run->values_per_producer - rank
+                        : run->batch_size;
+
+        for (u64 i = 0; i < count; ++i)
+            batch[i] = mpmc_queue_make_value(producer, rank + i);
+
+        u64 enqueued = run->queue->try_enqueue_batch(batch, count);
+
+        // Lets the consumers run when the threads share cores
+        if (!enqueued)
+            std::this_thread::yield();
+
+        rank += enqueued;
+    }
+}
+
+internal void mpmc_queue_consume(Mpmc_Queue_Run* run) {
+    constexpr u64 MAX_BATCH_SIZE = 64;
+    u64 batch[MAX_BATCH_SIZE];
+
+    // Next rank expected from each producer by this consumer
+    u64 next_rank[MPMC_QUEUE_MAX_THREADS] = {};
+    u64 total = run->values_per_producer * run->producer_count;
+    u64 sum = 0;
+    u64 out_of_order = 0;
+
+    while (run->consumed.load(std::memory_order_relaxed) < total) {
+        u64 count = run->queue->try_dequeue_batch(batch, run->batch_size);
+        if (!count) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (u64 i = 0; i < count; ++i) {
+            u64 producer = batch[i] >> 32;
+            u64 rank = batch[i] & 0xFFFFFFFF;
+
+            out_of_order += rank < next_rank[producer];
+            next_rank[producer] = rank + 1;
+            sum += batch[i];
+        }
+
+        run->consumed.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    run->sum.fetch_add(sum, std::memory_order_relaxed);
+    run->out_of_order.fetch_add(out_of_order, std::memory_order_relaxed);
+}
+
+// Runs the producers and consumers to completion and returns the seconds it
+// took
+internal f64 mpmc_queue_run(Mpmc_Queue_Run* run) {
+    run->consumed.store(0);
+    run->sum.store(0);
+    run->out_of_order.store(0);
+
+    Absolute_Clock clock;
+    absolute_clock_start(&clock);
+
+    std::thread producers[MPMC_QUEUE_MAX_THREADS];
+    std::thread consumers[MPMC_QUEUE_MAX_THREADS];
+
+    for (u32 i = 0; i < run->consumer_count; ++i)
+        consumers[i] = std::thread(mpmc_queue_consume, run);
+
+    for (u32 i = 0; i < run->producer_count; ++i)
+        producers[i] = std::thread(mpmc_queue_produce, run, i);
+
+    for (u32 i = 0; i < run->producer_count; ++i)
+        producers[i].join();
+
+    for (u32 i = 0; i < run->consumer_count; ++i)
+        consumers[i].join();
+
+    absolute_clock_update(&clock);
+    f64 elapsed = clock.elapsed_time;
+    absolute_clock_stop(&clock);
+
+    return elapsed;
+}
+
+internal u64 mpmc_queue_expected_sum(u64 producer_count, u64 values_per_producer) {
+    u64 sum = 0;
+    for (u64 producer = 0; producer < producer_count; ++producer)
+        sum += (producer << 32) * values_per_producer +
+               values_per_producer * (values_per_producer - 1) / 2;
+
+    return sum;
+}
+
+u8 mpmc_queue_stress_test() {
+    constexpr u64 VALUES_PER_PRODUCER = 50000;
+
+    Mpmc_Queue<u64> queue;
+    expect_should_be(true, queue.create(64));
+
+    Mpmc_Queue_Run run;
+    run.queue = &queue;
+    run.values_per_producer = VALUES_PER_PRODUCER;
+    run.producer_count = 4;
+    run.consumer_count = 4;
+
+    // Single values and batches, the batches spanning several laps of the
+    // small buffer
+    u64 batch_sizes[2] = {1, 48};
+    for (u32 i = 0; i < 2; ++i) {
+        run.batch_size = batch_sizes[i];
+        mpmc_queue_run(&run);
+
+        expect_should_be(VALUES_PER_PRODUCER * 4, run.consumed.load());
+        expect_should_be(mpmc_queue_expected_sum(4, VALUES_PER_PRODUCER), run.sum.load());
+        expect_should_be(0, run.out_of_order.load());
+        expect_should_be(0, queue.size());
+    }
+
+    queue.destroy();
+
+    return true;
+}
+
+u8 mpmc_queue_scaling_benchmark() {
+    constexpr u64 TOTAL_VALUES = 1 << 20;
+
+    Mpmc_Queue<u64> queue;
+    expect_should_be(true, queue.create(1024));
+
+    u32 max_threads = std::thread::hardware_concurrency();
+    if (max_threads < 2)
+        max_threads = 2;
+    if (max_threads > MPMC_QUEUE_MAX_THREADS)
+        max_threads = MPMC_QUEUE_MAX_THREADS;
+
+    Mpmc_Queue_Run run;
+    run.queue = &queue;
+
+    for (u32 threads = 1; threads <= max_threads; threads *= 2) {
+        u64 batch_sizes[2] = {1, 32};
+
+        for (u32 i = 0; i < 2; ++i) {
+            run.producer_count = threads;
+            run.consumer_count = threads;
+            run.values_per_producer = TOTAL_VALUES / threads;
+            run.batch_size = batch_sizes[i];
+
+            f64 seconds = mpmc_queue_run(&run);
+
+            expect_should_be(TOTAL_VALUES, run.consumed.load());
+            expect_should_be(mpmc_queue_expected_sum(threads, TOTAL_VALUES / threads), run.sum.load());
+
+            ENGINE_INFO(
+                "MPMC queue: %u producers, %u consumers, batches of %llu: %.6f sec (%.1f M values/sec)",
+                threads,
+                threads,
+                run.batch_size,
+                seconds,
+                seconds > 0 ? TOTAL_VALUES / seconds / 1000000.0 : 0.0);
+        }
+    }
+
+    queue.destroy();
+
+    return true;
+}
+
+void mpmc_queue_register_tests() {
+    test_manager_register_test(
+        mpmc_queue_should_enqueue_and_dequeue_in_order,
+        "MPMC queue should enqueue and dequeue in order, one by one and in batches");
+
+    test_manager_register_test(
+        mpmc_queue_stress_test,
+        "MPMC queue should deliver every value once to concurrent consumers");
+
+    test_manager_register_test(
+        mpmc_queue_scaling_benchmark,
+        "MPMC queue scaling benchmark");
+}
@@ -0,0 +1,136 @@
+#include "slot_map_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <containers/slot_map.hpp>
+#include <core/memory.hpp>
+
+struct Mesh_Data {
+    u64 vertex_count;
+    u64 index_count;
+};
+
+u8 slot_map_should_insert_find_and_remove() {
+    Slot_Map<Mesh_Data> meshes;
+
+    Slot_Handle invalid = {};
+    expect_should_be(nullptr, meshes.find(invalid));
+    expect_should_be(false, meshes.remove(invalid));
+
+    Slot_Handle handles[100];
+    for (u64 i = 0; i < 100; ++i)
+        handles[i] = meshes.insert({i, i * 3});
+
+    expect_should_be(100, meshes.count());
+    expect_should_be(42, meshes.find(handles[42])->vertex_count);
+
+    // Every other value goes, the others keep resolving while they are
+    // moved into the holes
+    for (u64 i = 0; i < 100; i += 2)
+        expect_should_be(true, meshes.remove(handles[i]));
+
+    expect_should_be(50, meshes.count());
+    expect_should_be(false, meshes.remove(handles[0]));
+
+    for (u64 i = 0; i < 100; ++i) {
+        Mesh_Data* mesh = meshes.find(handles[i]);
+        if (i % 2) {
+            expect_should_not_be(nullptr, mesh);
+            expect_should_be(i * 3, mesh->index_count);
+        } else {
+            expect_should_be(nullptr, mesh);
+        }
+    }
+
+    // The packed values hold no holes and map back to their handles
+    u64 sum = 0;
+    for (Mesh_Data& mesh : meshes)
+        sum += mesh.vertex_count;
+
+    expect_should_be(2500, sum);
+
+    for (u64 i = 0; i < meshes.count(); ++i) {
+        Slot_Handle handle = meshes.handle_at(i);
+        expect_should_be(&meshes.values.data[i], meshes.find(handle));
+    }
+
+    meshes.free();
+
+    return true;
+}
+
+u8 slot_map_should_detect_stale_handles() {
+    Slot_Map<u32> map;
+
+    Slot_Handle first = map.insert(1);
+    map.remove(first);
+
+    // The slot is reused with another generation
+    Slot_Handle second = map.insert(2);
+    expect_should_be(first.index, second.index);
+    expect_should_not_be(first.generation, second.generation);
+    expect_should_be(nullptr, map.find(first));
+    expect_should_be(2, *map.find(second));
+
+    // Through the integer forms
+    Slot_Handle unpacked = slot_handle_from_u64(slot_handle_to_u64(second));
+    expect_should_be(true, unpacked == second);
+
+    u32 compact = slot_handle_to_u32(second);
+    expect_should_be(2, *map.find_compact(compact));
+    expect_should_be(nullptr, map.find_compact(slot_handle_to_u32(first)));
+
+    map.clear();
+    expect_should_be(0, map.count());
+    expect_should_be(nullptr, map.find(second));
+    expect_should_be(nullptr, map.find_compact(compact));
+
+    Slot_Handle third = map.insert(3);
+    expect_should_be(second.index, third.index);
+    expect_should_be(3, *map.find(third));
+
+    map.free();
+
+    return true;
+}
+
+u8 slot_map_should_allocate_under_its_tag() {
+    Memory_System_Config config = {};
+    config.track_allocations = true;
+
+    void* state = memory_tests_startup(&config);
+
+    Slot_Map<Mesh_Data> meshes(Memory_Tag::RENDERER);
+    for (u64 i = 0; i < 10; ++i)
+        meshes.insert({i, i});
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::RENDERER, &stats);
+    expect_should_not_be(0, stats.allocated);
+
+    memory_get_tag_stats(Memory_Tag::DARRAY, &stats);
+    expect_should_be(0, stats.allocated);
+
+    meshes.free();
+
+    memory_get_tag_stats(Memory_Tag::RENDERER, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+void slot_map_register_tests() {
+    test_manager_register_test(
+        slot_map_should_insert_find_and_remove,
+        "Slot map should keep the values packed and the handles stable");
+
+    test_manager_register_test(
+        slot_map_should_detect_stale_handles,
+        "Slot map should reject the handles of removed values");
+
+    test_manager_register_test(
+        slot_map_should_allocate_under_its_tag,
+        "Slot map should allocate its arrays under its tag");
+}
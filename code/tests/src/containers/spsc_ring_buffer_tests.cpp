@@ -0,0 +1,238 @@
+#include <thread>
+
+#include "spsc_ring_buffer_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <containers/spsc_ring_buffer.hpp>
+#include <core/absolute_clock.hpp>
+#include <core/logger.hpp>
+
+u8 spsc_ring_buffer_should_push_and_pop_in_order() {
+    Spsc_Ring_Buffer<u32> buffer;
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    expect_should_be(false, buffer.create(6));
+
+    expect_should_be(true, buffer.create(8));
+
+    u32 value = 0;
+    expect_should_be(false, buffer.try_pop(&value));
+
+    for (u32 i = 0; i < 8; ++i)
+        expect_should_be(true, buffer.try_push(i));
+
+    expect_should_be(false, buffer.try_push(8));
+    expect_should_be(8, buffer.size());
+
+    for (u32 i = 0; i < 3; ++i) {
+        expect_should_be(true, buffer.try_pop(&value));
+        expect_should_be(i, value);
+    }
+
+    // Wraps around the end of the buffer
+    u32 values[10] = {8, 9, 10, 11, 12, 13, 14, 15, 16, 17};
+    expect_should_be(3, buffer.try_push_bulk(values, 10));
+
+    u32 popped[10];
+    expect_should_be(8, buffer.try_pop_bulk(popped, 10));
+    for (u32 i = 0; i < 8; ++i)
+        expect_should_be(i + 3, popped[i]);
+
+    expect_should_be(0, buffer.try_pop_bulk(popped, 10));
+
+    // The spans stop at the end of the buffer, position 11 is slot 3
+    u32* span = nullptr;
+    expect_should_be(5, buffer.acquire_write_span(&span));
+    for (u32 i = 0; i < 5; ++i)
+        span[i] = 100 + i;
+    buffer.commit_write(5);
+
+    expect_should_be(3, buffer.acquire_write_span(&span));
+
+    expect_should_be(5, buffer.acquire_read_span(&span));
+    expect_should_be(100, span[0]);
+    expect_should_be(104, span[4]);
+    buffer.commit_read(5);
+
+    expect_should_be(0, buffer.size());
+
+    buffer.destroy();
+
+    return true;
+}
+
+u8 spsc_ring_buffer_should_pass_values_between_threads() {
+    constexpr u64 VALUE_COUNT = 200000;
+
+    Spsc_Ring_Buffer<u64> buffer;
+    expect_should_be(true, buffer.create(256));
+
+    // Mixes the single and bulk calls on both sides
+    std::thread producer([&buffer]() {
+        u64 next = 0;
+        u64 batch[32];
+
+        while (next < VALUE_COUNT) {
+            u64 pushed;
+            if (next % 3) {
+                pushed = buffer.try_push(next);
+            } else {
+                u64 count = VALUE_COUNT - next < 32 ? VALUE_COUNT - next : 32;
+                for (u64 i = 0; i < count; ++i)
+                    batch[i] = next + i;
+
+                pushed = buffer.try_push_bulk(batch, count);
+            }
+
+            // Lets the consumer run when both share a core
+            if (!pushed)
+                std::this_thread::yield();
+
+            next += pushed;
+        }
+    });
+
+    u64 expected = 0;
+    b8 in_order = true;
+    u64 batch[48];
+
+    while (expected < VALUE_COUNT) {
+        u64 popped = 0;
+        if (expected % 2) {
+            u64 value;
+            if (buffer.try_pop(&value)) {
+                in_order &= value == expected;
+                popped = 1;
+            }
+        } else {
+            popped = buffer.try_pop_bulk(batch, 48);
+            for (u64 i = 0; i < popped; ++i)
+                in_order &= batch[i] == expected + i;
+        }
+
+        if (!popped)
+            std::this_thread::yield();
+
+        expected += popped;
+    }
+
+    producer.join();
+
+    expect_should_be(true, in_order);
+    expect_should_be(0, buffer.size());
+
+    buffer.destroy();
+
+    return true;
+}
+
+// Moves value_count values from a producer thread to this one and returns the
+// seconds it took. Batch size 1 uses the single element calls. A side that
+// finds the buffer full or empty yields, so the measure stays meaningful when
+// both threads share a core
+internal f64 spsc_ring_buffer_measure(
+    Spsc_Ring_Buffer<u64>* buffer,
+    u64 value_count,
+    u64 batch_size,
+    u64* out_sum) {
+
+    constexpr u64 MAX_BATCH_SIZE = 256;
+
+    Absolute_Clock clock;
+    absolute_clock_start(&clock);
+
+    std::thread producer([buffer, value_count, batch_size]() {
+        u64 batch[MAX_BATCH_SIZE];
+        u64 next = 0;
+
+        while (next < value_count) {
+            u64 pushed;
+            if (batch_size == 1) {
+                pushed = buffer->try_push(next);
+            } else {
+                u64 count = value_count - next < batch_size ? value_count - next : batch_size;
+                for (u64 i = 0; i < count; ++i)
+                    batch[i] = next + i;
+
+                pushed = buffer->try_push_bulk(batch, count);
+            }
+
+            if (!pushed)
+                std::this_thread::yield();
+
+            next += pushed;
+        }
+    });
+
+    u64 batch[MAX_BATCH_SIZE];
+    u64 received = 0;
+    u64 sum = 0;
+
+    while (received < value_count) {
+        u64 count;
+        if (batch_size == 1) {
+            count = buffer->try_pop(batch);
+        } else {
+            count = buffer->try_pop_bulk(batch, batch_size);
+        }
+
+        for (u64 i = 0; i < count; ++i)
+            sum += batch[i];
+
+        if (!count)
+            std::this_thread::yield();
+
+        received += count;
+    }
+
+    producer.join();
+
+    absolute_clock_update(&clock);
+    f64 elapsed = clock.elapsed_time;
+    absolute_clock_stop(&clock);
+
+    *out_sum = sum;
+
+    return elapsed;
+}
+
+u8 spsc_ring_buffer_throughput_benchmark() {
+    constexpr u64 VALUE_COUNT = 1 << 21;
+    constexpr u64 EXPECTED_SUM = VALUE_COUNT * (VALUE_COUNT - 1) / 2;
+
+    Spsc_Ring_Buffer<u64> buffer;
+    expect_should_be(true, buffer.create(4096));
+
+    u64 batch_sizes[3] = {1, 16, 256};
+    for (u32 i = 0; i < 3; ++i) {
+        u64 sum = 0;
+        f64 seconds = spsc_ring_buffer_measure(&buffer, VALUE_COUNT, batch_sizes[i], &sum);
+
+        expect_should_be(EXPECTED_SUM, sum);
+
+        ENGINE_INFO(
+            "SPSC ring buffer: %llu values in batches of %llu in %.6f sec (%.1f M values/sec)",
+            VALUE_COUNT,
+            batch_sizes[i],
+            seconds,
+            seconds > 0 ? VALUE_COUNT / seconds / 1000000.0 : 0.0);
+    }
+
+    buffer.destroy();
+
+    return true;
+}
+
+void spsc_ring_buffer_register_tests() {
+    test_manager_register_test(
+        spsc_ring_buffer_should_push_and_pop_in_order,
+        "SPSC ring buffer should push and pop in order across the wrap around");
+
+    test_manager_register_test(
+        spsc_ring_buffer_should_pass_values_between_threads,
+        "SPSC ring buffer should pass values in order between two threads");
+
+    test_manager_register_test(
+        spsc_ring_buffer_throughput_benchmark,
+        "SPSC ring buffer throughput benchmark");
+}
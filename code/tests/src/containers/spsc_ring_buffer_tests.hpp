@@ -0,0 +1,3 @@
+#pragma once
+
+void spsc_ring_buffer_register_tests();
@@ -0,0 +1,710 @@
+#include <string.h>
+#include <thread>
+
+#include "memory_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <core/event.hpp>
+#include <containers/auto_array.hpp>
+#include <core/memory.hpp>
+#include <memory/allocation_tracker.hpp>
+#include <memory/virtual_arena.hpp>
+#include <math/math_types.hpp>
+#include <platform/platform.hpp>
+
+void* memory_tests_startup(const Memory_System_Config* config) {
+    u64 state_size = 0;
+    memory_startup(&state_size, nullptr, config);
+
+    void* state = platform_allocate(state_size, 0);
+    memory_startup(&state_size, state, config);
+
+    return state;
+}
+
+void memory_tests_shutdown(void* state) {
+    memory_shutdown(state);
+    platform_free(state, 0);
+}
+
+u8 memory_should_allocate_aligned_blocks() {
+    u64 alignments[4] = {16, 32, 64, 4096};
+
+    for (u32 i = 0; i < 4; ++i) {
+        u8* block = static_cast<u8*>(
+            memory_allocate_aligned(100, alignments[i], Memory_Tag::GAME));
+
+        expect_should_not_be(nullptr, block);
+        expect_should_be(0, reinterpret_cast<u64>(block) % alignments[i]);
+        expect_should_be(0, block[99]);
+
+        memory_deallocate(block, 100, Memory_Tag::GAME);
+    }
+
+    // Default allocations must be suitable for the SIMD math types
+    void* matrix = memory_allocate(sizeof(mat4), Memory_Tag::GAME);
+    expect_should_be(0, reinterpret_cast<u64>(matrix) % alignof(mat4));
+    memory_deallocate(matrix, sizeof(mat4), Memory_Tag::GAME);
+
+    return true;
+}
+
+u8 memory_system_should_route_allocations_through_heap() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    u64* block = static_cast<u64*>(memory_allocate(sizeof(u64) * 4, Memory_Tag::GAME));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(0, block[3]);
+    expect_should_be(0, reinterpret_cast<u64>(block) % MEMORY_DEFAULT_ALIGNMENT);
+
+    // Requests larger than the heap fall back to the platform allocator
+    ENGINE_DEBUG("Note: The following warning is intentionally caused by the test");
+    void* large = memory_allocate(2 * MIB, Memory_Tag::GAME);
+    expect_should_not_be(nullptr, large);
+
+    memory_deallocate(large, 2 * MIB, Memory_Tag::GAME);
+    memory_deallocate(block, sizeof(u64) * 4, Memory_Tag::GAME);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_align_heap_allocations() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    void* small = memory_allocate(24, Memory_Tag::GAME);
+    void* aligned = memory_allocate_aligned(256, 64, Memory_Tag::GAME);
+
+    expect_should_be(0, reinterpret_cast<u64>(small) % MEMORY_DEFAULT_ALIGNMENT);
+    expect_should_be(0, reinterpret_cast<u64>(aligned) % 64);
+
+    Memory_Stats before;
+    memory_get_stats(&before);
+
+    void* uninitialized = memory_allocate_aligned_uninitialized(128, 64, Memory_Tag::GAME);
+    expect_should_be(0, reinterpret_cast<u64>(uninitialized) % 64);
+
+    Memory_Stats after;
+    memory_get_stats(&after);
+    expect_should_be(before.zeroed_bytes, after.zeroed_bytes);
+    expect_should_be(128, after.uninitialized_bytes - before.uninitialized_bytes);
+
+    memory_deallocate(uninitialized, 128, Memory_Tag::GAME);
+    memory_deallocate(aligned, 256, Memory_Tag::GAME);
+    memory_deallocate(small, 24, Memory_Tag::GAME);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_report_huge_pages() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.heap_huge_pages = true;
+    void* state = memory_tests_startup(&config);
+
+    // The heap is rounded up to whole huge pages and keeps working as usual
+    void* block = memory_allocate(KIB, Memory_Tag::GAME);
+    expect_should_not_be(nullptr, block);
+
+    char usage[MEMORY_USAGE_STRING_SIZE];
+    memory_get_current_usage(usage, sizeof(usage));
+    expect_should_not_be(nullptr, strstr(usage, "Huge page backed:"));
+
+    memory_deallocate(block, KIB, Memory_Tag::GAME);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_track_tag_stats() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    void* first = memory_allocate(KIB, Memory_Tag::GAME);
+    void* second = memory_allocate(2 * KIB, Memory_Tag::GAME);
+    memory_deallocate(second, 2 * KIB, Memory_Tag::GAME);
+
+    Memory_Tag_Stats stats;
+    expect_should_be(true, memory_get_tag_stats(Memory_Tag::GAME, &stats));
+    expect_should_be(KIB, stats.allocated);
+    expect_should_be(3 * KIB, stats.peak_allocated);
+    expect_should_be(2, stats.allocation_count);
+    expect_should_be(1, stats.deallocation_count);
+
+    memory_deallocate(first, KIB, Memory_Tag::GAME);
+
+    memory_get_tag_stats(Memory_Tag::GAME, &stats);
+    expect_should_be(0, stats.allocated);
+    expect_should_be(3 * KIB, stats.peak_allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_count_allocations_from_threads() {
+    // The threads share the engine heap, so its lists and the statistics are
+    // both under test
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    constexpr u32 thread_count = 8;
+    constexpr u32 iterations = 10000;
+
+    std::thread threads[thread_count];
+    void* kept[thread_count];
+
+    for (u32 t = 0; t < thread_count; ++t) {
+        threads[t] = std::thread([t, &kept]() {
+            for (u32 i = 0; i < iterations; ++i) {
+                void* block = memory_allocate_uninitialized(32, Memory_Tag::GAME);
+                memory_deallocate(block, 32, Memory_Tag::GAME);
+            }
+            kept[t] = memory_allocate_uninitialized(64, Memory_Tag::GAME);
+        });
+    }
+
+    for (u32 t = 0; t < thread_count; ++t)
+        threads[t].join();
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::GAME, &stats);
+    expect_should_be(thread_count * 64, stats.allocated);
+    expect_should_be(thread_count * (iterations + 1), stats.allocation_count);
+    expect_should_be(thread_count * iterations, stats.deallocation_count);
+
+    Memory_Stats heap_stats;
+    memory_get_stats(&heap_stats);
+    expect_should_be(true, heap_stats.heap_allocated >= thread_count * 64);
+
+    // Blocks freed on another thread still balance the totals
+    for (u32 t = 0; t < thread_count; ++t)
+        memory_deallocate(kept[t], 64, Memory_Tag::GAME);
+
+    memory_get_tag_stats(Memory_Tag::GAME, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_get_stats(&heap_stats);
+    expect_should_be(0, heap_stats.heap_allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_snapshot_without_allocating() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    void* block = memory_allocate(KIB, Memory_Tag::RENDERER);
+
+    u64 allocations_before = memory_get_allocations_count();
+
+    Memory_Stats stats;
+    expect_should_be(true, memory_get_stats(&stats));
+    expect_should_be(KIB, stats.tags[(u64)Memory_Tag::RENDERER].allocated);
+    expect_should_be(KIB, stats.total_allocated);
+    expect_should_be(1, stats.allocation_count);
+    expect_should_be(MIB, stats.heap_size);
+
+    // The report is truncated to the buffer instead of overflowing it
+    char small[32];
+    u64 length = memory_get_current_usage(small, sizeof(small));
+    expect_should_be(sizeof(small) - 1, length);
+    expect_should_be(0, small[sizeof(small) - 1]);
+
+    char usage[MEMORY_USAGE_STRING_SIZE];
+    length = memory_get_current_usage(usage, sizeof(usage));
+    expect_should_be(strlen(usage), length);
+
+    expect_should_be(allocations_before, memory_get_allocations_count());
+
+    memory_deallocate(block, KIB, Memory_Tag::RENDERER);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_measure_frames() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    // Frame 1: two allocations, one of them released
+    void* kept = memory_allocate(256, Memory_Tag::GAME);
+    void* temporary = memory_allocate(128, Memory_Tag::EVENTS);
+    memory_deallocate(temporary, 128, Memory_Tag::EVENTS);
+    memory_end_frame();
+
+    Memory_Frame_Stats frame;
+    expect_should_be(true, memory_get_frame_stats(&frame));
+    expect_should_be(1, frame.frame_index);
+    expect_should_be(2, frame.allocation_count);
+    expect_should_be(1, frame.deallocation_count);
+    expect_should_be(256, frame.bytes_delta);
+    expect_should_be(256, frame.tagged_bytes_delta[(u64)Memory_Tag::GAME]);
+    expect_should_be(0, frame.tagged_bytes_delta[(u64)Memory_Tag::EVENTS]);
+
+    // Frame 2: only a release, so the delta is negative
+    memory_deallocate(kept, 256, Memory_Tag::GAME);
+    memory_end_frame();
+
+    memory_get_frame_stats(&frame);
+    expect_should_be(2, frame.frame_index);
+    expect_should_be(0, frame.allocation_count);
+    expect_should_be(-256, frame.bytes_delta);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_track_allocation_sites() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.track_allocations = true;
+    config.tracking_record_capacity = 64;
+    config.tracking_site_capacity = 16;
+    void* state = memory_tests_startup(&config);
+
+    void* blocks[10];
+    for (u32 i = 0; i < 10; ++i)
+        blocks[i] = memory_allocate(16, Memory_Tag::GAME);
+
+    u32 large_line = __LINE__ + 1;
+    void* large = memory_allocate(KIB, Memory_Tag::RENDERER);
+    expect_should_not_be(nullptr, large);
+
+    Allocation_Site sites[2];
+    u32 count = memory_get_top_allocation_sites(Allocation_Site_Order::ALLOCATION_COUNT, sites, 2);
+    expect_should_be(2, count);
+    expect_should_be(10, sites[0].allocation_count);
+    expect_should_be(160, sites[0].allocated_bytes);
+    expect_should_be(1, sites[1].allocation_count);
+
+    count = memory_get_top_allocation_sites(Allocation_Site_Order::ALLOCATED_BYTES, sites, 1);
+    expect_should_be(1, count);
+    expect_should_be(KIB, sites[0].allocated_bytes);
+    expect_should_be(Memory_Tag::RENDERER, sites[0].tag);
+    expect_should_be(large_line, sites[0].line);
+
+    for (u32 i = 0; i < 10; ++i)
+        memory_deallocate(blocks[i], 16, Memory_Tag::GAME);
+
+    // The live counters follow the deallocations
+    count = memory_get_top_allocation_sites(Allocation_Site_Order::LIVE_BYTES, sites, 2);
+    expect_should_be(KIB, sites[0].live_bytes);
+    expect_should_be(0, sites[1].live_count);
+    expect_should_be(10, sites[1].allocation_count);
+
+    // Leaked on purpose to exercise the report at shutdown. The block is
+    // reclaimed with the heap
+    ENGINE_DEBUG("Note: The following leak warnings are intentionally caused by the test");
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 allocation_tracker_should_keep_probe_chains() {
+    Allocation_Tracker tracker;
+    u64 requirement = allocation_tracker_memory_requirement(16, 4);
+    void* memory = platform_allocate(requirement, 0);
+    allocation_tracker_create(16, 4, memory, &tracker);
+
+    // Fill most of the table so that the probe sequences collide and wrap
+    u64 fake_blocks[12];
+    for (u32 i = 0; i < 12; ++i)
+        allocation_tracker_add(&tracker, &fake_blocks[i], 8, Memory_Tag::GAME, "file", 1, 0);
+
+    // 12 records is 3/4 of the capacity, the most the table takes
+    expect_should_be(12, tracker.record_count);
+    expect_should_be(0, tracker.dropped_count);
+
+    // Removing every other record must keep the rest reachable
+    for (u32 i = 0; i < 12; i += 2)
+        expect_should_be(true, allocation_tracker_remove(&tracker, &fake_blocks[i], nullptr));
+
+    for (u32 i = 1; i < 12; i += 2) {
+        Allocation_Record record;
+        expect_should_be(true, allocation_tracker_remove(&tracker, &fake_blocks[i], &record));
+        expect_should_be(8, record.size);
+    }
+
+    expect_should_be(0, tracker.record_count);
+    expect_should_be(false, allocation_tracker_remove(&tracker, &fake_blocks[0], nullptr));
+
+    allocation_tracker_destroy(&tracker);
+    platform_free(memory, 0);
+
+    return true;
+}
+
+u8 allocation_tracker_should_drop_past_the_load_limit() {
+    Allocation_Tracker tracker;
+    u64 requirement = allocation_tracker_memory_requirement(16, 4);
+    void* memory = platform_allocate(requirement, 0);
+    allocation_tracker_create(16, 4, memory, &tracker);
+
+    u64 fake_blocks[16];
+    ENGINE_DEBUG("Note: The following warning is intentionally caused by the test");
+    for (u32 i = 0; i < 16; ++i)
+        allocation_tracker_add(&tracker, &fake_blocks[i], 8, Memory_Tag::GAME, "file", 1, 0);
+
+    // Past 3/4 of the capacity the allocations are dropped
+    expect_should_be(12, tracker.record_count);
+    expect_should_be(4, tracker.dropped_count);
+
+    // The dropped blocks are not found, the tracked ones still are
+    expect_should_be(false, allocation_tracker_remove(&tracker, &fake_blocks[15], nullptr));
+    expect_should_be(true, allocation_tracker_remove(&tracker, &fake_blocks[0], nullptr));
+
+    // A freed record makes room again
+    allocation_tracker_add(&tracker, &fake_blocks[0], 8, Memory_Tag::GAME, "file", 1, 0);
+    expect_should_be(12, tracker.record_count);
+    expect_should_be(4, tracker.dropped_count);
+
+    allocation_tracker_destroy(&tracker);
+    platform_free(memory, 0);
+
+    return true;
+}
+
+struct Budget_Test_Cache {
+    void* blocks[8];
+    u32 count;
+};
+
+internal b8 budget_test_evict(Memory_Tag tag, u64 bytes_over, void* user_data) {
+    Budget_Test_Cache* cache = static_cast<Budget_Test_Cache*>(user_data);
+    if (cache->count == 0)
+        return false;
+
+    // Evict the oldest entry only, the memory system calls again if needed
+    memory_deallocate(cache->blocks[0], KIB, tag);
+    memory_move(cache->blocks, cache->blocks + 1, sizeof(void*) * --cache->count);
+
+    return true;
+}
+
+internal b8 budget_test_on_event(Event_Code code, void* sender, void* listener_inst, Event_Context context) {
+    Event_Context* last = static_cast<Event_Context*>(listener_inst);
+    *last = context;
+    return true;
+}
+
+u8 memory_system_should_enforce_budgets() {
+    u64 event_state_size = 0;
+    event_startup(&event_state_size, nullptr);
+    void* event_state = platform_allocate(event_state_size, 0);
+    event_startup(&event_state_size, event_state);
+
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    Event_Context last_event = {};
+    event_register_listener(Event_Code::MEMORY_BUDGET_EXCEEDED, &last_event, budget_test_on_event);
+
+    memory_set_budget(Memory_Tag::GAME, 2 * KIB, 4 * KIB);
+
+    Budget_Test_Cache cache = {};
+    cache.blocks[cache.count++] = memory_allocate(KIB, Memory_Tag::GAME);
+    expect_should_be(0, last_event.data.u64[1]);
+
+    // Crossing the soft limit fires the event but allocates
+    cache.blocks[cache.count++] = memory_allocate(KIB, Memory_Tag::GAME);
+    expect_should_not_be(nullptr, cache.blocks[1]);
+    expect_should_be((u32)Memory_Tag::GAME, last_event.data.u32[0]);
+    expect_should_be(0, last_event.data.u32[1]);
+    expect_should_be(2 * KIB, last_event.data.u64[1]);
+
+    cache.blocks[cache.count++] = memory_allocate(KIB, Memory_Tag::GAME);
+    cache.blocks[cache.count++] = memory_allocate(KIB, Memory_Tag::GAME);
+
+    // Without an eviction callback the hard limit fails the allocation
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    void* over = memory_allocate(KIB, Memory_Tag::GAME);
+    expect_should_be(nullptr, over);
+    expect_should_be(1, last_event.data.u32[1]);
+
+    // With a callback the cache makes room for the new block
+    memory_set_eviction_callback(Memory_Tag::GAME, budget_test_evict, &cache);
+    void* fresh = memory_allocate(2 * KIB, Memory_Tag::GAME);
+    expect_should_not_be(nullptr, fresh);
+    expect_should_be(2, cache.count);
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::GAME, &stats);
+    expect_should_be(4 * KIB, stats.allocated);
+
+    // Other tags are not affected
+    void* other = memory_allocate(8 * KIB, Memory_Tag::RENDERER);
+    expect_should_not_be(nullptr, other);
+
+    memory_deallocate(other, 8 * KIB, Memory_Tag::RENDERER);
+    memory_deallocate(fresh, 2 * KIB, Memory_Tag::GAME);
+    for (u32 i = 0; i < cache.count; ++i)
+        memory_deallocate(cache.blocks[i], KIB, Memory_Tag::GAME);
+
+    // A growth that has to move is checked once, for the added bytes only,
+    // even though the old block is still charged while it is copied
+    memory_set_eviction_callback(Memory_Tag::GAME, nullptr, nullptr);
+
+    void* half = memory_allocate(2 * KIB, Memory_Tag::GAME);
+    void* blocker = memory_allocate(64, Memory_Tag::RENDERER);
+    void* grown = memory_reallocate(half, 2 * KIB, 3 * KIB, Memory_Tag::GAME);
+    expect_should_not_be(nullptr, grown);
+    expect_should_not_be(half, grown);
+
+    memory_get_tag_stats(Memory_Tag::GAME, &stats);
+    expect_should_be(3 * KIB, stats.allocated);
+
+    memory_deallocate(blocker, 64, Memory_Tag::RENDERER);
+    memory_deallocate(grown, 3 * KIB, Memory_Tag::GAME);
+
+    // The listener array of the event system lives in the heap
+    event_shutdown(event_state);
+    platform_free(event_state, 0);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_system_should_reallocate_in_place() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.track_allocations = true;
+    void* state = memory_tests_startup(&config);
+
+    u64* block = static_cast<u64*>(memory_reallocate(nullptr, 0, 64, Memory_Tag::GAME));
+    expect_should_not_be(nullptr, block);
+
+    for (u64 i = 0; i < 8; ++i)
+        block[i] = i;
+
+    // Nothing follows the block in the heap, so it grows without moving
+    u64* grown = static_cast<u64*>(memory_reallocate(block, 64, 4 * KIB, Memory_Tag::GAME));
+    expect_should_be(block, grown);
+
+    Memory_Tag_Stats tag_stats;
+    memory_get_tag_stats(Memory_Tag::GAME, &tag_stats);
+    expect_should_be(4 * KIB, tag_stats.allocated);
+    expect_should_be(2, tag_stats.allocation_count);
+    expect_should_be(1, tag_stats.deallocation_count);
+
+    // A block right after it forces the next growth to move, keeping the data
+    void* blocker = memory_allocate(64, Memory_Tag::GAME);
+    u64* moved = static_cast<u64*>(memory_reallocate(grown, 4 * KIB, 8 * KIB, Memory_Tag::GAME));
+    expect_should_not_be(grown, moved);
+
+    for (u64 i = 0; i < 8; ++i)
+        expect_should_be(i, moved[i]);
+
+    // Shrinking never moves
+    u64* shrunk = static_cast<u64*>(memory_reallocate(moved, 8 * KIB, 128, Memory_Tag::GAME));
+    expect_should_be(moved, shrunk);
+    expect_should_be(7, shrunk[7]);
+
+    memory_deallocate(blocker, 64, Memory_Tag::GAME);
+    memory_deallocate(shrunk, 128, Memory_Tag::GAME);
+
+    // Doubling an array that is alone at the end of the heap never copies
+    Auto_Array<u32> array;
+    array.add(0);
+    u32* first_data = array.data;
+
+    for (u32 i = 1; i < 1000; ++i)
+        array.add(i);
+
+    expect_should_be(first_data, array.data);
+    expect_should_be(999, array[999]);
+    array.free();
+
+    memory_get_tag_stats(Memory_Tag::GAME, &tag_stats);
+    expect_should_be(0, tag_stats.allocated);
+
+    Memory_Stats stats;
+    memory_get_stats(&stats);
+    expect_should_be(0, stats.heap_allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_thread_scratch_should_reset_and_fold_stats() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    Virtual_Arena* scratch = memory_thread_scratch();
+    expect_should_not_be(nullptr, scratch);
+    expect_should_be(scratch, memory_thread_scratch());
+
+    u64 outer = memory_scratch_begin();
+    u8* first = static_cast<u8*>(memory_scratch_allocate(256));
+    first[0] = 1;
+
+    u64 inner = memory_scratch_begin();
+    memory_scratch_allocate(KIB);
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::SCRATCH, &stats);
+    expect_should_be(256 + KIB, stats.allocated);
+
+    // Scratch memory never reaches the heap
+    expect_should_be(0, stats.allocation_count);
+    expect_should_be(0, memory_get_allocations_count());
+
+    memory_scratch_end(inner);
+    memory_get_tag_stats(Memory_Tag::SCRATCH, &stats);
+    expect_should_be(256, stats.allocated);
+    expect_should_be(1, first[0]);
+
+    memory_scratch_end(outer);
+    memory_get_tag_stats(Memory_Tag::SCRATCH, &stats);
+    expect_should_be(0, stats.allocated);
+    expect_should_be(256 + KIB, stats.peak_allocated);
+
+    // The frame boundary resets the scratch of the main thread
+    memory_scratch_allocate(512);
+    memory_end_frame();
+    expect_should_be(0, scratch->allocated);
+
+    // A restart at the same address charges the bytes still in the arena to
+    // the new stats, instead of the ones folded before the restart
+    memory_scratch_allocate(256);
+    memory_shutdown(state);
+
+    u64 state_size = 0;
+    memory_startup(&state_size, nullptr, &config);
+    memory_startup(&state_size, state, &config);
+
+    memory_scratch_allocate(128);
+    memory_get_tag_stats(Memory_Tag::SCRATCH, &stats);
+    expect_should_be(256 + 128, stats.allocated);
+
+    memory_scratch_reset();
+    memory_get_tag_stats(Memory_Tag::SCRATCH, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 memory_thread_scratch_should_be_private_to_threads() {
+    Memory_System_Config config = {};
+    void* state = memory_tests_startup(&config);
+
+    constexpr u32 thread_count = 4;
+    std::thread threads[thread_count];
+    Virtual_Arena* arenas[thread_count];
+
+    for (u32 t = 0; t < thread_count; ++t) {
+        threads[t] = std::thread([t, &arenas]() {
+            arenas[t] = memory_thread_scratch();
+
+            for (u32 job = 0; job < 100; ++job) {
+                u64 marker = memory_scratch_begin();
+                u32* values = static_cast<u32*>(memory_scratch_allocate(sizeof(u32) * 64));
+                for (u32 i = 0; i < 64; ++i)
+                    values[i] = t;
+                memory_scratch_end(marker);
+            }
+
+            // Left allocated on purpose, released when the thread exits
+            memory_scratch_allocate(KIB);
+        });
+    }
+
+    for (u32 t = 0; t < thread_count; ++t)
+        threads[t].join();
+
+    for (u32 t = 1; t < thread_count; ++t)
+        expect_should_not_be(arenas[0], arenas[t]);
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::SCRATCH, &stats);
+    expect_should_be(0, stats.allocated);
+    expect_should_be(0, stats.allocation_count);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+void memory_register_tests() {
+    test_manager_register_test(
+        memory_should_allocate_aligned_blocks,
+        "Memory should allocate blocks with the requested alignment");
+
+    test_manager_register_test(
+        memory_system_should_route_allocations_through_heap,
+        "Memory system should serve allocations from the engine heap");
+
+    test_manager_register_test(
+        memory_system_should_align_heap_allocations,
+        "Memory system should align the allocations served from the heap");
+
+    test_manager_register_test(
+        memory_system_should_report_huge_pages,
+        "Memory system should report the huge page backed memory");
+
+    test_manager_register_test(
+        memory_system_should_track_tag_stats,
+        "Memory system should track the current and peak bytes per tag");
+
+    test_manager_register_test(
+        memory_system_should_count_allocations_from_threads,
+        "Memory system should keep exact statistics across threads");
+
+    test_manager_register_test(
+        memory_system_should_snapshot_without_allocating,
+        "Memory system should snapshot the statistics without allocating");
+
+    test_manager_register_test(
+        memory_system_should_measure_frames,
+        "Memory system should measure the allocations of each frame");
+
+    test_manager_register_test(
+        memory_system_should_track_allocation_sites,
+        "Memory system should track the allocation sites");
+
+    test_manager_register_test(
+        allocation_tracker_should_keep_probe_chains,
+        "Allocation tracker should find the records after removals");
+
+    test_manager_register_test(
+        allocation_tracker_should_drop_past_the_load_limit,
+        "Allocation tracker should drop the records past its load limit");
+
+    test_manager_register_test(
+        memory_system_should_enforce_budgets,
+        "Memory system should enforce the soft and hard budgets of the tags");
+
+    test_manager_register_test(
+        memory_system_should_reallocate_in_place,
+        "Memory system should reallocate heap blocks in place when possible");
+
+    test_manager_register_test(
+        memory_thread_scratch_should_reset_and_fold_stats,
+        "Thread scratch should reset to markers and fold its usage into the stats");
+
+    test_manager_register_test(
+        memory_thread_scratch_should_be_private_to_threads,
+        "Thread scratch should give every thread its own arena");
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <core/memory.hpp>
+
+// Starts the memory system with the config in a state block from the platform,
+// for the tests that check what the memory system accounts
+void* memory_tests_startup(const Memory_System_Config* config);
+
+// Stops the memory system and releases the state of memory_tests_startup
+void memory_tests_shutdown(void* state);
+
+void memory_register_tests();
@@ -1,6 +1,21 @@
+#include "containers/auto_array_tests.hpp"
+#include "containers/hash_map_tests.hpp"
+#include "containers/mpmc_queue_tests.hpp"
+#include "containers/slot_map_tests.hpp"
+#include "containers/spsc_ring_buffer_tests.hpp"
 #include "core/logger.hpp"
 #include "core/memory.hpp"
+#include "core/memory_tests.hpp"
+#include "memory/allocation_trace_tests.hpp"
+#include "memory/allocator_tests.hpp"
+#include "memory/dynamic_allocator_tests.hpp"
+#include "memory/frame_allocator_tests.hpp"
+#include "memory/guard_allocator_tests.hpp"
 #include "memory/linear_allocator_tests.hpp"
+#include "memory/pool_allocator_tests.hpp"
+#include "memory/relocatable_heap_tests.hpp"
+#include "memory/stack_allocator_tests.hpp"
+#include "memory/virtual_arena_tests.hpp"
 #include "test_manager.hpp"
 #include "platform/platform.hpp"
 
@@ -9,6 +24,21 @@ int main() {
 
     // Test registration portion
     linear_allocator_register_tests();
+    pool_allocator_register_tests();
+    stack_allocator_register_tests();
+    dynamic_allocator_register_tests();
+    virtual_arena_register_tests();
+    frame_allocator_register_tests();
+    guard_allocator_register_tests();
+    relocatable_heap_register_tests();
+    memory_register_tests();
+    auto_array_register_tests();
+    hash_map_register_tests();
+    spsc_ring_buffer_register_tests();
+    mpmc_queue_register_tests();
+    slot_map_register_tests();
+    allocator_register_tests();
+    allocation_trace_register_tests();
 
     ENGINE_DEBUG("Starting tests...");
 
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <thread>
+
+#include "allocation_trace_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <core/memory.hpp>
+#include <memory/allocation_trace.hpp>
+#include <platform/filesystem.hpp>
+#include <trace_reader.hpp>
+#include <trace_replay.hpp>
+#include <trace_stats.hpp>
+
+constexpr const char* ALLOCATION_TRACE_TEST_PATH = "allocation_trace_test.trace";
+
+u8 allocation_trace_should_record_allocations_and_frames() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.trace_path = ALLOCATION_TRACE_TEST_PATH;
+    // Smaller than the number of records, so the buffer is flushed midway
+    config.trace_buffer_records = 4;
+
+    void* state = memory_tests_startup(&config);
+
+    void* blocks[3];
+    u64 sizes[3] = {16, 100, 4096};
+
+    for (u32 i = 0; i < 3; ++i)
+        blocks[i] = memory_allocate(sizes[i], Memory_Tag::GAME);
+
+    memory_end_frame();
+
+    for (u32 i = 0; i < 3; ++i)
+        memory_deallocate(blocks[i], sizes[i], Memory_Tag::GAME);
+
+    memory_tests_shutdown(state);
+
+    File_Handle file;
+    expect_should_be(true, filesystem_open(ALLOCATION_TRACE_TEST_PATH, File_Modes::READ, true, &file));
+
+    Allocation_Trace_Header header;
+    u64 read = 0;
+    expect_should_be(true, filesystem_read(&file, sizeof(header), &header, &read));
+    expect_should_be(ALLOCATION_TRACE_MAGIC, header.magic);
+    expect_should_be(ALLOCATION_TRACE_VERSION, header.version);
+    expect_should_be(sizeof(Allocation_Trace_Record), header.record_size);
+    expect_should_be((u32)Memory_Tag::MAX_ENTRIES, header.tag_count);
+
+    Allocation_Trace_Record records[8];
+    filesystem_read(&file, sizeof(records), records, &read);
+    filesystem_close(&file);
+    remove(ALLOCATION_TRACE_TEST_PATH);
+
+    expect_should_be(7 * sizeof(Allocation_Trace_Record), read);
+
+    for (u32 i = 0; i < 3; ++i) {
+        expect_should_be((u8)Allocation_Trace_Event::ALLOCATE, (u8)records[i].event);
+        expect_should_be(reinterpret_cast<u64>(blocks[i]), records[i].address);
+        expect_should_be(sizes[i], records[i].size);
+        expect_should_be((u8)Memory_Tag::GAME, records[i].tag);
+    }
+
+    expect_should_be((u8)Allocation_Trace_Event::FRAME_END, (u8)records[3].event);
+    expect_should_be(1, records[3].size);
+
+    for (u32 i = 0; i < 3; ++i) {
+        expect_should_be((u8)Allocation_Trace_Event::FREE, (u8)records[4 + i].event);
+        expect_should_be(reinterpret_cast<u64>(blocks[i]), records[4 + i].address);
+        expect_should_be(sizes[i], records[4 + i].size);
+    }
+
+    for (u32 i = 1; i < 7; ++i) {
+        expect_should_be(true, records[i].timestamp >= records[i - 1].timestamp);
+        expect_should_be(records[0].thread, records[i].thread);
+    }
+
+    return true;
+}
+
+u8 allocation_trace_should_round_trip_through_the_analyzer() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.trace_path = ALLOCATION_TRACE_TEST_PATH;
+
+    void* state = memory_tests_startup(&config);
+
+    void* first = memory_allocate(64, Memory_Tag::GAME);
+    void* second = memory_allocate(KIB, Memory_Tag::RENDERER);
+    memory_end_frame();
+
+    memory_deallocate(first, 64, Memory_Tag::GAME);
+    void* third = memory_allocate(256, Memory_Tag::GAME);
+    memory_end_frame();
+
+    memory_deallocate(second, KIB, Memory_Tag::RENDERER);
+    memory_deallocate(third, 256, Memory_Tag::GAME);
+
+    memory_tests_shutdown(state);
+
+    // The reader gives back the records in the order they were written
+    Trace_Reader reader;
+    expect_should_be(true, trace_reader_open(ALLOCATION_TRACE_TEST_PATH, &reader));
+
+    Allocation_Trace_Event events[8];
+    u32 record_count = 0;
+    Allocation_Trace_Record record;
+    while (record_count < 8 && trace_reader_next(&reader, &record))
+        events[record_count++] = record.event;
+
+    trace_reader_close(&reader);
+
+    expect_should_be(8, record_count);
+    expect_should_be((u8)Allocation_Trace_Event::ALLOCATE, (u8)events[0]);
+    expect_should_be((u8)Allocation_Trace_Event::FRAME_END, (u8)events[2]);
+    expect_should_be((u8)Allocation_Trace_Event::FREE, (u8)events[3]);
+    expect_should_be((u8)Allocation_Trace_Event::FREE, (u8)events[7]);
+
+    Trace_Stats stats;
+    expect_should_be(true, trace_stats_compute(ALLOCATION_TRACE_TEST_PATH, 0, nullptr, &stats));
+    expect_should_be(8, stats.record_count);
+    expect_should_be(3, stats.allocation_count);
+    expect_should_be(3, stats.free_count);
+    expect_should_be(0, stats.unmatched_free_count);
+    expect_should_be(2, stats.frame_count);
+    expect_should_be(KIB + 256, stats.peak_bytes);
+    expect_should_be(2, stats.peak_blocks);
+    expect_should_be(2, stats.tag_allocation_count[(u8)Memory_Tag::GAME]);
+    expect_should_be(KIB, stats.tag_peak_bytes[(u8)Memory_Tag::RENDERER]);
+    expect_should_be(0, stats.leaked_blocks);
+
+    // Every allocator of the analyzer replays all the operations
+    for (const Replay_Allocator* allocator = trace_replay_get_allocators(); allocator->name; ++allocator) {
+        Replay_Result result;
+        expect_should_be(true, trace_replay(ALLOCATION_TRACE_TEST_PATH, allocator, MIB, &result));
+        expect_should_be(6, result.operations);
+        expect_should_be(0, result.failed_allocations);
+    }
+
+    remove(ALLOCATION_TRACE_TEST_PATH);
+
+    return true;
+}
+
+u8 allocation_trace_should_keep_the_records_of_all_threads() {
+    constexpr u32 THREAD_COUNT = 4;
+    constexpr u32 ALLOCATIONS_PER_THREAD = 1000;
+
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.trace_path = ALLOCATION_TRACE_TEST_PATH;
+    // The buffers fill up and are written while the other threads record
+    config.trace_buffer_records = 16;
+
+    void* state = memory_tests_startup(&config);
+
+    std::thread threads[THREAD_COUNT];
+    for (u32 i = 0; i < THREAD_COUNT; ++i) {
+        threads[i] = std::thread([]() {
+            for (u32 j = 0; j < ALLOCATIONS_PER_THREAD; ++j) {
+                void* block = memory_allocate(32, Memory_Tag::GAME);
+                memory_deallocate(block, 32, Memory_Tag::GAME);
+            }
+        });
+    }
+
+    for (u32 i = 0; i < THREAD_COUNT; ++i)
+        threads[i].join();
+
+    memory_tests_shutdown(state);
+
+    Trace_Reader reader;
+    expect_should_be(true, trace_reader_open(ALLOCATION_TRACE_TEST_PATH, &reader));
+
+    u64 record_count = 0;
+    u64 previous_timestamp = 0;
+    b8 ordered = true;
+    Allocation_Trace_Record record;
+    while (trace_reader_next(&reader, &record)) {
+        ordered = ordered && record.timestamp >= previous_timestamp;
+        previous_timestamp = record.timestamp;
+        ++record_count;
+    }
+
+    trace_reader_close(&reader);
+    remove(ALLOCATION_TRACE_TEST_PATH);
+
+    // The buffers reach the file in the order they were filled
+    expect_should_be(2 * THREAD_COUNT * ALLOCATIONS_PER_THREAD, record_count);
+    expect_should_be(true, ordered);
+
+    return true;
+}
+
+void allocation_trace_register_tests() {
+    test_manager_register_test(
+        allocation_trace_should_record_allocations_and_frames,
+        "Allocation trace should record allocations and frames");
+
+    test_manager_register_test(
+        allocation_trace_should_round_trip_through_the_analyzer,
+        "Allocation trace should round trip through the trace analyzer");
+
+    test_manager_register_test(
+        allocation_trace_should_keep_the_records_of_all_threads,
+        "Allocation trace should keep the records of all the threads");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void allocation_trace_register_tests();
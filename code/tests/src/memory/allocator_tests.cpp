@@ -0,0 +1,139 @@
+#include "allocator_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <containers/auto_array.hpp>
+#include <core/memory.hpp>
+#include <memory/allocator.hpp>
+#include <memory/frame_allocator.hpp>
+#include <memory/linear_allocator.hpp>
+#include <memory/pool_allocator.hpp>
+
+u8 allocator_should_account_heap_arrays_under_their_tag() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+
+    void* state = memory_tests_startup(&config);
+
+    Auto_Array<u64> renderer_array(Memory_Tag::RENDERER);
+    Auto_Array<u64> default_array;
+
+    for (u64 i = 0; i < 10; ++i) {
+        renderer_array.add(i);
+        default_array.add(i);
+    }
+
+    Memory_Tag_Stats stats;
+    memory_get_tag_stats(Memory_Tag::RENDERER, &stats);
+    expect_should_be(sizeof(u64) * renderer_array.capacity, stats.allocated);
+
+    memory_get_tag_stats(Memory_Tag::DARRAY, &stats);
+    expect_should_be(sizeof(u64) * default_array.capacity, stats.allocated);
+
+    renderer_array.free();
+    default_array.free();
+
+    memory_get_tag_stats(Memory_Tag::RENDERER, &stats);
+    expect_should_be(0, stats.allocated);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+u8 allocator_should_grow_arena_arrays_in_place() {
+    Linear_Allocator linear;
+    linear_allocator_create(4 * KIB, nullptr, &linear);
+
+    Allocator allocator;
+    allocator_from_linear(&linear, &allocator);
+
+    Auto_Array<u32> array(Memory_Tag::GAME, &allocator);
+    for (u32 i = 0; i < 100; ++i)
+        array.add(i);
+
+    // Every growth extended the block at the top of the allocator, so the
+    // allocator holds exactly the capacity of the array
+    expect_should_be(sizeof(u32) * array.capacity, linear.allocated);
+    expect_should_be(99, array[99]);
+
+    // An allocation after the array forces the next growth to copy
+    void* blocker = allocator.allocate(allocator.state, 16, 16, Memory_Tag::GAME);
+    expect_should_not_be(nullptr, blocker);
+
+    u32* old_data = array.data;
+    u64 target_length = array.capacity + 1;
+    while (array.length < target_length)
+        array.add(array.length);
+
+    expect_should_not_be(old_data, array.data);
+    expect_should_be(50, array[50]);
+
+    // Nothing to release, the space is reclaimed with the whole allocator
+    array.free();
+    expect_should_not_be(0, linear.allocated);
+
+    linear_allocator_destroy(&linear);
+
+    return true;
+}
+
+u8 allocator_should_serve_arrays_from_frames_and_pools() {
+    Frame_Allocator frame;
+    frame_allocator_create(MIB, 1, &frame);
+    frame_allocator_begin_frame(&frame);
+
+    Allocator frame_interface;
+    allocator_from_frame(&frame, &frame_interface);
+
+    Auto_Array<u64> frame_array(Memory_Tag::GAME, &frame_interface);
+    for (u64 i = 0; i < 1000; ++i)
+        frame_array.add(i);
+
+    expect_should_be(sizeof(u64) * frame_array.capacity, frame.frames[0].allocated);
+    expect_should_be(999, frame_array[999]);
+    frame_array.free();
+
+    frame_allocator_destroy(&frame);
+
+    Pool_Allocator pool;
+    pool_allocator_create(256, 4, nullptr, Memory_Tag::GAME, &pool);
+
+    Allocator pool_interface;
+    allocator_from_pool(&pool, &pool_interface);
+
+    // Every array takes a single block of the pool for all its growth
+    Auto_Array<u32> first(Memory_Tag::GAME, &pool_interface);
+    Auto_Array<u32> second(Memory_Tag::GAME, &pool_interface);
+
+    for (u32 i = 0; i < 64; ++i) {
+        first.add(i);
+        second.add(i * 2);
+    }
+
+    expect_should_be(2, pool.allocated_count);
+    expect_should_be(63, first[63]);
+    expect_should_be(126, second[63]);
+
+    first.free();
+    second.free();
+    expect_should_be(0, pool.allocated_count);
+
+    pool_allocator_destroy(&pool);
+
+    return true;
+}
+
+void allocator_register_tests() {
+    test_manager_register_test(
+        allocator_should_account_heap_arrays_under_their_tag,
+        "Allocator interface should account heap arrays under their tag");
+
+    test_manager_register_test(
+        allocator_should_grow_arena_arrays_in_place,
+        "Allocator interface should grow the last array of an arena in place");
+
+    test_manager_register_test(
+        allocator_should_serve_arrays_from_frames_and_pools,
+        "Allocator interface should serve arrays from frame arenas and pools");
+}
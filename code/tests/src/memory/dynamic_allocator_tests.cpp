@@ -0,0 +1,357 @@
+#include "dynamic_allocator_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <core/absolute_clock.hpp>
+#include <memory/dynamic_allocator.hpp>
+#include <platform/platform.hpp>
+
+u8 dynamic_allocator_should_create_and_destroy() {
+    Dynamic_Allocator alloc;
+    b8 result = dynamic_allocator_create(KIB, nullptr, &alloc);
+
+    expect_should_be(true, result);
+    expect_should_not_be(0, alloc.memory);
+    expect_should_be(KIB, alloc.total_size);
+    expect_should_be(0, alloc.allocated);
+
+    Dynamic_Allocator_Stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+
+    // A single free block spanning the memory minus the first header and the
+    // end sentinel
+    expect_should_be(1, stats.free_blocks);
+    expect_should_be(KIB - 2 * DYNAMIC_ALLOCATOR_ALIGNMENT, stats.free_space);
+
+    dynamic_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+    expect_should_be(0, alloc.total_size);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_allocate_aligned_blocks() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(4 * KIB, nullptr, &alloc);
+
+    for (u64 size = 1; size < 100; size += 7) {
+        void* block = dynamic_allocator_allocate(&alloc, size);
+
+        expect_should_not_be(nullptr, block);
+        expect_should_be(0, reinterpret_cast<u64>(block) % DYNAMIC_ALLOCATOR_ALIGNMENT);
+        expect_should_be(true, dynamic_allocator_block_size(block) >= size);
+        expect_should_be(true, dynamic_allocator_owns(&alloc, block));
+    }
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_allocate_over_aligned_blocks() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(16 * KIB, nullptr, &alloc);
+
+    Dynamic_Allocator_Stats initial;
+    dynamic_allocator_get_stats(&alloc, &initial);
+
+    void* blocks[12];
+    u64 alignments[3] = {32, 64, 256};
+
+    for (u32 i = 0; i < 12; ++i) {
+        u64 alignment = alignments[i % 3];
+        blocks[i] = dynamic_allocator_allocate_aligned(&alloc, 24 + i * 8, alignment);
+
+        expect_should_not_be(nullptr, blocks[i]);
+        expect_should_be(0, reinterpret_cast<u64>(blocks[i]) % alignment);
+    }
+
+    for (u32 i = 0; i < 12; ++i)
+        dynamic_allocator_free(&alloc, blocks[i]);
+
+    // The leading gaps split off for the alignment are merged back as well
+    Dynamic_Allocator_Stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+
+    expect_should_be(1, stats.free_blocks);
+    expect_should_be(initial.free_space, stats.free_space);
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_coalesce_free_blocks() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(4 * KIB, nullptr, &alloc);
+
+    Dynamic_Allocator_Stats initial;
+    dynamic_allocator_get_stats(&alloc, &initial);
+
+    void* a = dynamic_allocator_allocate(&alloc, 64);
+    void* b = dynamic_allocator_allocate(&alloc, 128);
+    void* c = dynamic_allocator_allocate(&alloc, 256);
+
+    expect_should_not_be(nullptr, a);
+    expect_should_not_be(nullptr, b);
+    expect_should_not_be(nullptr, c);
+    expect_should_be(3, alloc.allocated_blocks);
+
+    // Freeing out of order must merge every block back in a single one
+    dynamic_allocator_free(&alloc, b);
+    dynamic_allocator_free(&alloc, a);
+    dynamic_allocator_free(&alloc, c);
+
+    Dynamic_Allocator_Stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+
+    expect_should_be(0, alloc.allocated_blocks);
+    expect_should_be(0, alloc.allocated);
+    expect_should_be(1, stats.free_blocks);
+    expect_should_be(initial.free_space, stats.free_space);
+    expect_should_be(initial.free_space, stats.largest_free_block);
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_reuse_freed_hole() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(4 * KIB, nullptr, &alloc);
+
+    void* a = dynamic_allocator_allocate(&alloc, 512);
+    void* b = dynamic_allocator_allocate(&alloc, 64);
+
+    dynamic_allocator_free(&alloc, a);
+
+    // The hole left by the first block is large enough for the request
+    void* c = dynamic_allocator_allocate(&alloc, 256);
+    expect_should_be(a, c);
+
+    dynamic_allocator_free(&alloc, b);
+    dynamic_allocator_free(&alloc, c);
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_resize_in_place() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(4 * KIB, nullptr, &alloc);
+
+    Dynamic_Allocator_Stats initial;
+    dynamic_allocator_get_stats(&alloc, &initial);
+
+    void* a = dynamic_allocator_allocate(&alloc, 64);
+    void* b = dynamic_allocator_allocate(&alloc, 64);
+    void* c = dynamic_allocator_allocate(&alloc, 64);
+
+    // The next block is in use, so a cannot grow
+    expect_should_be(false, dynamic_allocator_resize(&alloc, a, 128));
+    expect_should_be(64, dynamic_allocator_block_size(a));
+
+    // Once b is freed, a takes over its space
+    dynamic_allocator_free(&alloc, b);
+    expect_should_be(true, dynamic_allocator_resize(&alloc, a, 128));
+    expect_should_be(true, dynamic_allocator_block_size(a) >= 128);
+    expect_should_be(dynamic_allocator_block_size(a) + 64, alloc.allocated);
+
+    // The last block grows into the rest of the memory
+    expect_should_be(true, dynamic_allocator_resize(&alloc, c, 2 * KIB));
+    expect_should_be(2 * KIB, dynamic_allocator_block_size(c));
+
+    // Shrinking gives the tail back, merged with the free space after it
+    expect_should_be(true, dynamic_allocator_resize(&alloc, c, 32));
+    expect_should_be(32, dynamic_allocator_block_size(c));
+
+    Dynamic_Allocator_Stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(1, stats.free_blocks);
+
+    // Too large for the space left
+    expect_should_be(false, dynamic_allocator_resize(&alloc, c, 8 * KIB));
+    expect_should_be(32, dynamic_allocator_block_size(c));
+
+    dynamic_allocator_free(&alloc, a);
+    dynamic_allocator_free(&alloc, c);
+
+    dynamic_allocator_get_stats(&alloc, &stats);
+    expect_should_be(0, alloc.allocated);
+    expect_should_be(1, stats.free_blocks);
+    expect_should_be(initial.free_space, stats.free_space);
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_fail_when_full() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(KIB, nullptr, &alloc);
+
+    void* block = dynamic_allocator_allocate(&alloc, 2 * KIB);
+    expect_should_be(nullptr, block);
+
+    // Fill the allocator with small blocks until it runs out of space
+    u64 count = 0;
+    while (dynamic_allocator_allocate(&alloc, 32))
+        ++count;
+
+    expect_should_not_be(0, count);
+    expect_should_be(count, alloc.allocated_blocks);
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 dynamic_allocator_should_reject_foreign_block() {
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(KIB, nullptr, &alloc);
+
+    void* block = dynamic_allocator_allocate(&alloc, 32);
+
+    u64 foreign[4] = {};
+    expect_should_be(false, dynamic_allocator_owns(&alloc, &foreign[2]));
+
+    ENGINE_DEBUG("Note: The following errors are intentionally caused by the test");
+    dynamic_allocator_free(&alloc, &foreign[2]);
+    dynamic_allocator_free(&alloc, block);
+    dynamic_allocator_free(&alloc, block);
+
+    expect_should_be(0, alloc.allocated_blocks);
+
+    dynamic_allocator_destroy(&alloc);
+
+    return true;
+}
+
+// Simple deterministic generator so that both allocators replay the exact
+// same sequence of operations
+internal u32 benchmark_next_random(u32* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+u8 dynamic_allocator_benchmark_against_malloc() {
+    constexpr u64 SLOT_COUNT = 1024;
+    constexpr u64 OPERATION_COUNT = 200000;
+    constexpr u64 MAX_BLOCK_SIZE = 4 * KIB;
+
+    void* slots[SLOT_COUNT] = {};
+
+    Dynamic_Allocator alloc;
+    dynamic_allocator_create(SLOT_COUNT * MAX_BLOCK_SIZE * 2, nullptr, &alloc);
+
+    // Random mix of allocations and frees over a bounded live set, which is
+    // the usual churn of the engine transient allocations
+    u32 seed = 42;
+    Absolute_Clock clock;
+    absolute_clock_start(&clock);
+
+    for (u64 i = 0; i < OPERATION_COUNT; ++i) {
+        u32 random = benchmark_next_random(&seed);
+        u64 slot = random % SLOT_COUNT;
+
+        if (slots[slot]) {
+            dynamic_allocator_free(&alloc, slots[slot]);
+            slots[slot] = nullptr;
+        } else {
+            slots[slot] = dynamic_allocator_allocate(&alloc, 1 + random % MAX_BLOCK_SIZE);
+            expect_should_not_be(nullptr, slots[slot]);
+        }
+    }
+
+    absolute_clock_update(&clock);
+    f64 dynamic_time = clock.elapsed_time;
+
+    Dynamic_Allocator_Stats stats;
+    dynamic_allocator_get_stats(&alloc, &stats);
+
+    for (u64 i = 0; i < SLOT_COUNT; ++i)
+        if (slots[i]) {
+            dynamic_allocator_free(&alloc, slots[i]);
+            slots[i] = nullptr;
+        }
+
+    dynamic_allocator_destroy(&alloc);
+
+    seed = 42;
+    absolute_clock_start(&clock);
+
+    for (u64 i = 0; i < OPERATION_COUNT; ++i) {
+        u32 random = benchmark_next_random(&seed);
+        u64 slot = random % SLOT_COUNT;
+
+        if (slots[slot]) {
+            platform_free(slots[slot], 0);
+            slots[slot] = nullptr;
+        } else {
+            slots[slot] = platform_allocate(1 + random % MAX_BLOCK_SIZE, 0);
+        }
+    }
+
+    absolute_clock_update(&clock);
+    f64 platform_time = clock.elapsed_time;
+
+    for (u64 i = 0; i < SLOT_COUNT; ++i)
+        if (slots[i])
+            platform_free(slots[i], 0);
+
+    absolute_clock_stop(&clock);
+
+    ENGINE_INFO(
+        "Dynamic allocator: %llu ops in %.6f sec, platform allocator: %.6f sec (%.2fx)",
+        OPERATION_COUNT,
+        dynamic_time,
+        platform_time,
+        dynamic_time > 0 ? platform_time / dynamic_time : 0.0);
+
+    ENGINE_INFO(
+        "Dynamic allocator fragmentation after the run: %llu free blocks, largest %llu of %llu free bytes",
+        stats.free_blocks,
+        stats.largest_free_block,
+        stats.free_space);
+
+    return true;
+}
+
+void dynamic_allocator_register_tests() {
+    test_manager_register_test(
+        dynamic_allocator_should_create_and_destroy,
+        "Dynamic allocator should create and destroy");
+
+    test_manager_register_test(
+        dynamic_allocator_should_allocate_aligned_blocks,
+        "Dynamic allocator should allocate aligned blocks of at least the requested size");
+
+    test_manager_register_test(
+        dynamic_allocator_should_allocate_over_aligned_blocks,
+        "Dynamic allocator should allocate over aligned blocks");
+
+    test_manager_register_test(
+        dynamic_allocator_should_coalesce_free_blocks,
+        "Dynamic allocator should coalesce adjacent free blocks");
+
+    test_manager_register_test(
+        dynamic_allocator_should_reuse_freed_hole,
+        "Dynamic allocator should reuse the space of freed blocks");
+
+    test_manager_register_test(
+        dynamic_allocator_should_resize_in_place,
+        "Dynamic allocator should resize blocks in place");
+
+    test_manager_register_test(
+        dynamic_allocator_should_fail_when_full,
+        "Dynamic allocator should not allocate more than the space available");
+
+    test_manager_register_test(
+        dynamic_allocator_should_reject_foreign_block,
+        "Dynamic allocator should not free foreign or already freed blocks");
+
+    test_manager_register_test(
+        dynamic_allocator_benchmark_against_malloc,
+        "Dynamic allocator benchmark against the platform allocator");
+}
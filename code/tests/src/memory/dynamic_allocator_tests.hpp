@@ -0,0 +1,3 @@
+#pragma once
+
+void dynamic_allocator_register_tests();
@@ -0,0 +1,209 @@
+#include "frame_allocator_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <containers/auto_array.hpp>
+#include <core/event.hpp>
+#include <core/input.hpp>
+#include <core/memory.hpp>
+#include <game_types.hpp>
+#include <memory/allocator.hpp>
+#include <memory/frame_allocator.hpp>
+#include <memory/relocatable_heap.hpp>
+
+u8 frame_allocator_should_keep_blocks_for_frames_in_flight() {
+    Frame_Allocator allocator;
+    b8 result = frame_allocator_create(MIB, 2, &allocator);
+    expect_should_be(true, result);
+    expect_should_be(2, allocator.frame_count);
+
+    frame_allocator_begin_frame(&allocator);
+    u64* first = static_cast<u64*>(frame_allocator_allocate(&allocator, sizeof(u64)));
+    *first = 42;
+
+    // The next frame uses the other arena, so the block is still intact
+    frame_allocator_begin_frame(&allocator);
+    u64* second = static_cast<u64*>(frame_allocator_allocate(&allocator, sizeof(u64)));
+    expect_should_not_be(first, second);
+    expect_should_be(42, *first);
+
+    // Two frames later the first arena is reused and reset
+    frame_allocator_begin_frame(&allocator);
+    u64* third = static_cast<u64*>(frame_allocator_allocate(&allocator, sizeof(u64)));
+    expect_should_be(first, third);
+    expect_should_be(0, *third);
+
+    frame_allocator_destroy(&allocator);
+    expect_should_be(0, allocator.frame_count);
+
+    return true;
+}
+
+u8 frame_allocator_should_reject_invalid_frame_count() {
+    Frame_Allocator allocator;
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    expect_should_be(false, frame_allocator_create(MIB, FRAME_ALLOCATOR_MAX_FRAMES + 1, &allocator));
+
+    return true;
+}
+
+struct Frame_Test_Game_State {
+    Frame_Allocator frame_allocator;
+    Allocator frame_allocator_interface;
+    Relocatable_Heap relocatable_heap;
+    Relocatable_Handle resources[8];
+    u32 key_events;
+};
+
+internal b8 frame_test_on_key(Event_Code code, void* sender, void* listener_inst, Event_Context context) {
+    static_cast<Frame_Test_Game_State*>(listener_inst)->key_events++;
+    return false;
+}
+
+// Stand-in for a game: reads the frame statistics and the input, builds
+// temporary arrays in the frame memory, resolves the movable resources and
+// writes the memory report when a key is released. It is not the testbed game,
+// whose update needs a running application, so the test covers the engine
+// systems a frame goes through and not testbed/src/game.cpp
+internal b8 frame_test_game_update(Game* game_inst, f32 delta_time) {
+    Frame_Test_Game_State* state = static_cast<Frame_Test_Game_State*>(game_inst->state);
+
+    Memory_Frame_Stats frame_stats;
+    memory_get_frame_stats(&frame_stats);
+
+    Auto_Array<f32> positions(Memory_Tag::GAME, &state->frame_allocator_interface);
+    for (u32 i = 0; i < 64 + (frame_stats.frame_index % 16) * 8; ++i)
+        positions.add(static_cast<f32>(i) * delta_time);
+
+    for (u32 i = 0; i < 8; ++i) {
+        f32* resource = static_cast<f32*>(relocatable_heap_resolve(&state->relocatable_heap, state->resources[i]));
+        resource[0] = positions[i];
+    }
+
+    if (input_is_key_up(Keyboard_Key::M) &&
+        input_was_key_down(Keyboard_Key::M)) {
+
+        char* usage = static_cast<char*>(frame_allocator_allocate(
+            &state->frame_allocator,
+            MEMORY_USAGE_STRING_SIZE));
+
+        memory_get_current_usage(usage, MEMORY_USAGE_STRING_SIZE);
+    }
+
+    return true;
+}
+
+internal b8 frame_test_game_render(Game* game_inst, f32 delta_time) {
+    Frame_Test_Game_State* state = static_cast<Frame_Test_Game_State*>(game_inst->state);
+
+    // Draw list of the frame, dropped without being freed
+    Auto_Array<u32> draw_list(Memory_Tag::RENDERER, &state->frame_allocator_interface);
+    for (u32 i = 0; i < 8; ++i)
+        draw_list.add(i);
+
+    return true;
+}
+
+u8 frame_allocator_steady_state_frames_should_not_allocate() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    void* state = memory_tests_startup(&config);
+
+    u64 event_state_size = 0;
+    event_startup(&event_state_size, nullptr);
+    void* event_state = memory_allocate(event_state_size, Memory_Tag::APPLICATION);
+    event_startup(&event_state_size, event_state);
+
+    u64 input_state_size = 0;
+    input_startup(&input_state_size, nullptr);
+    void* input_state = memory_allocate(input_state_size, Memory_Tag::APPLICATION);
+    input_startup(&input_state_size, input_state);
+
+    Frame_Test_Game_State game_state = {};
+    frame_allocator_create(MIB, 2, &game_state.frame_allocator);
+    allocator_from_frame(&game_state.frame_allocator, &game_state.frame_allocator_interface);
+    relocatable_heap_create(MIB, 64, &game_state.relocatable_heap);
+
+    // Freeing every other block leaves holes for the compaction of the frames
+    Relocatable_Handle padding[8];
+    for (u32 i = 0; i < 8; ++i) {
+        padding[i] = relocatable_heap_allocate(&game_state.relocatable_heap, 256);
+        game_state.resources[i] = relocatable_heap_allocate(&game_state.relocatable_heap, 256);
+    }
+    for (u32 i = 0; i < 8; ++i)
+        relocatable_heap_free(&game_state.relocatable_heap, padding[i]);
+
+    event_register_listener(Event_Code::KEY_PRESSED, &game_state, frame_test_on_key);
+    event_register_listener(Event_Code::KEY_RELEASED, &game_state, frame_test_on_key);
+
+    Game game = {};
+    game.update = frame_test_game_update;
+    game.render = frame_test_game_render;
+    game.state = &game_state;
+
+    constexpr u32 warm_up_frames = 4;
+    u64 allocations_after_warm_up = 0;
+
+    for (u32 frame = 0; frame < 120; ++frame) {
+        if (frame == warm_up_frames)
+            allocations_after_warm_up = memory_get_allocations_count();
+
+        // What the platform layer feeds in between two frames
+        if (frame % 10 == 0)
+            input_process_key(Keyboard_Key::M, 0, frame % 20 == 0);
+
+        // Steps of application_run copied in the same order, without the
+        // renderer
+        frame_allocator_begin_frame(&game_state.frame_allocator);
+        relocatable_heap_compact(&game_state.relocatable_heap, KIB);
+
+        expect_should_be(true, game.update(&game, 1.0f / 60.0f));
+        expect_should_be(true, game.render(&game, 1.0f / 60.0f));
+
+        memory_end_frame();
+        input_update(1.0 / 60.0);
+
+        if (frame < warm_up_frames)
+            continue;
+
+        Memory_Frame_Stats frame_stats;
+        memory_get_frame_stats(&frame_stats);
+        expect_should_be(0, frame_stats.allocation_count);
+        expect_should_be(0, frame_stats.bytes_delta);
+    }
+
+    // The report and the compaction ran, and none of it reached the heap
+    expect_should_be(12, game_state.key_events);
+    expect_should_be(0, relocatable_heap_free_bytes(&game_state.relocatable_heap));
+    expect_should_be(allocations_after_warm_up, memory_get_allocations_count());
+
+    event_unregister_listener(Event_Code::KEY_PRESSED, &game_state, frame_test_on_key);
+    event_unregister_listener(Event_Code::KEY_RELEASED, &game_state, frame_test_on_key);
+
+    relocatable_heap_destroy(&game_state.relocatable_heap);
+    frame_allocator_destroy(&game_state.frame_allocator);
+
+    input_shutdown(input_state);
+    memory_deallocate(input_state, input_state_size, Memory_Tag::APPLICATION);
+    event_shutdown(event_state);
+    memory_deallocate(event_state, event_state_size, Memory_Tag::APPLICATION);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+void frame_allocator_register_tests() {
+    test_manager_register_test(
+        frame_allocator_should_keep_blocks_for_frames_in_flight,
+        "Frame allocator should keep the blocks for the frames in flight");
+
+    test_manager_register_test(
+        frame_allocator_should_reject_invalid_frame_count,
+        "Frame allocator should reject an invalid frame count");
+
+    test_manager_register_test(
+        frame_allocator_steady_state_frames_should_not_allocate,
+        "Steady state frames should not perform heap allocations");
+}
@@ -0,0 +1,232 @@
+#include "guard_allocator_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include "../core/memory_tests.hpp"
+#include <core/memory.hpp>
+#include <memory/guard_allocator.hpp>
+#include <platform/platform.hpp>
+
+#ifdef ENGINE_PLATFORM_LINUX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+constexpr u64 GUARD_TEST_RESERVE_SIZE = 64 * MIB;
+
+internal void* guard_test_memory = nullptr;
+
+internal b8 guard_test_create(Memory_Guard_Mode mode, Guard_Allocator* out_allocator) {
+    guard_test_memory = platform_allocate(
+        guard_allocator_memory_requirement(GUARD_TEST_RESERVE_SIZE),
+        0);
+
+    return guard_allocator_create(
+        GUARD_TEST_RESERVE_SIZE,
+        mode,
+        guard_test_memory,
+        out_allocator);
+}
+
+internal void guard_test_destroy(Guard_Allocator* allocator) {
+    guard_allocator_destroy(allocator);
+    platform_free(guard_test_memory, 0);
+    guard_test_memory = nullptr;
+}
+
+u8 guard_allocator_overrun_block_should_end_at_guard_page() {
+    Guard_Allocator allocator;
+    expect_should_be(true, guard_test_create(Memory_Guard_Mode::OVERRUN, &allocator));
+
+    u64 page_size = platform_get_page_size();
+
+    u8* block = static_cast<u8*>(guard_allocator_allocate(&allocator, 64, 16));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(0, reinterpret_cast<u64>(block + 64) % page_size);
+    expect_should_be(true, guard_allocator_owns(&allocator, block));
+
+    // The whole block is usable
+    memory_set(block, 0xAB, 64);
+    expect_should_be(0xAB, block[63]);
+
+    // Sizes that are not a multiple of the alignment end within it
+    u8* odd = static_cast<u8*>(guard_allocator_allocate(&allocator, 13, 16));
+    expect_should_be(16, page_size - reinterpret_cast<u64>(odd) % page_size);
+
+    // A block larger than a page spans several data pages
+    u8* large = static_cast<u8*>(guard_allocator_allocate(&allocator, page_size + 1, 16));
+    expect_should_not_be(nullptr, large);
+    memory_set(large, 1, page_size + 1);
+    expect_should_be(2 * page_size, guard_allocator_block_size(&allocator, page_size + 1));
+
+    expect_should_be(3, allocator.allocated_blocks);
+    expect_should_be(7, allocator.allocated_pages);
+
+    guard_allocator_free(&allocator, block, 64);
+    guard_allocator_free(&allocator, odd, 13);
+    guard_allocator_free(&allocator, large, page_size + 1);
+    expect_should_be(0, allocator.allocated_blocks);
+    expect_should_be(0, allocator.allocated_pages);
+
+    guard_test_destroy(&allocator);
+
+    return true;
+}
+
+u8 guard_allocator_underrun_block_should_start_after_guard_page() {
+    Guard_Allocator allocator;
+    expect_should_be(true, guard_test_create(Memory_Guard_Mode::UNDERRUN, &allocator));
+
+    u64 page_size = platform_get_page_size();
+
+    u8* block = static_cast<u8*>(guard_allocator_allocate(&allocator, 100, 16));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(0, reinterpret_cast<u64>(block) % page_size);
+    expect_should_be(allocator.memory + page_size, block);
+
+    guard_allocator_free(&allocator, block, 100);
+    expect_should_be(0, allocator.allocated_pages);
+
+    guard_test_destroy(&allocator);
+
+    return true;
+}
+
+u8 guard_allocator_should_delay_reuse_of_freed_pages() {
+    Guard_Allocator allocator;
+    expect_should_be(true, guard_test_create(Memory_Guard_Mode::OVERRUN, &allocator));
+
+    void* first = guard_allocator_allocate(&allocator, 32, 16);
+    guard_allocator_free(&allocator, first, 32);
+
+    // The next-fit search moves on instead of handing the same pages back
+    void* second = guard_allocator_allocate(&allocator, 32, 16);
+    expect_should_not_be(first, second);
+    guard_allocator_free(&allocator, second, 32);
+
+    // Once the whole range is cycled through the pages are reused. Each block
+    // takes a data page and a guard page, and two blocks were already placed
+    u64 blocks_in_range = allocator.page_count / 2;
+    void* block = nullptr;
+    for (u64 i = 0; i < blocks_in_range - 2; ++i) {
+        block = guard_allocator_allocate(&allocator, 32, 16);
+        guard_allocator_free(&allocator, block, 32);
+    }
+
+    block = guard_allocator_allocate(&allocator, 32, 16);
+    expect_should_be(first, block);
+    guard_allocator_free(&allocator, block, 32);
+
+    guard_test_destroy(&allocator);
+
+    return true;
+}
+
+u8 guard_allocator_should_fail_when_range_is_full() {
+    Guard_Allocator allocator;
+    expect_should_be(true, guard_test_create(Memory_Guard_Mode::OVERRUN, &allocator));
+
+    u64 page_size = platform_get_page_size();
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    expect_should_be(nullptr, guard_allocator_allocate(&allocator, GUARD_TEST_RESERVE_SIZE, 16));
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    expect_should_be(nullptr, guard_allocator_allocate(&allocator, 16, page_size * 2));
+
+    guard_test_destroy(&allocator);
+
+    return true;
+}
+
+#ifdef ENGINE_PLATFORM_LINUX
+// Runs the access in a child process and reports whether it crashed
+internal b8 guard_test_access_faults(u8* address) {
+    pid_t child = fork();
+    if (child == 0) {
+        *reinterpret_cast<volatile u8*>(address) = 1;
+        _exit(0);
+    }
+
+    s32 status = 0;
+    waitpid(child, &status, 0);
+
+    return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+u8 guard_allocator_should_fault_on_overrun_and_use_after_free() {
+    Guard_Allocator allocator;
+    expect_should_be(true, guard_test_create(Memory_Guard_Mode::OVERRUN, &allocator));
+
+    u8* block = static_cast<u8*>(guard_allocator_allocate(&allocator, 64, 16));
+    expect_should_be(false, guard_test_access_faults(block + 63));
+    expect_should_be(true, guard_test_access_faults(block + 64));
+
+    guard_allocator_free(&allocator, block, 64);
+    expect_should_be(true, guard_test_access_faults(block));
+
+    guard_test_destroy(&allocator);
+
+    return true;
+}
+#endif
+
+u8 guard_pages_mode_should_serve_memory_allocate() {
+    Memory_System_Config config = {};
+    config.heap_size = MIB;
+    config.guard_mode = Memory_Guard_Mode::OVERRUN;
+    config.guard_reserve_size = GUARD_TEST_RESERVE_SIZE;
+
+    void* state = memory_tests_startup(&config);
+
+    u64 page_size = platform_get_page_size();
+
+    u8* block = static_cast<u8*>(memory_allocate(48, Memory_Tag::GAME));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(0, reinterpret_cast<u64>(block + 48) % page_size);
+    expect_should_be(0, block[0]);
+
+    Memory_Stats stats;
+    memory_get_stats(&stats);
+    // The guard allocator replaces the heap
+    expect_should_be(0, stats.heap_size);
+    expect_should_be(48, stats.tags[(u64)Memory_Tag::GAME].allocated);
+    expect_should_be(page_size - 48, stats.tags[(u64)Memory_Tag::GAME].heap_overhead);
+
+    memory_deallocate(block, 48, Memory_Tag::GAME);
+
+    memory_get_stats(&stats);
+    expect_should_be(0, stats.tags[(u64)Memory_Tag::GAME].allocated);
+    expect_should_be(0, stats.tags[(u64)Memory_Tag::GAME].heap_overhead);
+
+    memory_tests_shutdown(state);
+
+    return true;
+}
+
+void guard_allocator_register_tests() {
+    test_manager_register_test(
+        guard_allocator_overrun_block_should_end_at_guard_page,
+        "Guard allocator overrun blocks should end at the guard page");
+
+    test_manager_register_test(
+        guard_allocator_underrun_block_should_start_after_guard_page,
+        "Guard allocator underrun blocks should start after the guard page");
+
+    test_manager_register_test(
+        guard_allocator_should_delay_reuse_of_freed_pages,
+        "Guard allocator should delay the reuse of freed pages");
+
+    test_manager_register_test(
+        guard_allocator_should_fail_when_range_is_full,
+        "Guard allocator should fail when the range is full");
+
+#ifdef ENGINE_PLATFORM_LINUX
+    test_manager_register_test(
+        guard_allocator_should_fault_on_overrun_and_use_after_free,
+        "Guard allocator should fault on overruns and use after free");
+#endif
+
+    test_manager_register_test(
+        guard_pages_mode_should_serve_memory_allocate,
+        "Guard pages mode should serve memory_allocate");
+}
@@ -0,0 +1,3 @@
+#pragma once
+
+void guard_allocator_register_tests();
@@ -1,6 +1,8 @@
 #include "linear_allocator_tests.hpp"
 #include "../expect.hpp"
 #include "../test_manager.hpp"
+#include <core/absolute_clock.hpp>
+#include <core/memory.hpp>
 #include <memory/linear_allocator.hpp>
 
 u8 linear_allocator_should_create_and_destroy() {
@@ -128,6 +130,115 @@ u8 linear_allocator_allocate_all_free_all() {
     return true;
 }
 
+u8 linear_allocator_should_align_allocations() {
+    Linear_Allocator alloc;
+
+    linear_allocator_create(KIB, nullptr, &alloc);
+
+    // Odd sized allocation to misalign the top of the allocator
+    void* block = linear_allocator_allocate(&alloc, 3);
+    expect_should_not_be(nullptr, block);
+    expect_should_be(3, alloc.allocated);
+
+    // Natural alignment deduced from the size
+    block = linear_allocator_allocate(&alloc, sizeof(u64));
+    expect_should_be(0, reinterpret_cast<u64>(block) % sizeof(u64));
+
+    block = linear_allocator_allocate(&alloc, 48);
+    expect_should_be(0, reinterpret_cast<u64>(block) % MEMORY_DEFAULT_ALIGNMENT);
+
+    block = linear_allocator_allocate_aligned(&alloc, 1, 64);
+    expect_should_be(0, reinterpret_cast<u64>(block) % 64);
+
+    linear_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 linear_allocator_free_all_should_zero_used_range() {
+    Linear_Allocator alloc;
+
+    linear_allocator_create(KIB, nullptr, &alloc);
+
+    u8* block = static_cast<u8*>(linear_allocator_allocate(&alloc, 64));
+    memory_set(block, 0xFF, 64);
+
+    linear_allocator_free_all(&alloc);
+
+    // The allocations after a reset must still see zeroed memory
+    block = static_cast<u8*>(linear_allocator_allocate(&alloc, KIB));
+    for (u64 i = 0; i < KIB; ++i)
+        expect_should_be(0, block[i]);
+
+    linear_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 linear_allocator_should_zero_caller_memory() {
+    u8 memory[256];
+    memory_set(memory, 0xFF, sizeof(memory));
+
+    Linear_Allocator alloc;
+    linear_allocator_create(sizeof(memory), memory, &alloc);
+
+    u8* block = static_cast<u8*>(linear_allocator_allocate(&alloc, 64));
+    memory_set(block, 0xFF, 64);
+
+    linear_allocator_free_all(&alloc);
+
+    // Past the used range too, which free_all does not clear
+    block = static_cast<u8*>(linear_allocator_allocate(&alloc, sizeof(memory)));
+    for (u64 i = 0; i < sizeof(memory); ++i)
+        expect_should_be(0, block[i]);
+
+    linear_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 linear_allocator_free_all_benchmark() {
+    u64 total_size = 64 * MIB;
+    u64 used_size = 64 * KIB;
+    u32 iterations = 64;
+
+    Linear_Allocator alloc;
+    linear_allocator_create(total_size, nullptr, &alloc);
+
+    Absolute_Clock clock;
+    absolute_clock_start(&clock);
+
+    for (u32 i = 0; i < iterations; ++i) {
+        linear_allocator_allocate(&alloc, used_size);
+        linear_allocator_free_all(&alloc);
+    }
+
+    absolute_clock_update(&clock);
+    f64 used_range_time = clock.elapsed_time;
+
+    // Reference: clearing the whole backing memory on each reset
+    absolute_clock_start(&clock);
+
+    for (u32 i = 0; i < iterations; ++i)
+        memory_zero(alloc.memory, alloc.total_size);
+
+    absolute_clock_update(&clock);
+    f64 full_range_time = clock.elapsed_time;
+    absolute_clock_stop(&clock);
+
+    ENGINE_INFO(
+        "Linear allocator free_all: %llu bytes written instead of %llu per reset (%.6f sec vs %.6f sec for %u resets)",
+        used_size,
+        total_size,
+        used_range_time,
+        full_range_time,
+        iterations);
+
+    linear_allocator_destroy(&alloc);
+
+    return true;
+}
+
 void linear_allocator_register_tests() {
     test_manager_register_test(
         linear_allocator_should_create_and_destroy,
@@ -148,4 +259,20 @@ void linear_allocator_register_tests() {
     test_manager_register_test(
         linear_allocator_allocate_all_free_all,
         "Linear allocator should allocate all space with multiple allocations and free all space back");
+
+    test_manager_register_test(
+        linear_allocator_should_align_allocations,
+        "Linear allocator should align the allocations");
+
+    test_manager_register_test(
+        linear_allocator_free_all_should_zero_used_range,
+        "Linear allocator should hand out zeroed memory after free all");
+
+    test_manager_register_test(
+        linear_allocator_should_zero_caller_memory,
+        "Linear allocator should zero the memory given by the caller");
+
+    test_manager_register_test(
+        linear_allocator_free_all_benchmark,
+        "Linear allocator free all should only clear the used range");
 }
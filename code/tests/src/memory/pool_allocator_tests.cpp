@@ -0,0 +1,259 @@
+#include "pool_allocator_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <memory/pool_allocator.hpp>
+
+u8 pool_allocator_should_create_and_destroy() {
+    Pool_Allocator alloc;
+    pool_allocator_create(sizeof(u64), 16, nullptr, Memory_Tag::POOL_ALLOCATOR, &alloc);
+
+    expect_should_not_be(0, alloc.memory);
+    expect_should_be(sizeof(u64), alloc.block_size);
+    expect_should_be(16, alloc.block_count);
+    expect_should_be(0, alloc.allocated_count);
+    expect_should_be(alloc.memory, alloc.free_list);
+
+    pool_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+    expect_should_be(0, alloc.free_list);
+    expect_should_be(0, alloc.block_size);
+    expect_should_be(0, alloc.block_count);
+
+    return true;
+}
+
+u8 pool_allocator_should_round_up_small_blocks() {
+    Pool_Allocator alloc;
+    pool_allocator_create(3, 4, nullptr, Memory_Tag::POOL_ALLOCATOR, &alloc);
+
+    // The blocks must be able to hold the free list pointer
+    expect_should_be(sizeof(void*), alloc.block_size);
+    expect_should_be(sizeof(void*) * 4, pool_allocator_memory_requirement(3, 4));
+
+    pool_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 pool_allocator_allocate_all_blocks() {
+    u64 block_count = 1024;
+    Pool_Allocator alloc;
+
+    pool_allocator_create(
+        sizeof(u64),
+        block_count,
+        nullptr,
+        Memory_Tag::POOL_ALLOCATOR,
+        &alloc);
+
+    void* block;
+
+    // Blocks are handed out in address order on a freshly created pool
+    for (u64 i = 0; i < block_count; ++i) {
+        block = pool_allocator_allocate(&alloc);
+
+        expect_should_not_be(nullptr, block);
+        expect_should_be(static_cast<u8*>(alloc.memory) + i * sizeof(u64), block);
+        expect_should_be(i + 1, alloc.allocated_count);
+    }
+
+    expect_should_be(nullptr, alloc.free_list);
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    block = pool_allocator_allocate(&alloc);
+    expect_should_be(nullptr, block);
+    expect_should_be(block_count, alloc.allocated_count);
+
+    pool_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 pool_allocator_should_reuse_freed_block() {
+    Pool_Allocator alloc;
+
+    pool_allocator_create(32, 8, nullptr, Memory_Tag::POOL_ALLOCATOR, &alloc);
+
+    void* first = pool_allocator_allocate(&alloc);
+    void* second = pool_allocator_allocate(&alloc);
+    void* third = pool_allocator_allocate(&alloc);
+
+    expect_should_not_be(nullptr, first);
+    expect_should_not_be(nullptr, second);
+    expect_should_not_be(nullptr, third);
+    expect_should_be(3, alloc.allocated_count);
+
+    // The last freed block is the first one to be handed out again
+    pool_allocator_free(&alloc, second);
+    expect_should_be(2, alloc.allocated_count);
+
+    void* reused = pool_allocator_allocate(&alloc);
+    expect_should_be(second, reused);
+    expect_should_be(3, alloc.allocated_count);
+
+    pool_allocator_free(&alloc, first);
+    pool_allocator_free(&alloc, third);
+    pool_allocator_free(&alloc, reused);
+    expect_should_be(0, alloc.allocated_count);
+
+    pool_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 pool_allocator_should_reject_foreign_block() {
+    Pool_Allocator alloc;
+
+    pool_allocator_create(sizeof(u64), 4, nullptr, Memory_Tag::POOL_ALLOCATOR, &alloc);
+
+    void* block = pool_allocator_allocate(&alloc);
+    void* free_list = alloc.free_list;
+
+    ENGINE_DEBUG("Note: The following errors are intentionally caused by the test");
+    u64 foreign = 0;
+    pool_allocator_free(&alloc, &foreign);
+    pool_allocator_free(&alloc, static_cast<u8*>(block) + 1);
+
+    expect_should_be(1, alloc.allocated_count);
+    expect_should_be(free_list, alloc.free_list);
+
+    pool_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 pool_allocator_should_reject_double_free() {
+    Pool_Allocator alloc;
+
+    pool_allocator_create(sizeof(u64), 4, nullptr, Memory_Tag::POOL_ALLOCATOR, &alloc);
+
+    void* first = pool_allocator_allocate(&alloc);
+    pool_allocator_free(&alloc, first);
+
+    // Nothing is allocated, so the second free is refused in every build
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    pool_allocator_free(&alloc, first);
+    expect_should_be(0, alloc.allocated_count);
+    expect_should_be(first, alloc.free_list);
+
+#ifdef DEBUG_BUILD
+    first = pool_allocator_allocate(&alloc);
+    void* second = pool_allocator_allocate(&alloc);
+    pool_allocator_free(&alloc, first);
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    pool_allocator_free(&alloc, first);
+    expect_should_be(1, alloc.allocated_count);
+
+    // The free list was not turned into a cycle
+    expect_should_be(first, pool_allocator_allocate(&alloc));
+    expect_should_not_be(first, pool_allocator_allocate(&alloc));
+    expect_should_not_be(second, alloc.free_list);
+#endif
+
+    pool_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 pool_allocator_should_align_blocks_naturally() {
+    Pool_Allocator alloc;
+
+    // A matrix of 16 floats gets blocks aligned for SIMD loads
+    pool_allocator_create(64, 4, nullptr, Memory_Tag::POOL_ALLOCATOR, &alloc);
+    expect_should_be(64, alloc.block_size);
+
+    for (u32 i = 0; i < 4; ++i)
+        expect_should_be(0, reinterpret_cast<u64>(pool_allocator_allocate(&alloc)) % 16);
+
+    pool_allocator_destroy(&alloc);
+
+    // Odd sizes are padded to the next multiple of their alignment
+    expect_should_be(16 * 4, pool_allocator_memory_requirement(12, 4));
+    expect_should_be(24 * 4, pool_allocator_memory_requirement(20, 4));
+    expect_should_be(80 * 4, pool_allocator_memory_requirement(80, 4));
+
+    return true;
+}
+
+u8 pool_allocator_allocate_all_free_all() {
+    u64 block_count = 64;
+    Pool_Allocator alloc;
+
+    pool_allocator_create(
+        sizeof(u64),
+        block_count,
+        nullptr,
+        Memory_Tag::POOL_ALLOCATOR,
+        &alloc);
+
+    for (u64 i = 0; i < block_count; ++i) {
+        void* block = pool_allocator_allocate(&alloc);
+        expect_should_not_be(nullptr, block);
+    }
+
+    pool_allocator_free_all(&alloc);
+    expect_should_be(0, alloc.allocated_count);
+    expect_should_be(alloc.memory, alloc.free_list);
+
+    pool_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 pool_allocator_should_use_provided_memory() {
+    u64 backing[8];
+    Pool_Allocator alloc;
+
+    pool_allocator_create(sizeof(u64), 8, backing, Memory_Tag::POOL_ALLOCATOR, &alloc);
+
+    expect_should_be(backing, alloc.memory);
+    expect_should_be(false, alloc.owns_memory);
+
+    void* block = pool_allocator_allocate(&alloc);
+    expect_should_be(backing, block);
+
+    pool_allocator_destroy(&alloc);
+    expect_should_be(0, alloc.memory);
+
+    return true;
+}
+
+void pool_allocator_register_tests() {
+    test_manager_register_test(
+        pool_allocator_should_create_and_destroy,
+        "Pool allocator should create and destroy");
+
+    test_manager_register_test(
+        pool_allocator_should_round_up_small_blocks,
+        "Pool allocator should round blocks up to hold the free list pointer");
+
+    test_manager_register_test(
+        pool_allocator_allocate_all_blocks,
+        "Pool allocator should allocate all blocks and fail when exhausted");
+
+    test_manager_register_test(
+        pool_allocator_should_reuse_freed_block,
+        "Pool allocator should hand out freed blocks again");
+
+    test_manager_register_test(
+        pool_allocator_should_reject_foreign_block,
+        "Pool allocator should not accept blocks it does not own");
+
+    test_manager_register_test(
+        pool_allocator_should_reject_double_free,
+        "Pool allocator should not accept blocks that are already free");
+
+    test_manager_register_test(
+        pool_allocator_should_align_blocks_naturally,
+        "Pool allocator should align blocks to their natural alignment");
+
+    test_manager_register_test(
+        pool_allocator_allocate_all_free_all,
+        "Pool allocator should allocate all blocks and free all blocks back");
+
+    test_manager_register_test(
+        pool_allocator_should_use_provided_memory,
+        "Pool allocator should use externally provided memory");
+}
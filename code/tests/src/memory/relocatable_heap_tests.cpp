@@ -0,0 +1,153 @@
+#include "relocatable_heap_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <core/memory.hpp>
+#include <memory/relocatable_heap.hpp>
+
+// Fills the block with a pattern derived from the seed
+internal void fill_block(void* block, u64 size, u8 seed) {
+    u8* bytes = static_cast<u8*>(block);
+    for (u64 i = 0; i < size; ++i)
+        bytes[i] = static_cast<u8>(seed + i);
+}
+
+internal b8 check_block(void* block, u64 size, u8 seed) {
+    u8* bytes = static_cast<u8*>(block);
+    for (u64 i = 0; i < size; ++i) {
+        if (bytes[i] != static_cast<u8>(seed + i))
+            return false;
+    }
+    return true;
+}
+
+u8 relocatable_heap_should_resolve_handles() {
+    Relocatable_Heap heap;
+    expect_should_be(true, relocatable_heap_create(MIB, 16, &heap));
+
+    Relocatable_Handle a = relocatable_heap_allocate(&heap, 100);
+    Relocatable_Handle b = relocatable_heap_allocate(&heap, 1);
+
+    u8* block = static_cast<u8*>(relocatable_heap_resolve(&heap, a));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(0, reinterpret_cast<u64>(block) % 16);
+    expect_should_be(0, block[99]);
+    expect_should_be(112, relocatable_heap_block_size(&heap, a));
+    expect_should_be(2, heap.live_blocks);
+
+    // The handle of a freed block goes stale, even once its slot is reused
+    relocatable_heap_free(&heap, a);
+    expect_should_be(nullptr, relocatable_heap_resolve(&heap, a));
+
+    Relocatable_Handle c = relocatable_heap_allocate(&heap, 32);
+    expect_should_be(a.index, c.index);
+    expect_should_not_be(a.generation, c.generation);
+    expect_should_be(nullptr, relocatable_heap_resolve(&heap, a));
+    expect_should_not_be(nullptr, relocatable_heap_resolve(&heap, c));
+
+    Relocatable_Handle invalid = {};
+    expect_should_be(nullptr, relocatable_heap_resolve(&heap, invalid));
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    relocatable_heap_free(&heap, a);
+
+    relocatable_heap_free(&heap, b);
+    relocatable_heap_free(&heap, c);
+    expect_should_be(0, heap.live_bytes);
+
+    relocatable_heap_destroy(&heap);
+    expect_should_be(nullptr, heap.memory);
+
+    return true;
+}
+
+u8 relocatable_heap_should_compact_incrementally() {
+    constexpr u32 BLOCK_COUNT = 64;
+    constexpr u64 BLOCK_SIZE = 1000;
+
+    Relocatable_Heap heap;
+    relocatable_heap_create(MIB, BLOCK_COUNT, &heap);
+
+    Relocatable_Handle handles[BLOCK_COUNT];
+    for (u32 i = 0; i < BLOCK_COUNT; ++i) {
+        handles[i] = relocatable_heap_allocate(&heap, BLOCK_SIZE);
+        fill_block(relocatable_heap_resolve(&heap, handles[i]), BLOCK_SIZE, static_cast<u8>(i));
+    }
+
+    u64 full_top = heap.top;
+
+    // Every other block leaves a hole
+    for (u32 i = 0; i < BLOCK_COUNT; i += 2)
+        relocatable_heap_free(&heap, handles[i]);
+
+    expect_should_be(full_top, heap.top);
+    expect_should_be(full_top / 2, relocatable_heap_free_bytes(&heap));
+
+    // A single block per step, interleaved with allocations and frees
+    u32 steps = 0;
+    Relocatable_Handle late = relocatable_heap_allocate(&heap, BLOCK_SIZE);
+    fill_block(relocatable_heap_resolve(&heap, late), BLOCK_SIZE, 200);
+
+    while (u64 moved = relocatable_heap_compact(&heap, 2 * KIB)) {
+        expect_should_be(true, moved <= 2 * KIB);
+
+        if (++steps == 4)
+            relocatable_heap_free(&heap, handles[BLOCK_COUNT - 1]);
+    }
+
+    expect_should_be(true, steps > 8);
+    expect_should_be(0, relocatable_heap_free_bytes(&heap));
+    expect_should_be(heap.live_bytes, heap.top);
+    expect_should_be(BLOCK_COUNT / 2, heap.live_blocks);
+
+    for (u32 i = 1; i < BLOCK_COUNT - 1; i += 2)
+        expect_should_be(true, check_block(relocatable_heap_resolve(&heap, handles[i]), BLOCK_SIZE, static_cast<u8>(i)));
+
+    expect_should_be(true, check_block(relocatable_heap_resolve(&heap, late), BLOCK_SIZE, 200));
+
+    // Nothing left to move
+    expect_should_be(0, relocatable_heap_compact(&heap, MIB));
+
+    relocatable_heap_destroy(&heap);
+
+    return true;
+}
+
+u8 relocatable_heap_should_compact_when_full() {
+    Relocatable_Heap heap;
+    relocatable_heap_create(64 * KIB, 16, &heap);
+
+    // Two blocks fill the heap, the first one is freed and leaves a hole
+    Relocatable_Handle first = relocatable_heap_allocate(&heap, 32 * KIB - 16);
+    Relocatable_Handle second = relocatable_heap_allocate(&heap, 32 * KIB - 16);
+    expect_should_be(64 * KIB, heap.top);
+
+    fill_block(relocatable_heap_resolve(&heap, second), 32 * KIB - 16, 7);
+    relocatable_heap_free(&heap, first);
+
+    ENGINE_DEBUG("Note: The following warning is intentionally caused by the test");
+    Relocatable_Handle third = relocatable_heap_allocate(&heap, 16 * KIB);
+    expect_should_not_be(nullptr, relocatable_heap_resolve(&heap, third));
+    expect_should_be(true, check_block(relocatable_heap_resolve(&heap, second), 32 * KIB - 16, 7));
+
+    // Larger than what is left even after compacting
+    Relocatable_Handle too_large = relocatable_heap_allocate(&heap, 32 * KIB);
+    expect_should_be(0, too_large.generation);
+
+    relocatable_heap_destroy(&heap);
+
+    return true;
+}
+
+void relocatable_heap_register_tests() {
+    test_manager_register_test(
+        relocatable_heap_should_resolve_handles,
+        "Relocatable heap should resolve live handles and reject stale ones");
+
+    test_manager_register_test(
+        relocatable_heap_should_compact_incrementally,
+        "Relocatable heap should compact a bounded amount of bytes per step");
+
+    test_manager_register_test(
+        relocatable_heap_should_compact_when_full,
+        "Relocatable heap should compact at once when it is full");
+}
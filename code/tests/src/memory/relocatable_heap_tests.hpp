@@ -0,0 +1,3 @@
+#pragma once
+
+void relocatable_heap_register_tests();
@@ -0,0 +1,252 @@
+#include "stack_allocator_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <core/memory.hpp>
+#include <memory/stack_allocator.hpp>
+
+u8 stack_allocator_should_create_and_destroy() {
+    Stack_Allocator alloc;
+    stack_allocator_create(sizeof(u64), nullptr, &alloc);
+
+    expect_should_not_be(0, alloc.memory);
+    expect_should_be(sizeof(u64), alloc.total_size);
+    expect_should_be(0, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+    expect_should_be(0, alloc.total_size);
+    expect_should_be(0, alloc.allocated);
+
+    return true;
+}
+
+u8 stack_allocator_should_free_to_marker() {
+    Stack_Allocator alloc;
+    stack_allocator_create(sizeof(u64) * 16, nullptr, &alloc);
+
+    void* persistent = stack_allocator_allocate(&alloc, sizeof(u64) * 2);
+    expect_should_not_be(nullptr, persistent);
+
+    Stack_Allocator_Marker marker = stack_allocator_get_marker(&alloc);
+    expect_should_be(sizeof(u64) * 2, marker);
+
+    // Scoped temporaries on top of the marker
+    void* scratch = stack_allocator_allocate(&alloc, sizeof(u64) * 4);
+    expect_should_not_be(nullptr, scratch);
+    expect_should_be(sizeof(u64) * 6, alloc.allocated);
+
+    stack_allocator_free_to_marker(&alloc, marker);
+    expect_should_be(sizeof(u64) * 2, alloc.allocated);
+
+    // The released range is handed out again
+    void* reused = stack_allocator_allocate(&alloc, sizeof(u64));
+    expect_should_be(scratch, reused);
+
+    stack_allocator_free_all(&alloc);
+    expect_should_be(0, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 stack_allocator_should_reject_stale_marker() {
+    Stack_Allocator alloc;
+    stack_allocator_create(sizeof(u64) * 4, nullptr, &alloc);
+
+    stack_allocator_allocate(&alloc, sizeof(u64) * 3);
+    Stack_Allocator_Marker stale = stack_allocator_get_marker(&alloc);
+
+    stack_allocator_free_all(&alloc);
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    stack_allocator_free_to_marker(&alloc, stale);
+    expect_should_be(0, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 stack_allocator_overallocate() {
+    Stack_Allocator alloc;
+    stack_allocator_create(sizeof(u64) * 2, nullptr, &alloc);
+
+    void* block = stack_allocator_allocate(&alloc, sizeof(u64) * 2);
+    expect_should_not_be(nullptr, block);
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    block = stack_allocator_allocate(&alloc, sizeof(u64));
+    expect_should_be(nullptr, block);
+    expect_should_be(sizeof(u64) * 2, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 stack_allocator_should_align_allocations() {
+    Stack_Allocator alloc;
+    stack_allocator_create(KIB, nullptr, &alloc);
+
+    // Odd sized allocation to misalign the top of the stack
+    stack_allocator_allocate(&alloc, 3);
+    Stack_Allocator_Marker marker = stack_allocator_get_marker(&alloc);
+
+    void* block = stack_allocator_allocate(&alloc, sizeof(u64));
+    expect_should_be(0, reinterpret_cast<u64>(block) % sizeof(u64));
+
+    block = stack_allocator_allocate(&alloc, 48);
+    expect_should_be(0, reinterpret_cast<u64>(block) % MEMORY_DEFAULT_ALIGNMENT);
+
+    block = stack_allocator_allocate_aligned(&alloc, 1, 64);
+    expect_should_be(0, reinterpret_cast<u64>(block) % 64);
+
+    // The padding is released with the blocks
+    stack_allocator_free_to_marker(&alloc, marker);
+    expect_should_be(3, alloc.allocated);
+
+    stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 double_stack_allocator_should_align_both_sides() {
+    Double_Stack_Allocator alloc;
+    double_stack_allocator_create(KIB, nullptr, &alloc);
+
+    // Odd sizes misalign both tops
+    double_stack_allocator_allocate(&alloc, Stack_Side::LOWER, 3);
+    double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, 5);
+
+    for (u32 i = 0; i < 2; ++i) {
+        Stack_Side side = i == 0 ? Stack_Side::LOWER : Stack_Side::UPPER;
+
+        void* block = double_stack_allocator_allocate(&alloc, side, 48);
+        expect_should_be(0, reinterpret_cast<u64>(block) % MEMORY_DEFAULT_ALIGNMENT);
+
+        block = double_stack_allocator_allocate_aligned(&alloc, side, 1, 64);
+        expect_should_be(0, reinterpret_cast<u64>(block) % 64);
+    }
+
+    // The upper blocks stay below the previous ones
+    u8* top = static_cast<u8*>(alloc.memory) + alloc.total_size;
+    void* upper = double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, 16);
+    expect_should_be(top - alloc.upper_allocated, upper);
+
+    double_stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 double_stack_allocator_should_allocate_from_both_ends() {
+    u64 total_size = sizeof(u64) * 8;
+    Double_Stack_Allocator alloc;
+    double_stack_allocator_create(total_size, nullptr, &alloc);
+
+    u8* base = static_cast<u8*>(alloc.memory);
+
+    void* lower = double_stack_allocator_allocate(&alloc, Stack_Side::LOWER, sizeof(u64));
+    void* upper = double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, sizeof(u64));
+
+    expect_should_be(base, lower);
+    expect_should_be(base + total_size - sizeof(u64), upper);
+
+    // Aligned to 16 bytes, so the padding of 8 bytes stays above the block
+    void* upper_next = double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, sizeof(u64) * 2);
+    expect_should_be(base + total_size - sizeof(u64) * 4, upper_next);
+
+    expect_should_be(sizeof(u64), alloc.lower_allocated);
+    expect_should_be(sizeof(u64) * 4, alloc.upper_allocated);
+
+    double_stack_allocator_destroy(&alloc);
+
+    expect_should_be(0, alloc.memory);
+    expect_should_be(0, alloc.total_size);
+
+    return true;
+}
+
+u8 double_stack_allocator_should_share_free_space() {
+    Double_Stack_Allocator alloc;
+    double_stack_allocator_create(sizeof(u64) * 4, nullptr, &alloc);
+
+    void* lower = double_stack_allocator_allocate(&alloc, Stack_Side::LOWER, sizeof(u64) * 3);
+    expect_should_not_be(nullptr, lower);
+
+    // Only one slot is left in the middle of the block
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    void* upper = double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, sizeof(u64) * 2);
+    expect_should_be(nullptr, upper);
+
+    upper = double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, sizeof(u64));
+    expect_should_be(static_cast<u8*>(lower) + sizeof(u64) * 3, upper);
+
+    double_stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+u8 double_stack_allocator_should_free_sides_independently() {
+    Double_Stack_Allocator alloc;
+    double_stack_allocator_create(sizeof(u64) * 8, nullptr, &alloc);
+
+    double_stack_allocator_allocate(&alloc, Stack_Side::LOWER, sizeof(u64) * 2);
+    Stack_Allocator_Marker upper_marker =
+        double_stack_allocator_get_marker(&alloc, Stack_Side::UPPER);
+
+    double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, sizeof(u64) * 3);
+    double_stack_allocator_free_to_marker(&alloc, Stack_Side::UPPER, upper_marker);
+
+    expect_should_be(sizeof(u64) * 2, alloc.lower_allocated);
+    expect_should_be(0, alloc.upper_allocated);
+
+    double_stack_allocator_allocate(&alloc, Stack_Side::UPPER, sizeof(u64));
+    double_stack_allocator_free_all(&alloc, Stack_Side::LOWER);
+
+    expect_should_be(0, alloc.lower_allocated);
+    expect_should_be(sizeof(u64), alloc.upper_allocated);
+
+    double_stack_allocator_destroy(&alloc);
+
+    return true;
+}
+
+void stack_allocator_register_tests() {
+    test_manager_register_test(
+        stack_allocator_should_create_and_destroy,
+        "Stack allocator should create and destroy");
+
+    test_manager_register_test(
+        stack_allocator_should_free_to_marker,
+        "Stack allocator should roll back to a marker");
+
+    test_manager_register_test(
+        stack_allocator_should_reject_stale_marker,
+        "Stack allocator should not roll forward to a stale marker");
+
+    test_manager_register_test(
+        stack_allocator_overallocate,
+        "Stack allocator should not allocate more than the space available");
+
+    test_manager_register_test(
+        stack_allocator_should_align_allocations,
+        "Stack allocator should align allocations");
+
+    test_manager_register_test(
+        double_stack_allocator_should_align_both_sides,
+        "Double stack allocator should align the blocks of both sides");
+
+    test_manager_register_test(
+        double_stack_allocator_should_allocate_from_both_ends,
+        "Double stack allocator should allocate from both ends of the block");
+
+    test_manager_register_test(
+        double_stack_allocator_should_share_free_space,
+        "Double stack allocator sides should share the free space in the middle");
+
+    test_manager_register_test(
+        double_stack_allocator_should_free_sides_independently,
+        "Double stack allocator should free each side independently");
+}
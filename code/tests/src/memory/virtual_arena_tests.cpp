@@ -0,0 +1,186 @@
+#include "virtual_arena_tests.hpp"
+#include "../expect.hpp"
+#include "../test_manager.hpp"
+#include <memory/virtual_arena.hpp>
+#include <platform/platform.hpp>
+
+u8 virtual_arena_should_create_and_destroy() {
+    Virtual_Arena arena;
+    b8 result = virtual_arena_create(GIB, 0, false, &arena);
+
+    expect_should_be(true, result);
+    expect_should_not_be(0, arena.memory);
+    expect_should_be(GIB, arena.reserved_size);
+    expect_should_be(platform_get_page_size(), arena.commit_granularity);
+
+    // Nothing is committed until the first allocation
+    expect_should_be(0, arena.committed_size);
+    expect_should_be(0, arena.allocated);
+
+    virtual_arena_destroy(&arena);
+
+    expect_should_be(0, arena.memory);
+    expect_should_be(0, arena.reserved_size);
+    expect_should_be(0, arena.committed_size);
+
+    return true;
+}
+
+u8 virtual_arena_should_commit_on_demand() {
+    u64 granularity = 64 * KIB;
+    Virtual_Arena arena;
+    virtual_arena_create(GIB, granularity, false, &arena);
+
+    u64* first = static_cast<u64*>(virtual_arena_allocate(&arena, sizeof(u64)));
+    expect_should_not_be(nullptr, first);
+    expect_should_be(granularity, arena.committed_size);
+
+    // Committed pages are zero filled and writable
+    expect_should_be(0, *first);
+    *first = 42;
+
+    // Grow past the first chunk; the previous block must not move
+    u8* large = static_cast<u8*>(virtual_arena_allocate(&arena, 3 * granularity));
+    expect_should_not_be(nullptr, large);
+    expect_should_be(4 * granularity, arena.committed_size);
+    expect_should_be(42, *first);
+
+    large[3 * granularity - 1] = 1;
+
+    virtual_arena_destroy(&arena);
+
+    return true;
+}
+
+u8 virtual_arena_should_not_exceed_reservation() {
+    Virtual_Arena arena;
+    virtual_arena_create(64 * KIB, 0, false, &arena);
+
+    void* block = virtual_arena_allocate(&arena, 64 * KIB);
+    expect_should_not_be(nullptr, block);
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    block = virtual_arena_allocate(&arena, 1);
+    expect_should_be(nullptr, block);
+    expect_should_be(64 * KIB, arena.allocated);
+
+    virtual_arena_destroy(&arena);
+
+    return true;
+}
+
+u8 virtual_arena_free_all_and_decommit() {
+    u64 granularity = 64 * KIB;
+    Virtual_Arena arena;
+    virtual_arena_create(GIB, granularity, false, &arena);
+
+    u8* block = static_cast<u8*>(virtual_arena_allocate(&arena, 8 * granularity));
+    block[0] = 0xFF;
+    expect_should_be(8 * granularity, arena.committed_size);
+
+    virtual_arena_free_all(&arena);
+    expect_should_be(0, arena.allocated);
+
+    // The pages stay committed and zeroed for the next use
+    expect_should_be(8 * granularity, arena.committed_size);
+    u8* reused = static_cast<u8*>(virtual_arena_allocate(&arena, 16));
+    expect_should_be(block, reused);
+    expect_should_be(0, reused[0]);
+
+    virtual_arena_decommit_unused(&arena);
+    expect_should_be(granularity, arena.committed_size);
+
+    // Decommitted pages can be committed again
+    block = static_cast<u8*>(virtual_arena_allocate(&arena, 2 * granularity));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(0, block[granularity]);
+
+    virtual_arena_destroy(&arena);
+
+    return true;
+}
+
+u8 virtual_arena_should_use_huge_pages() {
+    u64 huge_page_size = platform_get_huge_page_size();
+    if (!huge_page_size) {
+        ENGINE_DEBUG("Huge pages are not supported, skipping");
+        return true;
+    }
+
+    Virtual_Arena arena;
+    b8 result = virtual_arena_create(GIB, 0, true, &arena);
+
+    expect_should_be(true, result);
+    expect_should_be(true, arena.huge_pages);
+
+    // Both the reservation and the commits cover whole huge pages, so the OS
+    // can back them without splitting
+    expect_should_be(0, reinterpret_cast<u64>(arena.memory) % huge_page_size);
+    expect_should_be(huge_page_size, arena.commit_granularity);
+
+    u8* block = static_cast<u8*>(virtual_arena_allocate(&arena, 3 * huge_page_size));
+    expect_should_not_be(nullptr, block);
+    expect_should_be(3 * huge_page_size, arena.committed_size);
+
+    block[0] = 1;
+    block[3 * huge_page_size - 1] = 1;
+
+    virtual_arena_destroy(&arena);
+
+    return true;
+}
+
+u8 virtual_arena_should_free_to_marker() {
+    Virtual_Arena arena;
+    virtual_arena_create(MIB, 0, false, &arena);
+
+    u8* kept = static_cast<u8*>(virtual_arena_allocate(&arena, 16));
+    kept[0] = 7;
+
+    u64 marker = virtual_arena_get_marker(&arena);
+    u8* temporary = static_cast<u8*>(virtual_arena_allocate(&arena, 64));
+    temporary[0] = 0xFF;
+
+    virtual_arena_free_to_marker(&arena, marker);
+    expect_should_be(marker, arena.allocated);
+    expect_should_be(7, kept[0]);
+
+    // The released range is handed out again zeroed
+    u8* reused = static_cast<u8*>(virtual_arena_allocate(&arena, 64));
+    expect_should_be(temporary, reused);
+    expect_should_be(0, reused[0]);
+
+    ENGINE_DEBUG("Note: The following error is intentionally caused by the test");
+    virtual_arena_free_to_marker(&arena, arena.allocated + 16);
+    expect_should_be(marker + 64, arena.allocated);
+
+    virtual_arena_destroy(&arena);
+
+    return true;
+}
+
+void virtual_arena_register_tests() {
+    test_manager_register_test(
+        virtual_arena_should_create_and_destroy,
+        "Virtual arena should reserve and release the address range");
+
+    test_manager_register_test(
+        virtual_arena_should_commit_on_demand,
+        "Virtual arena should commit pages on demand without moving blocks");
+
+    test_manager_register_test(
+        virtual_arena_should_not_exceed_reservation,
+        "Virtual arena should not allocate past the reserved range");
+
+    test_manager_register_test(
+        virtual_arena_free_all_and_decommit,
+        "Virtual arena should free all space and decommit unused pages");
+
+    test_manager_register_test(
+        virtual_arena_should_use_huge_pages,
+        "Virtual arena should reserve and commit whole huge pages");
+
+    test_manager_register_test(
+        virtual_arena_should_free_to_marker,
+        "Virtual arena should free the allocations made after a marker");
+}
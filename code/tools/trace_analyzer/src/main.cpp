@@ -0,0 +1,126 @@
+#include "trace_replay.hpp"
+#include "trace_stats.hpp"
+
+#include <core/memory.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reads an allocation trace recorded by the memory system (see
+// Memory_System_Config::trace_path) and reports how the memory was used over
+// the session. Unless disabled, the trace is then replayed against the
+// allocators of trace_replay.cpp to compare their speed and fragmentation.
+//
+// Usage: trace_analyzer <trace> [--timeline buckets] [--heap-size MiB] [--no-replay]
+
+constexpr u32 DEFAULT_TIMELINE_BUCKETS = 20;
+
+internal void print_usage() {
+    printf("Usage: trace_analyzer <trace> [--timeline buckets] [--heap-size MiB] [--no-replay]\n");
+    printf("  --timeline   Number of time slices of the usage over time (default %u, max %u)\n",
+           DEFAULT_TIMELINE_BUCKETS, TRACE_MAX_TIMELINE_BUCKETS);
+    printf("  --heap-size  Memory given to the fixed size allocators in the replay\n");
+    printf("               (default twice the peak usage plus the block headers)\n");
+    printf("  --no-replay  Only report the statistics of the trace\n");
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    u32 timeline_buckets = DEFAULT_TIMELINE_BUCKETS;
+    u64 heap_size = 0;
+    b8 replay = true;
+
+    for (s32 i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--timeline") == 0 && i + 1 < argc) {
+            timeline_buckets = static_cast<u32>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--heap-size") == 0 && i + 1 < argc) {
+            heap_size = strtoull(argv[++i], nullptr, 10) * MIB;
+        } else if (strcmp(argv[i], "--no-replay") == 0) {
+            replay = false;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (!path) {
+        print_usage();
+        return 1;
+    }
+
+    // Two passes, the timeline needs the time range of the whole trace
+    Trace_Stats* range_stats = static_cast<Trace_Stats*>(
+        memory_allocate(sizeof(Trace_Stats), Memory_Tag::APPLICATION));
+    Trace_Stats* stats = static_cast<Trace_Stats*>(
+        memory_allocate(sizeof(Trace_Stats), Memory_Tag::APPLICATION));
+
+    if (!trace_stats_compute(path, 0, nullptr, range_stats) ||
+        !trace_stats_compute(path, timeline_buckets, range_stats, stats))
+        return 1;
+
+    trace_stats_print(stats);
+
+    if (replay && stats->allocation_count) {
+        // Room for the block headers and for a fair amount of fragmentation
+        if (!heap_size)
+            heap_size = stats->peak_bytes * 2 + stats->peak_blocks * 32 + MIB;
+
+        char size[32];
+        printf(
+            "\nReplay on a single thread, fixed size heaps of %s:\n",
+            trace_format_size(heap_size, size));
+
+        Replay_Result baseline;
+        if (!trace_replay(path, trace_replay_get_baseline(), heap_size, &baseline))
+            return 1;
+
+        printf(
+            "  %-20s %10s %8s %14s %16s\n",
+            "allocator", "ns/op", "failed", "peak frag", "frag at peak");
+
+        for (const Replay_Allocator* allocator = trace_replay_get_allocators();
+             allocator->name;
+             ++allocator) {
+
+            Replay_Result result;
+            if (!trace_replay(path, allocator, heap_size, &result)) {
+                printf("  %-20s failed to create the allocator\n", allocator->name);
+                continue;
+            }
+
+            f64 seconds = result.seconds > baseline.seconds
+                              ? result.seconds - baseline.seconds
+                              : 0.0;
+
+            f64 nanoseconds_per_operation = result.operations
+                                                ? seconds * 1000000000.0 / result.operations
+                                                : 0.0;
+
+            if (allocator->fragmentation) {
+                printf(
+                    "  %-20s %10.1f %8llu %13.1f%% %15.1f%%\n",
+                    allocator->name,
+                    nanoseconds_per_operation,
+                    result.failed_allocations,
+                    result.peak_fragmentation,
+                    result.fragmentation_at_peak_usage);
+            } else {
+                printf(
+                    "  %-20s %10.1f %8llu %14s %16s\n",
+                    allocator->name,
+                    nanoseconds_per_operation,
+                    result.failed_allocations,
+                    "-",
+                    "-");
+            }
+        }
+    }
+
+    memory_deallocate(range_stats, sizeof(Trace_Stats), Memory_Tag::APPLICATION);
+    memory_deallocate(stats, sizeof(Trace_Stats), Memory_Tag::APPLICATION);
+
+    return 0;
+}
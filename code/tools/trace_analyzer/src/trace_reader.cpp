@@ -0,0 +1,81 @@
+#include "trace_reader.hpp"
+
+#include <core/memory.hpp>
+
+#include <stdio.h>
+
+b8 trace_reader_open(
+    const char* path,
+    Trace_Reader* out_reader) {
+
+    memory_zero(out_reader, sizeof(Trace_Reader));
+
+    if (!filesystem_open(path, File_Modes::READ, true, &out_reader->file))
+        return false;
+
+    u64 read = 0;
+    if (!filesystem_read(&out_reader->file, sizeof(Allocation_Trace_Header), &out_reader->header, &read) ||
+        out_reader->header.magic != ALLOCATION_TRACE_MAGIC) {
+        fprintf(stderr, "'%s' is not an allocation trace\n", path);
+        filesystem_close(&out_reader->file);
+        return false;
+    }
+
+    if (out_reader->header.version != ALLOCATION_TRACE_VERSION ||
+        out_reader->header.record_size != sizeof(Allocation_Trace_Record)) {
+        fprintf(
+            stderr,
+            "'%s' has version %u, only version %u is supported\n",
+            path,
+            out_reader->header.version,
+            ALLOCATION_TRACE_VERSION);
+        filesystem_close(&out_reader->file);
+        return false;
+    }
+
+    out_reader->buffer = static_cast<Allocation_Trace_Record*>(memory_allocate_uninitialized(
+        sizeof(Allocation_Trace_Record) * TRACE_READER_BUFFER_RECORDS,
+        Memory_Tag::APPLICATION));
+
+    return true;
+}
+
+void trace_reader_close(
+    Trace_Reader* reader) {
+
+    filesystem_close(&reader->file);
+
+    memory_deallocate(
+        reader->buffer,
+        sizeof(Allocation_Trace_Record) * TRACE_READER_BUFFER_RECORDS,
+        Memory_Tag::APPLICATION);
+
+    reader->buffer = nullptr;
+}
+
+b8 trace_reader_next(
+    Trace_Reader* reader,
+    Allocation_Trace_Record* out_record) {
+
+    if (reader->buffer_index == reader->buffer_count) {
+        // The last read of the file is short, which filesystem_read reports
+        // as a failure, so only the byte count matters
+        u64 read = 0;
+        filesystem_read(
+            &reader->file,
+            sizeof(Allocation_Trace_Record) * TRACE_READER_BUFFER_RECORDS,
+            reader->buffer,
+            &read);
+
+        // A trailing partial record is left by a session that crashed while
+        // writing, and is dropped
+        reader->buffer_count = read / sizeof(Allocation_Trace_Record);
+        reader->buffer_index = 0;
+
+        if (!reader->buffer_count)
+            return false;
+    }
+
+    *out_record = reader->buffer[reader->buffer_index++];
+    return true;
+}
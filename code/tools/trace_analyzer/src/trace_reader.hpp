@@ -0,0 +1,31 @@
+#pragma once
+
+#include <defines.hpp>
+#include <memory/allocation_trace.hpp>
+#include <platform/filesystem.hpp>
+
+// Streams the records of a trace file through a fixed buffer, so traces of
+// long sessions never have to fit in memory
+constexpr u64 TRACE_READER_BUFFER_RECORDS = 4096;
+
+struct Trace_Reader {
+    File_Handle file;
+    Allocation_Trace_Header header;
+
+    Allocation_Trace_Record* buffer;
+    u64 buffer_count;
+    u64 buffer_index;
+};
+
+// Fails when the file is missing or is not a trace of a supported version
+b8 trace_reader_open(
+    const char* path,
+    Trace_Reader* out_reader);
+
+void trace_reader_close(
+    Trace_Reader* reader);
+
+// Returns false at the end of the trace
+b8 trace_reader_next(
+    Trace_Reader* reader,
+    Allocation_Trace_Record* out_record);
@@ -0,0 +1,193 @@
+#include <chrono>
+#include <stdlib.h>
+#include <unordered_map>
+
+#include "trace_replay.hpp"
+#include "trace_reader.hpp"
+
+#include <core/memory.hpp>
+#include <memory/dynamic_allocator.hpp>
+
+// Operations between two samples of the fragmentation. Sampling walks the
+// free lists, so it is kept out of the measured time
+constexpr u64 TRACE_REPLAY_SAMPLE_INTERVAL = 4096;
+
+// Baseline
+
+internal void* baseline_create(u64 heap_size) {
+    return memory_allocate(sizeof(u64), Memory_Tag::APPLICATION);
+}
+
+internal void baseline_destroy(void* state) {
+    memory_deallocate(state, sizeof(u64), Memory_Tag::APPLICATION);
+}
+
+// The blocks are never touched, they only need to be unique and not null
+internal void* baseline_allocate(void* state, u64 size) {
+    u64* next_block = static_cast<u64*>(state);
+    return reinterpret_cast<void*>(++*next_block);
+}
+
+internal void baseline_free(void* state, void* block, u64 size) {
+}
+
+// Engine heap
+
+internal void* dynamic_create(u64 heap_size) {
+    Dynamic_Allocator* allocator = static_cast<Dynamic_Allocator*>(
+        memory_allocate(sizeof(Dynamic_Allocator), Memory_Tag::APPLICATION));
+
+    if (!dynamic_allocator_create(heap_size, nullptr, allocator)) {
+        memory_deallocate(allocator, sizeof(Dynamic_Allocator), Memory_Tag::APPLICATION);
+        return nullptr;
+    }
+
+    return allocator;
+}
+
+internal void dynamic_destroy(void* state) {
+    dynamic_allocator_destroy(static_cast<Dynamic_Allocator*>(state));
+    memory_deallocate(state, sizeof(Dynamic_Allocator), Memory_Tag::APPLICATION);
+}
+
+internal void* dynamic_allocate(void* state, u64 size) {
+    return dynamic_allocator_allocate(static_cast<Dynamic_Allocator*>(state), size);
+}
+
+internal void dynamic_free(void* state, void* block, u64 size) {
+    dynamic_allocator_free(static_cast<Dynamic_Allocator*>(state), block);
+}
+
+internal f32 dynamic_fragmentation(void* state) {
+    Dynamic_Allocator_Stats stats;
+    dynamic_allocator_get_stats(static_cast<Dynamic_Allocator*>(state), &stats);
+
+    return stats.free_space
+               ? 100.0f * (1.0f - (f32)stats.largest_free_block / stats.free_space)
+               : 0.0f;
+}
+
+// C runtime
+
+internal void* malloc_create(u64 heap_size) {
+    // Any non null state, the C runtime has no state of its own
+    return reinterpret_cast<void*>(1);
+}
+
+internal void malloc_destroy(void* state) {
+}
+
+internal void* malloc_allocate(void* state, u64 size) {
+    return malloc(size ? size : 1);
+}
+
+internal void malloc_free(void* state, void* block, u64 size) {
+    free(block);
+}
+
+internal const Replay_Allocator replay_allocators[] = {
+    {"engine heap (TLSF)", dynamic_create, dynamic_destroy, dynamic_allocate, dynamic_free, dynamic_fragmentation},
+    {"C runtime malloc", malloc_create, malloc_destroy, malloc_allocate, malloc_free, nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}};
+
+internal const Replay_Allocator baseline_allocator =
+    {"baseline", baseline_create, baseline_destroy, baseline_allocate, baseline_free, nullptr};
+
+const Replay_Allocator* trace_replay_get_allocators() {
+    return replay_allocators;
+}
+
+const Replay_Allocator* trace_replay_get_baseline() {
+    return &baseline_allocator;
+}
+
+struct Replay_Block {
+    void* block;
+    u64 size;
+};
+
+b8 trace_replay(
+    const char* path,
+    const Replay_Allocator* allocator,
+    u64 heap_size,
+    Replay_Result* out_result) {
+
+    Trace_Reader reader;
+    if (!trace_reader_open(path, &reader))
+        return false;
+
+    void* state = allocator->create(heap_size);
+    if (!state) {
+        trace_reader_close(&reader);
+        return false;
+    }
+
+    memory_zero(out_result, sizeof(Replay_Result));
+
+    // Addresses of the trace to the blocks of the replayed allocator
+    std::unordered_map<u64, Replay_Block> live_blocks;
+    u64 live_bytes = 0;
+    u64 sampled_peak_bytes = 0;
+
+    auto segment_start = std::chrono::steady_clock::now();
+
+    Allocation_Trace_Record record;
+    while (trace_reader_next(&reader, &record)) {
+        if (record.event == Allocation_Trace_Event::ALLOCATE) {
+            void* block = allocator->allocate(state, record.size);
+            out_result->operations++;
+
+            if (!block) {
+                out_result->failed_allocations++;
+                continue;
+            }
+
+            live_blocks[record.address] = {block, record.size};
+            live_bytes += record.size;
+        } else if (record.event == Allocation_Trace_Event::FREE) {
+            auto block = live_blocks.find(record.address);
+
+            // Unmatched frees and frees of blocks that failed to allocate
+            if (block == live_blocks.end())
+                continue;
+
+            allocator->free(state, block->second.block, block->second.size);
+            out_result->operations++;
+
+            live_bytes -= block->second.size;
+            live_blocks.erase(block);
+        } else {
+            continue;
+        }
+
+        if (allocator->fragmentation &&
+            out_result->operations % TRACE_REPLAY_SAMPLE_INTERVAL == 0) {
+
+            auto segment_end = std::chrono::steady_clock::now();
+            out_result->seconds += std::chrono::duration<f64>(segment_end - segment_start).count();
+
+            f32 fragmentation = allocator->fragmentation(state);
+
+            if (fragmentation > out_result->peak_fragmentation)
+                out_result->peak_fragmentation = fragmentation;
+
+            if (live_bytes >= sampled_peak_bytes) {
+                sampled_peak_bytes = live_bytes;
+                out_result->fragmentation_at_peak_usage = fragmentation;
+            }
+
+            segment_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    auto segment_end = std::chrono::steady_clock::now();
+    out_result->seconds += std::chrono::duration<f64>(segment_end - segment_start).count();
+
+    for (auto& block : live_blocks)
+        allocator->free(state, block.second.block, block.second.size);
+
+    allocator->destroy(state);
+    trace_reader_close(&reader);
+
+    return true;
+}
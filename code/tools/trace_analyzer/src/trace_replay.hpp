@@ -0,0 +1,47 @@
+#pragma once
+
+#include <defines.hpp>
+
+// Allocator the trace is replayed against. The replay runs the records of all
+// the threads in order on a single thread
+struct Replay_Allocator {
+    const char* name;
+
+    // heap_size is a hint for the allocators with a fixed amount of memory
+    void* (*create)(u64 heap_size);
+    void (*destroy)(void* state);
+
+    void* (*allocate)(void* state, u64 size);
+    void (*free)(void* state, void* block, u64 size);
+
+    // Share of the free memory that cannot be handed out as a single block, in
+    // percent. nullptr when the allocator cannot tell
+    f32 (*fragmentation)(void* state);
+};
+
+struct Replay_Result {
+    u64 operations;
+    u64 failed_allocations;
+
+    // Time of the replay including the bookkeeping of the blocks. The time of
+    // the baseline allocator is subtracted to get the time of the allocator
+    f64 seconds;
+
+    // Sampled at regular intervals during the replay
+    f32 peak_fragmentation;
+    f32 fragmentation_at_peak_usage;
+};
+
+// Every operation of the trace is applied to the allocator, then the blocks
+// still allocated at the end are freed
+b8 trace_replay(
+    const char* path,
+    const Replay_Allocator* allocator,
+    u64 heap_size,
+    Replay_Result* out_result);
+
+// Allocators the analyzer compares, terminated by an entry with a null name
+const Replay_Allocator* trace_replay_get_allocators();
+
+// Allocator that does nothing, to measure the cost of the replay itself
+const Replay_Allocator* trace_replay_get_baseline();
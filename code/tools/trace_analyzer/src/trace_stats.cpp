@@ -0,0 +1,268 @@
+#include "trace_stats.hpp"
+#include "trace_reader.hpp"
+
+#include <core/memory.hpp>
+
+#include <stdio.h>
+
+// The analyzer runs offline, so the standard containers are fine here
+#include <unordered_map>
+
+struct Trace_Live_Block {
+    u64 size;
+    u64 timestamp;
+    u8 tag;
+};
+
+const char* trace_format_size(
+    u64 bytes,
+    char* buffer) {
+
+    if (bytes >= GIB)
+        snprintf(buffer, 32, "%.2f GiB", (f64)bytes / GIB);
+    else if (bytes >= MIB)
+        snprintf(buffer, 32, "%.2f MiB", (f64)bytes / MIB);
+    else if (bytes >= KIB)
+        snprintf(buffer, 32, "%.2f KiB", (f64)bytes / KIB);
+    else
+        snprintf(buffer, 32, "%llu B", bytes);
+
+    return buffer;
+}
+
+internal u32 lifetime_bucket(u64 nanoseconds) {
+    u32 bucket = 0;
+    u64 limit = 1000;
+
+    while (bucket < TRACE_LIFETIME_BUCKETS - 1 && nanoseconds >= limit) {
+        limit *= 10;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+internal u32 size_bucket(u64 size) {
+    u32 bucket = 0;
+    u64 limit = 16;
+
+    while (bucket < TRACE_SIZE_BUCKETS - 1 && size > limit) {
+        limit *= 2;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+b8 trace_stats_compute(
+    const char* path,
+    u32 timeline_bucket_count,
+    const Trace_Stats* range_stats,
+    Trace_Stats* out_stats) {
+
+    Trace_Reader reader;
+    if (!trace_reader_open(path, &reader))
+        return false;
+
+    memory_zero(out_stats, sizeof(Trace_Stats));
+
+    u64 first_timestamp = 0;
+    u64 duration = 0;
+
+    if (timeline_bucket_count && range_stats) {
+        out_stats->timeline_bucket_count = timeline_bucket_count < TRACE_MAX_TIMELINE_BUCKETS
+                                               ? timeline_bucket_count
+                                               : TRACE_MAX_TIMELINE_BUCKETS;
+        first_timestamp = range_stats->first_timestamp;
+        duration = range_stats->last_timestamp - range_stats->first_timestamp + 1;
+    }
+
+    std::unordered_map<u64, Trace_Live_Block> live_blocks;
+    u64 frame_allocations = 0;
+
+    Allocation_Trace_Record record;
+    while (trace_reader_next(&reader, &record)) {
+        if (out_stats->record_count++ == 0)
+            out_stats->first_timestamp = record.timestamp;
+
+        out_stats->last_timestamp = record.timestamp;
+
+        if (record.thread >= out_stats->thread_count)
+            out_stats->thread_count = record.thread + 1;
+
+        switch (record.event) {
+        case Allocation_Trace_Event::ALLOCATE: {
+            out_stats->allocation_count++;
+            out_stats->tag_allocation_count[record.tag]++;
+            out_stats->size_histogram[size_bucket(record.size)]++;
+            frame_allocations++;
+
+            live_blocks[record.address] = {record.size, record.timestamp, record.tag};
+
+            out_stats->live_bytes += record.size;
+            out_stats->live_blocks++;
+            out_stats->tag_live_bytes[record.tag] += record.size;
+
+            if (out_stats->live_bytes > out_stats->peak_bytes) {
+                out_stats->peak_bytes = out_stats->live_bytes;
+                out_stats->peak_timestamp = record.timestamp;
+            }
+
+            if (out_stats->live_blocks > out_stats->peak_blocks)
+                out_stats->peak_blocks = out_stats->live_blocks;
+
+            if (out_stats->tag_live_bytes[record.tag] > out_stats->tag_peak_bytes[record.tag])
+                out_stats->tag_peak_bytes[record.tag] = out_stats->tag_live_bytes[record.tag];
+        } break;
+
+        case Allocation_Trace_Event::FREE: {
+            auto block = live_blocks.find(record.address);
+            if (block == live_blocks.end()) {
+                out_stats->unmatched_free_count++;
+                break;
+            }
+
+            out_stats->free_count++;
+            out_stats->lifetime_histogram[lifetime_bucket(record.timestamp - block->second.timestamp)]++;
+
+            out_stats->live_bytes -= block->second.size;
+            out_stats->live_blocks--;
+            out_stats->tag_live_bytes[block->second.tag] -= block->second.size;
+
+            live_blocks.erase(block);
+        } break;
+
+        case Allocation_Trace_Event::FRAME_END: {
+            out_stats->frame_count++;
+
+            if (frame_allocations > out_stats->max_frame_allocations)
+                out_stats->max_frame_allocations = frame_allocations;
+
+            frame_allocations = 0;
+        } break;
+        }
+
+        if (out_stats->timeline_bucket_count) {
+            u64 bucket = (record.timestamp - first_timestamp) * out_stats->timeline_bucket_count / duration;
+            if (bucket >= out_stats->timeline_bucket_count)
+                bucket = out_stats->timeline_bucket_count - 1;
+
+            if (out_stats->live_bytes > out_stats->timeline_peak_bytes[bucket])
+                out_stats->timeline_peak_bytes[bucket] = out_stats->live_bytes;
+        }
+    }
+
+    out_stats->leaked_blocks = out_stats->live_blocks;
+    out_stats->leaked_bytes = out_stats->live_bytes;
+
+    trace_reader_close(&reader);
+
+    return true;
+}
+
+internal f64 percentage(u64 part, u64 total) {
+    return total ? 100.0 * part / total : 0.0;
+}
+
+void trace_stats_print(
+    const Trace_Stats* stats) {
+
+    char size[32];
+    char other_size[32];
+
+    f64 duration = (stats->last_timestamp - stats->first_timestamp) / 1000000000.0;
+
+    printf(
+        "Trace: %llu records over %.3f s, %u threads, %llu frames\n",
+        stats->record_count,
+        duration,
+        stats->thread_count,
+        stats->frame_count);
+
+    printf(
+        "Allocations: %llu, frees: %llu, unmatched frees: %llu\n",
+        stats->allocation_count,
+        stats->free_count,
+        stats->unmatched_free_count);
+
+    printf(
+        "Peak: %s in %llu blocks at %.3f s\n",
+        trace_format_size(stats->peak_bytes, size),
+        stats->peak_blocks,
+        (stats->peak_timestamp - stats->first_timestamp) / 1000000000.0);
+
+    printf(
+        "Still allocated at the end: %s in %llu blocks\n",
+        trace_format_size(stats->leaked_bytes, size),
+        stats->leaked_blocks);
+
+    if (stats->frame_count) {
+        printf(
+            "Allocations per frame: %.2f average, %llu max\n",
+            (f64)stats->allocation_count / stats->frame_count,
+            stats->max_frame_allocations);
+    }
+
+    printf("\nPer tag:\n");
+    for (u32 tag = 0; tag < TRACE_MAX_TAGS; ++tag) {
+        if (!stats->tag_allocation_count[tag])
+            continue;
+
+        printf(
+            "  tag %2u: %10llu allocations, peak %s, at the end %s\n",
+            tag,
+            stats->tag_allocation_count[tag],
+            trace_format_size(stats->tag_peak_bytes[tag], size),
+            trace_format_size(stats->tag_live_bytes[tag], other_size));
+    }
+
+    if (stats->timeline_bucket_count && stats->peak_bytes) {
+        constexpr u32 BAR_WIDTH = 50;
+        char bar[BAR_WIDTH + 1];
+
+        printf("\nPeak usage over time:\n");
+        for (u32 i = 0; i < stats->timeline_bucket_count; ++i) {
+            u32 width = static_cast<u32>(stats->timeline_peak_bytes[i] * BAR_WIDTH / stats->peak_bytes);
+
+            for (u32 j = 0; j < BAR_WIDTH; ++j)
+                bar[j] = j < width ? '#' : ' ';
+            bar[BAR_WIDTH] = 0;
+
+            printf(
+                "  %8.3f s |%s| %s\n",
+                duration * i / stats->timeline_bucket_count,
+                bar,
+                trace_format_size(stats->timeline_peak_bytes[i], size));
+        }
+    }
+
+    const char* lifetime_labels[TRACE_LIFETIME_BUCKETS] = {
+        "< 1 us", "< 10 us", "< 100 us", "< 1 ms", "< 10 ms",
+        "< 100 ms", "< 1 s", "< 10 s", ">= 10 s"};
+
+    printf("\nLifetimes of the freed blocks:\n");
+    for (u32 i = 0; i < TRACE_LIFETIME_BUCKETS; ++i) {
+        printf(
+            "  %-9s %10llu (%5.1f%%)\n",
+            lifetime_labels[i],
+            stats->lifetime_histogram[i],
+            percentage(stats->lifetime_histogram[i], stats->free_count));
+    }
+
+    printf("\nAllocation sizes:\n");
+    u64 limit = 16;
+    for (u32 i = 0; i < TRACE_SIZE_BUCKETS; ++i, limit *= 2) {
+        if (!stats->size_histogram[i])
+            continue;
+
+        // The last bucket holds everything above the previous limit
+        b8 last = i == TRACE_SIZE_BUCKETS - 1;
+
+        printf(
+            "  %s %-10s %10llu (%5.1f%%)\n",
+            last ? "> " : "<=",
+            trace_format_size(last ? limit / 2 : limit, size),
+            stats->size_histogram[i],
+            percentage(stats->size_histogram[i], stats->allocation_count));
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <defines.hpp>
+
+// Tags are stored in a byte, so the arrays cover every possible tag even if
+// the trace was recorded by a build with more tags than this one
+constexpr u32 TRACE_MAX_TAGS = 256;
+
+// Powers of ten from 1 us to 10 s, plus one for the longer ones
+constexpr u32 TRACE_LIFETIME_BUCKETS = 9;
+
+// Powers of two from 16 B to 8 MiB, plus one for the larger ones
+constexpr u32 TRACE_SIZE_BUCKETS = 21;
+
+constexpr u32 TRACE_MAX_TIMELINE_BUCKETS = 100;
+
+struct Trace_Stats {
+    u64 record_count;
+    u64 allocation_count;
+    u64 free_count;
+    // Frees of blocks the trace never saw allocated, e.g. blocks allocated
+    // before the memory system started
+    u64 unmatched_free_count;
+    u64 frame_count;
+    u32 thread_count;
+
+    u64 first_timestamp;
+    u64 last_timestamp;
+
+    u64 live_bytes;
+    u64 live_blocks;
+    u64 peak_bytes;
+    u64 peak_blocks;
+    u64 peak_timestamp;
+
+    u64 tag_allocation_count[TRACE_MAX_TAGS];
+    u64 tag_live_bytes[TRACE_MAX_TAGS];
+    u64 tag_peak_bytes[TRACE_MAX_TAGS];
+
+    u64 lifetime_histogram[TRACE_LIFETIME_BUCKETS];
+    u64 size_histogram[TRACE_SIZE_BUCKETS];
+
+    // Blocks still allocated at the end of the trace
+    u64 leaked_blocks;
+    u64 leaked_bytes;
+
+    u64 max_frame_allocations;
+
+    // Highest live bytes within each time slice. Filled only when the time
+    // range of the trace is known, see trace_stats_compute
+    u32 timeline_bucket_count;
+    u64 timeline_peak_bytes[TRACE_MAX_TIMELINE_BUCKETS];
+};
+
+// Reads the whole trace. The timeline needs the time range of the trace, so
+// it is filled only when timeline_bucket_count is not 0 and range_stats holds
+// the result of a previous pass over the same trace
+b8 trace_stats_compute(
+    const char* path,
+    u32 timeline_bucket_count,
+    const Trace_Stats* range_stats,
+    Trace_Stats* out_stats);
+
+void trace_stats_print(
+    const Trace_Stats* stats);
+
+// Formats a byte count with a binary unit into a buffer of at least 32 bytes
+const char* trace_format_size(
+    u64 bytes,
+    char* buffer);